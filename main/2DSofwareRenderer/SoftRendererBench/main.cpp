@@ -0,0 +1,887 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <functional>
+#include <iostream>
+#include <fstream>
+#include <SoftRendererLib/src/include/SoftRenderer.h>
+#include <SoftRendererLib/src/data/PixelFormat/PixelFormatInfo.h>
+#include <SoftRendererLib/src/data/PixelFormat/PixelConverter.h>
+#include <SoftRendererLib/src/data/BlendMode/BlendFunctions.h>
+
+using namespace Tergos2D;
+
+// Host side benchmark suite for SoftRendererLib, runs without DRM or any display.
+// Every hot path is timed across texture sizes and source/target formats and reported
+// as ns/pixel and Mpix/s, either as CSV (default) or JSON.
+//
+// usage: SoftRendererBench [--json] [--out file] [--sizes 16,64,256] [--min-time ms] [--filter text]
+//        SoftRendererBench --verify-tiles checks TiledRenderer against direct drawing instead
+
+#define TARGET_SIZE 480
+// extra bytes behind every buffer, some kernels read a full uint32_t or the neighbour pixel
+#define BUFFER_PADDING 4096
+
+static const PixelFormat allFormats[] = {
+    PixelFormat::RGB24,
+    PixelFormat::BGR24,
+    PixelFormat::ARGB8888,
+    PixelFormat::RGBA8888,
+    PixelFormat::ARGB1555,
+    PixelFormat::RGB565,
+    PixelFormat::RGBA4444,
+    PixelFormat::GRAYSCALE8,
+    PixelFormat::ARGB8888_PRE,
+    PixelFormat::RGBA8888_PRE,
+};
+
+struct BenchSettings
+{
+    std::vector<uint16_t> sizes = {16, 64, 256};
+    double minTimeMs = 20.0;
+    bool json = false;
+    std::string outFile;
+    std::string filter;
+};
+
+struct BenchResult
+{
+    std::string group;
+    std::string variant;
+    std::string sourceFormat;
+    std::string targetFormat;
+    uint16_t width;
+    uint16_t height;
+    uint64_t pixelsPerCall;
+    uint64_t iterations;
+    double totalNs;
+
+    double NsPerPixel() const { return totalNs / (double)(pixelsPerCall * iterations); }
+    double MPixPerSecond() const { return (double)(pixelsPerCall * iterations) / (totalNs / 1e9) / 1e6; }
+};
+
+// Owns the pixel storage so textures never have to copy or free it themselves
+struct BenchSurface
+{
+    std::vector<uint8_t> data;
+    uint16_t width = 0, height = 0;
+    PixelFormat format = PixelFormat::RGB24;
+
+    BenchSurface(uint16_t width, uint16_t height, PixelFormat format) : width(width), height(height), format(format)
+    {
+        size_t bytes = (size_t)width * height * PixelFormatRegistry::GetInfo(format).bytesPerPixel;
+        data.resize(bytes + BUFFER_PADDING);
+        // deterministic pattern with a mix of transparent, translucent and opaque pixels
+        uint32_t seed = 0x12345678u ^ (width * 31u + height) ^ (static_cast<uint32_t>(format) << 24);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            data[i] = static_cast<uint8_t>(seed >> 24);
+        }
+    }
+};
+
+// gives a 32 bit surface the alpha of a UI sprite: an opaque disc with a short soft edge and transparent corners
+static void ShapeSpriteAlpha(BenchSurface &surface)
+{
+    uint8_t alphaOffset = surface.format == PixelFormat::RGBA8888 || surface.format == PixelFormat::RGBA8888_PRE ? 3 : 0;
+    float center = surface.width / 2.0f;
+    for (uint16_t y = 0; y < surface.height; ++y)
+    {
+        for (uint16_t x = 0; x < surface.width; ++x)
+        {
+            float distance = std::sqrt((x - center) * (x - center) + (y - center) * (y - center));
+            float alpha = std::min(std::max((center - distance) / 4.0f, 0.0f), 1.0f);
+            surface.data[(y * surface.width + x) * 4 + alphaOffset] = static_cast<uint8_t>(alpha * 255);
+        }
+    }
+}
+
+class BenchRunner
+{
+public:
+    explicit BenchRunner(const BenchSettings &settings) : settings(settings) {}
+
+    void Run(const std::string &group, const std::string &variant, PixelFormat source, PixelFormat target,
+             uint16_t width, uint16_t height, uint64_t pixelsPerCall, const std::function<void()> &func)
+    {
+        if (pixelsPerCall == 0)
+            return;
+        std::string name = group + "/" + variant + "/" + PixelFormatRegistry::GetInfo(source).name + "/" +
+                           PixelFormatRegistry::GetInfo(target).name;
+        if (!settings.filter.empty() && name.find(settings.filter) == std::string::npos)
+            return;
+
+        // warm up caches and lazy state
+        func();
+
+        using Clock = std::chrono::steady_clock;
+        uint64_t iterations = 0;
+        uint64_t batch = 1;
+        auto start = Clock::now();
+        double elapsedNs = 0;
+        do
+        {
+            for (uint64_t i = 0; i < batch; ++i)
+                func();
+            iterations += batch;
+            elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            if (batch < 1024)
+                batch *= 2;
+        } while (elapsedNs < settings.minTimeMs * 1e6);
+
+        BenchResult result{group, variant, PixelFormatRegistry::GetInfo(source).name, PixelFormatRegistry::GetInfo(target).name,
+                           width, height, pixelsPerCall, iterations, elapsedNs};
+        fprintf(stderr, "%-70s %4ux%-4u %9.3f ns/px %10.2f Mpix/s\n", name.c_str(), width, height,
+                result.NsPerPixel(), result.MPixPerSecond());
+        results.push_back(result);
+    }
+
+    void Write(std::ostream &out) const
+    {
+        if (settings.json)
+        {
+            out << "[\n";
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                const BenchResult &r = results[i];
+                out << "  {\"group\": \"" << r.group << "\", \"variant\": \"" << r.variant
+                    << "\", \"source\": \"" << r.sourceFormat << "\", \"target\": \"" << r.targetFormat
+                    << "\", \"width\": " << r.width << ", \"height\": " << r.height
+                    << ", \"pixels\": " << r.pixelsPerCall << ", \"iterations\": " << r.iterations
+                    << ", \"ns_per_pixel\": " << r.NsPerPixel() << ", \"mpix_per_s\": " << r.MPixPerSecond() << "}"
+                    << (i + 1 < results.size() ? ",\n" : "\n");
+            }
+            out << "]\n";
+            return;
+        }
+
+        out << "group,variant,source,target,width,height,pixels,iterations,ns_per_pixel,mpix_per_s\n";
+        for (const BenchResult &r : results)
+        {
+            out << r.group << "," << r.variant << "," << r.sourceFormat << "," << r.targetFormat << ","
+                << r.width << "," << r.height << "," << r.pixelsPerCall << "," << r.iterations << ","
+                << r.NsPerPixel() << "," << r.MPixPerSecond() << "\n";
+        }
+    }
+
+private:
+    const BenchSettings &settings;
+    std::vector<BenchResult> results;
+};
+
+// the renderers hand the rows to the blend kernels, which require these conversions to exist
+static bool IsDrawable(PixelFormat source, PixelFormat target)
+{
+    return PixelConverter::GetConversionFunction(source, target) != nullptr &&
+           PixelConverter::GetConversionFunction(source, PixelFormat::ARGB8888) != nullptr &&
+           PixelConverter::GetConversionFunction(PixelFormat::ARGB8888, target) != nullptr;
+}
+
+static void SetBlending(RenderContext2D &context, BlendMode mode)
+{
+    BlendContext bc;
+    bc.mode = mode;
+    context.SetBlendContext(bc);
+    context.SetBlendFunc(BlendFunctions::BlendRow);
+    context.SetSamplingMethod(SamplingMethod::NEAREST);
+}
+
+static void MakeRotation(float degrees, uint16_t width, uint16_t height, float matrix[3][3])
+{
+    float rad = degrees * 3.14159265358979323846f / 180.0f;
+    float c = std::cos(rad);
+    float s = std::sin(rad);
+    // rotate around the texture center and place it in the middle of the target
+    float cx = width / 2.0f, cy = height / 2.0f;
+    matrix[0][0] = c;
+    matrix[0][1] = -s;
+    matrix[0][2] = TARGET_SIZE / 2.0f - (c * cx - s * cy);
+    matrix[1][0] = s;
+    matrix[1][1] = c;
+    matrix[1][2] = TARGET_SIZE / 2.0f - (s * cx + c * cy);
+    matrix[2][0] = 0;
+    matrix[2][1] = 0;
+    matrix[2][2] = 1;
+}
+
+// a page halfway through a flip: the right edge turns away from the viewer and shrinks
+static void MakePageFlip(uint16_t width, uint16_t height, float matrix[3][3])
+{
+    float left = (TARGET_SIZE - width) / 2.0f, top = (TARGET_SIZE - height) / 2.0f;
+    float right = left + width * 0.7f, inset = height * 0.2f;
+    const float corners[4][2] = {{left, top}, {right, top + inset}, {right, top + height - inset}, {left, top + height}};
+    TransformedTextureRenderer::QuadTransform(corners, 0, 0, width, height, matrix);
+}
+
+static void BenchClearTarget(BenchRunner &runner, RenderContext2D &context)
+{
+    for (PixelFormat target : allFormats)
+    {
+        BenchSurface targetSurface(TARGET_SIZE, TARGET_SIZE, target);
+        Texture targetTexture(TARGET_SIZE, TARGET_SIZE, targetSurface.data.data(), target);
+        context.SetTargetTexture(&targetTexture);
+        runner.Run("ClearTarget", "full", target, target, TARGET_SIZE, TARGET_SIZE, TARGET_SIZE * TARGET_SIZE,
+                   [&]() { context.ClearTarget(Color(150, 150, 150)); });
+    }
+}
+
+static void BenchPrimitives(BenchRunner &runner, RenderContext2D &context, const BenchSettings &settings)
+{
+    const Color opaque(255, 40, 200, 90);
+    const Color translucent(128, 40, 200, 90);
+
+    for (PixelFormat target : allFormats)
+    {
+        if (!IsDrawable(PixelFormat::ARGB8888, target))
+            continue;
+        BenchSurface targetSurface(TARGET_SIZE, TARGET_SIZE, target);
+        Texture targetTexture(TARGET_SIZE, TARGET_SIZE, targetSurface.data.data(), target);
+        context.SetTargetTexture(&targetTexture);
+
+        for (uint16_t size : settings.sizes)
+        {
+            if (size > TARGET_SIZE)
+                continue;
+            int16_t pos = (TARGET_SIZE - size) / 2;
+            int16_t center = TARGET_SIZE / 2;
+            float matrix[3][3];
+            MakeRotation(30.0f, size, size, matrix);
+            // five pointed star, concave with a self intersecting outline in the pentagram variant
+            PolygonPoint star[10];
+            PolygonPoint pentagram[5];
+            for (int i = 0; i < 10; ++i)
+            {
+                float angle = i * 3.14159265358979323846f / 5.0f;
+                float radius = (i & 1) ? size * 0.2f : size * 0.5f;
+                star[i] = {pos + size / 2.0f + radius * std::sin(angle), pos + size / 2.0f - radius * std::cos(angle)};
+            }
+            for (int i = 0; i < 5; ++i)
+                pentagram[i] = star[(i * 4) % 10];
+
+            for (int blended = 0; blended < 2; ++blended)
+            {
+                SetBlending(context, blended ? BlendMode::BLEND : BlendMode::NOBLEND);
+                const Color &color = blended ? translucent : opaque;
+                const char *variant = blended ? "blend" : "opaque";
+
+                runner.Run("PrimitivesRenderer::DrawRect", variant, PixelFormat::ARGB8888, target, size, size, (uint64_t)size * size,
+                           [&]() { context.primitivesRenderer.DrawRect(color, pos, pos, size, size); });
+                runner.Run("PrimitivesRenderer::DrawLine", variant, PixelFormat::ARGB8888, target, size, size, size,
+                           [&]() { context.primitivesRenderer.DrawLine(color, pos, pos, pos + size - 1, pos + size - 1); });
+                runner.Run("PrimitivesRenderer::DrawTransformedRect", variant, PixelFormat::ARGB8888, target, size, size, (uint64_t)size * size,
+                           [&]() { context.primitivesRenderer.DrawTransformedRect(color, size, size, matrix); });
+                runner.Run("PrimitivesRenderer::FillPolygon", std::string(variant) + "-star", PixelFormat::ARGB8888, target, size, size, (uint64_t)size * size,
+                           [&]() { context.primitivesRenderer.FillPolygon(color, star, 10); });
+                runner.Run("PrimitivesRenderer::FillPolygon", std::string(variant) + "-pentagram-evenodd", PixelFormat::ARGB8888, target, size, size, (uint64_t)size * size,
+                           [&]() { context.primitivesRenderer.FillPolygon(color, pentagram, 5, FillRule::EVENODD); });
+                runner.Run("PrimitivesRenderer::FillCircle", variant, PixelFormat::ARGB8888, target, size, size, (uint64_t)size * size,
+                           [&]() { context.primitivesRenderer.FillCircle(color, center, center, size / 2); });
+                runner.Run("PrimitivesRenderer::FillRoundedRect", variant, PixelFormat::ARGB8888, target, size, size, (uint64_t)size * size,
+                           [&]() { context.primitivesRenderer.FillRoundedRect(color, pos, pos, size, size, size / 8); });
+                runner.Run("PrimitivesRenderer::DrawArc", variant, PixelFormat::ARGB8888, target, size, size, (uint64_t)size * size,
+                           [&]() { context.primitivesRenderer.DrawArc(color, center, center, size / 2, size / 8 + 1, -45.0f, 225.0f); });
+            }
+
+            // anti-aliased edges blend their coverage, the shallow line covers two scanlines per column
+            SetBlending(context, BlendMode::NOBLEND);
+            context.EnableAntialiasing(true);
+            runner.Run("PrimitivesRenderer::DrawLine", "aa", PixelFormat::ARGB8888, target, size, size, size,
+                       [&]() { context.primitivesRenderer.DrawLine(opaque, pos, pos, pos + size - 1, pos + size / 3); });
+            runner.Run("PrimitivesRenderer::FillPolygon", "aa-star", PixelFormat::ARGB8888, target, size, size, (uint64_t)size * size,
+                       [&]() { context.primitivesRenderer.FillPolygon(opaque, star, 10); });
+            runner.Run("PrimitivesRenderer::FillCircle", "aa", PixelFormat::ARGB8888, target, size, size, (uint64_t)size * size,
+                       [&]() { context.primitivesRenderer.FillCircle(opaque, center, center, size / 2); });
+            runner.Run("PrimitivesRenderer::FillRoundedRect", "aa", PixelFormat::ARGB8888, target, size, size, (uint64_t)size * size,
+                       [&]() { context.primitivesRenderer.FillRoundedRect(opaque, pos, pos, size, size, size / 8); });
+            runner.Run("PrimitivesRenderer::DrawArc", "aa", PixelFormat::ARGB8888, target, size, size, (uint64_t)size * size,
+                       [&]() { context.primitivesRenderer.DrawArc(opaque, center, center, size / 2, size / 8 + 1, -45.0f, 225.0f); });
+            context.EnableAntialiasing(false);
+        }
+    }
+}
+
+static void BenchTextureRenderers(BenchRunner &runner, RenderContext2D &context, const BenchSettings &settings)
+{
+    for (PixelFormat target : allFormats)
+    {
+        BenchSurface targetSurface(TARGET_SIZE, TARGET_SIZE, target);
+        Texture targetTexture(TARGET_SIZE, TARGET_SIZE, targetSurface.data.data(), target);
+        context.SetTargetTexture(&targetTexture);
+
+        for (PixelFormat source : allFormats)
+        {
+            if (!IsDrawable(source, target))
+                continue;
+            bool sourceHasAlpha = PixelFormatRegistry::GetInfo(source).hasAlpha;
+
+            for (uint16_t size : settings.sizes)
+            {
+                if (size > TARGET_SIZE)
+                    continue;
+                BenchSurface sourceSurface(size, size, source);
+                Texture texture(size, size, sourceSurface.data.data(), source);
+                int16_t pos = (TARGET_SIZE - size) / 2;
+                uint64_t area = (uint64_t)size * size;
+
+                float rotated[3][3];
+                MakeRotation(30.0f, size, size, rotated);
+                float rotated90[3][3];
+                MakeRotation(90.0f, size, size, rotated90);
+                float flipped[3][3];
+                MakePageFlip(size, size, flipped);
+
+                for (int blended = 0; blended < 2; ++blended)
+                {
+                    if (blended && !sourceHasAlpha)
+                        continue;
+                    SetBlending(context, blended ? BlendMode::BLEND : BlendMode::NOBLEND);
+                    const char *variant = blended ? "blend" : "noblend";
+
+                    runner.Run("BasicTextureRenderer::DrawTexture", variant, source, target, size, size, area,
+                               [&]() { context.basicTextureRenderer.DrawTexture(texture, pos, pos); });
+
+                    uint16_t scaled = static_cast<uint16_t>(size * 0.75f);
+                    runner.Run("ScaleTextureRenderer::DrawTexture", std::string(variant) + "-nearest", source, target, size, size, (uint64_t)scaled * scaled,
+                               [&]() { context.scaleTextureRenderer.DrawTexture(texture, pos, pos, 0.75f, 0.75f); });
+                    context.SetSamplingMethod(SamplingMethod::LINEAR);
+                    runner.Run("ScaleTextureRenderer::DrawTexture", std::string(variant) + "-linear", source, target, size, size, (uint64_t)scaled * scaled,
+                               [&]() { context.scaleTextureRenderer.DrawTexture(texture, pos, pos, 0.75f, 0.75f); });
+                    context.SetSamplingMethod(SamplingMethod::NEAREST);
+
+                    runner.Run("TransformedTextureRenderer::DrawTexture", std::string(variant) + "-rot30", source, target, size, size, area,
+                               [&]() { TransformedTextureRenderer::DrawTexture(texture, rotated, context, 0, 0, size, size); });
+                    runner.Run("TransformedTextureRenderer::DrawTexture", std::string(variant) + "-rot90", source, target, size, size, area,
+                               [&]() { TransformedTextureRenderer::DrawTexture(texture, rotated90, context, 0, 0, size, size); });
+                    runner.Run("TransformedTextureRenderer::DrawTexture", std::string(variant) + "-pageflip", source, target, size, size, area,
+                               [&]() { TransformedTextureRenderer::DrawTexture(texture, flipped, context, 0, 0, size, size); });
+                    context.SetSamplingMethod(SamplingMethod::LINEAR);
+                    runner.Run("TransformedTextureRenderer::DrawTextureSamplingSupp", std::string(variant) + "-rot30-linear", source, target, size, size, area,
+                               [&]() { TransformedTextureRenderer::DrawTextureSamplingSupp(texture, rotated, context, 0, 0, size, size); });
+                    runner.Run("TransformedTextureRenderer::DrawTextureSamplingSupp", std::string(variant) + "-pageflip-linear", source, target, size, size, area,
+                               [&]() { TransformedTextureRenderer::DrawTextureSamplingSupp(texture, flipped, context, 0, 0, size, size); });
+                    context.SetSamplingMethod(SamplingMethod::NEAREST);
+                }
+
+                // the same texture shrunk to a thumbnail with and without its mips
+                SetBlending(context, BlendMode::NOBLEND);
+                for (int withMips = 0; withMips < 2; ++withMips)
+                {
+                    if (withMips && !texture.BuildMips())
+                        break;
+                    const char *variant = withMips ? "thumb-mips" : "thumb";
+                    uint16_t thumb = static_cast<uint16_t>(size * 0.125f);
+                    runner.Run("ScaleTextureRenderer::DrawTexture", std::string(variant) + "-nearest", source, target, size, size, (uint64_t)thumb * thumb,
+                               [&]() { context.scaleTextureRenderer.DrawTexture(texture, pos, pos, 0.125f, 0.125f); });
+                    context.SetSamplingMethod(SamplingMethod::LINEAR);
+                    runner.Run("ScaleTextureRenderer::DrawTexture", std::string(variant) + "-linear", source, target, size, size, (uint64_t)thumb * thumb,
+                               [&]() { context.scaleTextureRenderer.DrawTexture(texture, pos, pos, 0.125f, 0.125f); });
+                    context.SetSamplingMethod(SamplingMethod::NEAREST);
+                }
+                texture.ClearMips();
+
+                // the same sprite blended with and without its span index
+                if (!texture.BuildSpans())
+                    continue;
+                ShapeSpriteAlpha(sourceSurface);
+                SetBlending(context, BlendMode::BLEND);
+                for (int withSpans = 0; withSpans < 2; ++withSpans)
+                {
+                    if (withSpans)
+                        texture.BuildSpans();
+                    else
+                        texture.ClearSpans();
+                    const char *variant = withSpans ? "sprite-spans" : "sprite";
+
+                    runner.Run("BasicTextureRenderer::DrawTexture", variant, source, target, size, size, area,
+                               [&]() { context.basicTextureRenderer.DrawTexture(texture, pos, pos); });
+                    uint16_t scaled = static_cast<uint16_t>(size * 0.75f);
+                    runner.Run("ScaleTextureRenderer::DrawTexture", std::string(variant) + "-nearest", source, target, size, size, (uint64_t)scaled * scaled,
+                               [&]() { context.scaleTextureRenderer.DrawTexture(texture, pos, pos, 0.75f, 0.75f); });
+                }
+            }
+        }
+    }
+}
+
+// tinted alpha masks, the way text and icons are drawn, next to an ARGB8888 sprite of the same size
+static void BenchMasks(BenchRunner &runner, RenderContext2D &context, const BenchSettings &settings)
+{
+    const PixelFormat masks[] = {PixelFormat::A8, PixelFormat::A4, PixelFormat::A1, PixelFormat::ARGB8888};
+    Coloring coloring;
+    coloring.colorEnabled = true;
+    coloring.color = Color(255, 40, 200, 120);
+    for (PixelFormat target : {PixelFormat::RGB565, PixelFormat::RGB24})
+    {
+        BenchSurface targetSurface(TARGET_SIZE, TARGET_SIZE, target);
+        Texture targetTexture(TARGET_SIZE, TARGET_SIZE, targetSurface.data.data(), target);
+        context.SetTargetTexture(&targetTexture);
+        SetBlending(context, BlendMode::BLEND);
+        context.SetColoringSettings(coloring);
+
+        for (PixelFormat source : masks)
+        {
+            for (uint16_t size : settings.sizes)
+            {
+                if (size > TARGET_SIZE)
+                    continue;
+                BenchSurface sourceSurface(size, size, source);
+                Texture texture(size, size, sourceSurface.data.data(), source);
+                int16_t pos = (TARGET_SIZE - size) / 2;
+                runner.Run("BasicTextureRenderer::DrawTexture", "mask-tint", source, target, size, size, (uint64_t)size * size,
+                           [&]() { context.basicTextureRenderer.DrawTexture(texture, pos, pos); });
+            }
+        }
+        context.SetColoringSettings(Coloring());
+    }
+}
+
+// palette textures expanded into the target, next to the ARGB8888 texture they replace
+static void BenchIndexed(BenchRunner &runner, RenderContext2D &context, const BenchSettings &settings)
+{
+    // random entries, the first palette opaque so it is copied, the second one with alpha so it is blended
+    BenchSurface opaquePalette(256, 1, PixelFormat::ARGB8888);
+    BenchSurface alphaPalette(256, 1, PixelFormat::ARGB8888);
+    for (size_t i = 0; i < 256; ++i)
+        opaquePalette.data[i * 4] = 255;
+
+    for (PixelFormat target : {PixelFormat::RGB565, PixelFormat::RGB24, PixelFormat::ARGB8888})
+    {
+        BenchSurface targetSurface(TARGET_SIZE, TARGET_SIZE, target);
+        Texture targetTexture(TARGET_SIZE, TARGET_SIZE, targetSurface.data.data(), target);
+        context.SetTargetTexture(&targetTexture);
+
+        for (PixelFormat source : {PixelFormat::I8, PixelFormat::I4, PixelFormat::ARGB8888})
+        {
+            for (uint16_t size : settings.sizes)
+            {
+                if (size > TARGET_SIZE)
+                    continue;
+                BenchSurface sourceSurface(size, size, source);
+                Texture texture(size, size, sourceSurface.data.data(), source);
+                int16_t pos = (TARGET_SIZE - size) / 2;
+                uint64_t area = (uint64_t)size * size;
+                uint16_t scaled = static_cast<uint16_t>(size * 0.75f);
+
+                for (int blended = 0; blended < 2; ++blended)
+                {
+                    SetBlending(context, blended ? BlendMode::BLEND : BlendMode::NOBLEND);
+                    texture.SetPalette((blended ? alphaPalette : opaquePalette).data.data(), 256);
+                    const char *variant = blended ? "palette-blend" : "palette-opaque";
+                    runner.Run("BasicTextureRenderer::DrawTexture", variant, source, target, size, size, area,
+                               [&]() { context.basicTextureRenderer.DrawTexture(texture, pos, pos); });
+                    runner.Run("ScaleTextureRenderer::DrawTexture", std::string(variant) + "-nearest", source, target, size, size, (uint64_t)scaled * scaled,
+                               [&]() { context.scaleTextureRenderer.DrawTexture(texture, pos, pos, 0.75f, 0.75f); });
+                }
+            }
+        }
+    }
+}
+
+// the display demo frame: a clear and 200 overlapping 50x50 squares, recorded once
+static void RecordSquares(RenderContext2D &context, DisplayList &list, bool blended)
+{
+    context.BeginRecording(list);
+    context.ClearTarget(Color(155, 155, 155));
+    uint32_t seed = 1;
+    for (int i = 0; i < 200; ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        int16_t x = (seed >> 8) % (TARGET_SIZE - 50);
+        seed = seed * 1664525u + 1013904223u;
+        int16_t y = (seed >> 8) % (TARGET_SIZE - 50);
+        Color color(blended ? 160 : 255, x & 255, y & 255, (x + y) & 255);
+        context.primitivesRenderer.DrawRect(color, x, y, 50, 50);
+    }
+    context.EndRecording();
+}
+
+static void BenchScenes(BenchRunner &runner, RenderContext2D &context)
+{
+    const uint16_t tileSizes[][2] = {{TARGET_SIZE, 16}, {64, 64}};
+    for (PixelFormat target : {PixelFormat::RGB565, PixelFormat::ARGB8888})
+    {
+        BenchSurface targetSurface(TARGET_SIZE, TARGET_SIZE, target);
+        Texture targetTexture(TARGET_SIZE, TARGET_SIZE, targetSurface.data.data(), target);
+        context.SetTargetTexture(&targetTexture);
+
+        for (int blended = 0; blended < 2; ++blended)
+        {
+            SetBlending(context, BlendMode::BLEND);
+            DisplayList list;
+            RecordSquares(context, list, blended);
+            std::string variant = blended ? "squares-blend" : "squares-opaque";
+
+            runner.Run("Scene", variant + "/immediate", PixelFormat::ARGB8888, target, TARGET_SIZE, TARGET_SIZE,
+                       TARGET_SIZE * TARGET_SIZE, [&]() { list.Replay(context); });
+            for (const auto &tileSize : tileSizes)
+            {
+                TiledRenderer tiled(tileSize[0], tileSize[1]);
+                runner.Run("Scene", variant + "/tiled" + std::to_string(tileSize[0]) + "x" + std::to_string(tileSize[1]),
+                           PixelFormat::ARGB8888, target, TARGET_SIZE, TARGET_SIZE, TARGET_SIZE * TARGET_SIZE,
+                           [&]() { tiled.Render(context, list); });
+            }
+
+            // full width tiles shared out between two workers, the calling thread being one of them
+            ThreadPool pool(2);
+            TiledRenderer threaded(TARGET_SIZE, 16);
+            threaded.SetWorkerPool(&pool);
+            runner.Run("Scene", variant + "/tiled" + std::to_string(TARGET_SIZE) + "x16-2threads",
+                       PixelFormat::ARGB8888, target, TARGET_SIZE, TARGET_SIZE, TARGET_SIZE * TARGET_SIZE,
+                       [&]() { threaded.Render(context, list); });
+        }
+    }
+}
+
+static void BenchPixelConverter(BenchRunner &runner, const BenchSettings &settings)
+{
+    for (PixelFormat source : allFormats)
+    {
+        for (PixelFormat target : allFormats)
+        {
+            PixelConverter::ConvertFunc convertFunc = PixelConverter::GetConversionFunction(source, target);
+            if (!convertFunc)
+                continue;
+            for (uint16_t size : settings.sizes)
+            {
+                BenchSurface src(size, size, source);
+                BenchSurface dst(size, size, target);
+                size_t srcPitch = (size_t)size * PixelFormatRegistry::GetInfo(source).bytesPerPixel;
+                size_t dstPitch = (size_t)size * PixelFormatRegistry::GetInfo(target).bytesPerPixel;
+                runner.Run("PixelConverter", "rows", source, target, size, size, (uint64_t)size * size, [&]()
+                           {
+                    for (uint16_t y = 0; y < size; ++y)
+                        convertFunc(src.data.data() + y * srcPitch, dst.data.data() + y * dstPitch, size); });
+            }
+        }
+    }
+}
+
+struct BlendEntry
+{
+    const char *name;
+    BlendFunc func;
+    bool useSolidColor;
+    // returns true if the kernel is defined for this combination
+    bool (*accepts)(PixelFormat source, PixelFormat target);
+};
+
+static bool IsRGB24Target(PixelFormat target)
+{
+    return target == PixelFormat::RGB24 || target == PixelFormat::BGR24;
+}
+
+static const BlendEntry blendEntries[] = {
+    {"BlendFunctions::BlendRow", BlendFunctions::BlendRow, false,
+     [](PixelFormat source, PixelFormat target) { return IsDrawable(source, target); }},
+    {"BlendFunctions::BlendRow", BlendFunctions::BlendRow, true,
+     [](PixelFormat source, PixelFormat target) { return source == PixelFormat::ARGB8888 && IsDrawable(source, target); }},
+    {"BlendFunctions::BlendRGB24", BlendFunctions::BlendRGB24, false,
+     [](PixelFormat source, PixelFormat target) { return IsRGB24Target(target) && IsDrawable(source, target); }},
+    {"BlendFunctions::BlendRGB565", BlendFunctions::BlendRGB565, false,
+     [](PixelFormat source, PixelFormat target) { return target == PixelFormat::RGB565 && IsDrawable(source, target); }},
+    {"BlendFunctions::BlendToRGB24Simple", BlendFunctions::BlendToRGB24Simple, false,
+     [](PixelFormat source, PixelFormat target) { return IsRGB24Target(target) && IsDrawable(source, target); }},
+    {"BlendFunctions::BlendRGBA32ToRGB24", BlendFunctions::BlendRGBA32ToRGB24, false,
+     [](PixelFormat source, PixelFormat target) { return source == PixelFormat::RGBA8888 && IsRGB24Target(target); }},
+    {"BlendFunctions::BlendSolidRowRGB24", BlendFunctions::BlendSolidRowRGB24, true,
+     [](PixelFormat source, PixelFormat target) { return source == PixelFormat::ARGB8888 && IsRGB24Target(target); }},
+};
+
+static void BenchBlendFunctions(BenchRunner &runner, const BenchSettings &settings)
+{
+    Coloring coloring;
+    for (const BlendEntry &entry : blendEntries)
+    {
+        for (PixelFormat source : allFormats)
+        {
+            for (PixelFormat target : allFormats)
+            {
+                if (!entry.accepts(source, target))
+                    continue;
+                const PixelFormatInfo &sourceInfo = PixelFormatRegistry::GetInfo(source);
+                const PixelFormatInfo &targetInfo = PixelFormatRegistry::GetInfo(target);
+                for (uint16_t size : settings.sizes)
+                {
+                    BenchSurface src(size, size, source);
+                    BenchSurface dst(size, size, target);
+                    size_t srcPitch = entry.useSolidColor ? 0 : (size_t)size * sourceInfo.bytesPerPixel;
+                    size_t dstPitch = (size_t)size * targetInfo.bytesPerPixel;
+                    if (entry.useSolidColor)
+                    {
+                        // solid colour rows repeat one translucent ARGB8888 pixel
+                        for (uint16_t x = 0; x < size; ++x)
+                        {
+                            uint8_t pixel[4] = {128, 40, 200, 90};
+                            memcpy(src.data.data() + x * 4, pixel, 4);
+                        }
+                    }
+                    BlendContext bc;
+                    runner.Run(entry.name, entry.useSolidColor ? "solid" : "rows", source, target, size, size, (uint64_t)size * size, [&]()
+                               {
+                        for (uint16_t y = 0; y < size; ++y)
+                            entry.func(dst.data.data() + y * dstPitch, src.data.data() + y * srcPitch, size,
+                                       targetInfo, sourceInfo, coloring, entry.useSolidColor, bc); });
+                }
+            }
+        }
+    }
+}
+
+// --verify-tiles: random scenes drawn directly and through TiledRenderer with 1, 2 and 4 threads must
+// give the same bytes. Build the bench with -fsanitize=address or -fsanitize=thread to check the tile
+// views and the workers as well
+#define VERIFY_WIDTH 200
+#define VERIFY_HEIGHT 150
+
+struct VerifyTextures
+{
+    BenchSurface spriteSurface{48, 48, PixelFormat::ARGB8888};
+    BenchSurface opaqueSurface{40, 24, PixelFormat::RGB565};
+    Texture sprite;
+    Texture opaque;
+
+    VerifyTextures() : sprite(48, 48, spriteSurface.data.data(), PixelFormat::ARGB8888),
+                       opaque(40, 24, opaqueSurface.data.data(), PixelFormat::RGB565)
+    {
+        ShapeSpriteAlpha(spriteSurface);
+        sprite.BuildSpans();
+        sprite.BuildMips();
+    }
+};
+
+// 30 commands of every kind with random blending, sampling, anti-aliasing and clipping
+static void DrawVerifyScene(RenderContext2D &context, VerifyTextures &textures, uint32_t seed, bool clears)
+{
+    auto next = [&seed](int range)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<int>((seed >> 8) % range);
+    };
+    auto coord = [&](int range) { return static_cast<int16_t>(next(range + 40) - 20); };
+
+    SetBlending(context, BlendMode::BLEND);
+    context.EnableClipping(false);
+    context.EnableAntialiasing(false);
+    if (clears)
+        context.ClearTarget(Color(255, 40, 80, 120));
+
+    for (int i = 0; i < 30; ++i)
+    {
+        context.SetSamplingMethod(next(2) ? SamplingMethod::LINEAR : SamplingMethod::NEAREST);
+        context.EnableAntialiasing(next(2));
+        context.EnableClipping(next(4) == 0);
+        context.SetClipping(coord(VERIFY_WIDTH / 2), coord(VERIFY_HEIGHT / 2), VERIFY_WIDTH / 2 + next(VERIFY_WIDTH),
+                            VERIFY_HEIGHT / 2 + next(VERIFY_HEIGHT));
+        Color color(next(3) ? 255 : next(256), next(256), next(256), next(256));
+        float matrix[3][3];
+        MakeRotation(static_cast<float>(next(360)), 48, 48, matrix);
+        matrix[0][2] += coord(VERIFY_WIDTH) - TARGET_SIZE / 2.0f;
+        matrix[1][2] += coord(VERIFY_HEIGHT) - TARGET_SIZE / 2.0f;
+
+        switch (next(clears ? 12 : 11))
+        {
+        case 0:
+            context.primitivesRenderer.DrawRect(color, coord(VERIFY_WIDTH), coord(VERIFY_HEIGHT), next(80), next(80));
+            break;
+        case 1:
+            context.primitivesRenderer.DrawLine(color, coord(VERIFY_WIDTH), coord(VERIFY_HEIGHT), coord(VERIFY_WIDTH), coord(VERIFY_HEIGHT));
+            break;
+        case 2:
+        {
+            PolygonPoint points[5];
+            for (PolygonPoint &point : points)
+                point = {coord(VERIFY_WIDTH) + next(100) / 100.0f, coord(VERIFY_HEIGHT) + next(100) / 100.0f};
+            context.primitivesRenderer.FillPolygon(color, points, 5, next(2) ? FillRule::NONZERO : FillRule::EVENODD);
+            break;
+        }
+        case 3:
+            context.primitivesRenderer.FillEllipse(color, coord(VERIFY_WIDTH), coord(VERIFY_HEIGHT), next(50), next(50));
+            break;
+        case 4:
+            context.primitivesRenderer.FillRoundedRect(color, coord(VERIFY_WIDTH), coord(VERIFY_HEIGHT), next(80), next(80), next(20));
+            break;
+        case 5:
+            context.primitivesRenderer.DrawArc(color, coord(VERIFY_WIDTH), coord(VERIFY_HEIGHT), next(50), 1 + next(10),
+                                               static_cast<float>(next(360)), static_cast<float>(next(360)));
+            break;
+        case 6:
+            context.primitivesRenderer.DrawTransformedRect(color, next(60), next(60), matrix);
+            break;
+        case 7:
+            context.basicTextureRenderer.DrawTexture(next(2) ? textures.sprite : textures.opaque, coord(VERIFY_WIDTH), coord(VERIFY_HEIGHT));
+            break;
+        case 8:
+            context.scaleTextureRenderer.DrawTexture(next(2) ? textures.sprite : textures.opaque, coord(VERIFY_WIDTH),
+                                                     coord(VERIFY_HEIGHT), 0.25f + next(300) / 100.0f, 0.25f + next(300) / 100.0f);
+            break;
+        case 9:
+            context.transformedTextureRenderer.DrawTexture(next(2) ? textures.sprite : textures.opaque, matrix);
+            break;
+        case 10:
+        {
+            float corners[4][2];
+            for (auto &corner : corners)
+            {
+                corner[0] = coord(VERIFY_WIDTH);
+                corner[1] = coord(VERIFY_HEIGHT);
+            }
+            // keep the quad convex and in order: top left, top right, bottom right, bottom left
+            corners[1][0] = corners[0][0] + 20 + next(100);
+            corners[2][0] = corners[3][0] + 20 + next(100);
+            corners[3][1] = corners[0][1] + 20 + next(80);
+            corners[2][1] = corners[1][1] + 20 + next(80);
+            context.transformedTextureRenderer.DrawTextureQuad(textures.sprite, corners);
+            break;
+        }
+        default:
+        {
+            DirtyRegion region;
+            region.Add(coord(VERIFY_WIDTH), coord(VERIFY_HEIGHT), coord(VERIFY_WIDTH), coord(VERIFY_HEIGHT));
+            context.ClearTarget(color, region);
+            break;
+        }
+        }
+    }
+}
+
+static int VerifyTiles()
+{
+    const uint16_t tileSizes[][2] = {{VERIFY_WIDTH, 16}, {64, 64}, {32, 32}, {17, 13}, {50, 8}, {8, 8}};
+    const uint8_t threadCounts[] = {1, 2, 4};
+    VerifyTextures textures;
+    RenderContext2D context;
+    size_t cases = 0, mismatches = 0;
+
+    for (PixelFormat target : {PixelFormat::RGB565, PixelFormat::ARGB8888, PixelFormat::RGBA8888})
+    {
+        BenchSurface background(VERIFY_WIDTH, VERIFY_HEIGHT, target);
+        size_t bytes = background.data.size();
+        std::vector<uint8_t> direct(bytes), tiled(bytes);
+        Texture directTexture(VERIFY_WIDTH, VERIFY_HEIGHT, direct.data(), target);
+        Texture tiledTexture(VERIFY_WIDTH, VERIFY_HEIGHT, tiled.data(), target);
+
+        for (uint32_t scene = 0; scene < 20; ++scene)
+        {
+            for (int clears = 0; clears < 2; ++clears)
+            {
+                uint32_t seed = scene * 7919u + 1;
+                direct = background.data;
+                context.SetTargetTexture(&directTexture);
+                DrawVerifyScene(context, textures, seed, clears);
+
+                DisplayList list;
+                context.SetTargetTexture(&tiledTexture);
+                context.BeginRecording(list);
+                DrawVerifyScene(context, textures, seed, clears);
+                context.EndRecording();
+
+                for (const auto &tileSize : tileSizes)
+                {
+                    for (uint8_t threads : threadCounts)
+                    {
+                        ++cases;
+                        ThreadPool pool(threads);
+                        TiledRenderer renderer(tileSize[0], tileSize[1]);
+                        if (threads > 1)
+                            renderer.SetWorkerPool(&pool);
+                        tiled = background.data;
+                        renderer.Render(context, list);
+                        if (tiled != direct)
+                        {
+                            ++mismatches;
+                            fprintf(stderr, "mismatch: %s scene %u%s, %ux%u tiles, %u threads\n", PixelFormatRegistry::GetInfo(target).name,
+                                    scene, clears ? " with clears" : "", tileSize[0], tileSize[1], threads);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    fprintf(stderr, "%zu cases, %zu mismatches\n", cases, mismatches);
+    return mismatches ? 1 : 0;
+}
+
+static std::vector<uint16_t> ParseSizes(const char *text)
+{
+    std::vector<uint16_t> sizes;
+    const char *pos = text;
+    while (*pos)
+    {
+        char *end = nullptr;
+        long value = strtol(pos, &end, 10);
+        if (end == pos)
+            break;
+        if (value > 0 && value <= TARGET_SIZE)
+            sizes.push_back(static_cast<uint16_t>(value));
+        pos = (*end == ',') ? end + 1 : end;
+    }
+    return sizes;
+}
+
+int main(int argc, char **argv)
+{
+    BenchSettings settings;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--json")
+            settings.json = true;
+        else if (arg == "--csv")
+            settings.json = false;
+        else if (arg == "--out" && i + 1 < argc)
+            settings.outFile = argv[++i];
+        else if (arg == "--sizes" && i + 1 < argc)
+            settings.sizes = ParseSizes(argv[++i]);
+        else if (arg == "--min-time" && i + 1 < argc)
+            settings.minTimeMs = atof(argv[++i]);
+        else if (arg == "--filter" && i + 1 < argc)
+            settings.filter = argv[++i];
+        else if (arg == "--verify-tiles")
+            return VerifyTiles();
+        else
+        {
+            fprintf(stderr, "usage: %s [--csv|--json] [--out file] [--sizes 16,64,256] [--min-time ms] [--filter text] [--verify-tiles]\n", argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (settings.sizes.empty())
+    {
+        fprintf(stderr, "no valid sizes given (1..%d)\n", TARGET_SIZE);
+        return 1;
+    }
+
+    BenchRunner runner(settings);
+    RenderContext2D context;
+    context.EnableClipping(false);
+
+    BenchClearTarget(runner, context);
+    BenchPrimitives(runner, context, settings);
+    BenchTextureRenderers(runner, context, settings);
+    BenchMasks(runner, context, settings);
+    BenchIndexed(runner, context, settings);
+    BenchScenes(runner, context);
+    BenchPixelConverter(runner, settings);
+    BenchBlendFunctions(runner, settings);
+
+    if (settings.outFile.empty())
+    {
+        runner.Write(std::cout);
+    }
+    else
+    {
+        std::ofstream file(settings.outFile);
+        if (!file)
+        {
+            fprintf(stderr, "Failed to open %s\n", settings.outFile.c_str());
+            return 1;
+        }
+        runner.Write(file);
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "DirtyRegion.h"
+#include <algorithm>
+
+using namespace Tergos2D;
+
+static inline int32_t Area(const DirtyRect &rect)
+{
+    return static_cast<int32_t>(rect.endX - rect.startX) * (rect.endY - rect.startY);
+}
+
+static inline DirtyRect Union(const DirtyRect &a, const DirtyRect &b)
+{
+    return {std::min(a.startX, b.startX), std::min(a.startY, b.startY),
+            std::max(a.endX, b.endX), std::max(a.endY, b.endY)};
+}
+
+static inline bool Touches(const DirtyRect &a, const DirtyRect &b)
+{
+    return a.startX <= b.endX && b.startX <= a.endX && a.startY <= b.endY && b.startY <= a.endY;
+}
+
+void DirtyRegion::Add(int16_t startX, int16_t startY, int16_t endX, int16_t endY)
+{
+    if (startX >= endX || startY >= endY)
+        return;
+    Merge({startX, startY, endX, endY});
+}
+
+void DirtyRegion::Add(const DirtyRegion &other)
+{
+    for (size_t i = 0; i < other.count; ++i)
+    {
+        Merge(other.rects[i]);
+    }
+}
+
+void DirtyRegion::Reset()
+{
+    count = 0;
+}
+
+size_t DirtyRegion::GetCount() const
+{
+    return count;
+}
+
+const DirtyRect &DirtyRegion::GetRect(size_t index) const
+{
+    return rects[index];
+}
+
+bool DirtyRegion::IsEmpty() const
+{
+    return count == 0;
+}
+
+DirtyRect DirtyRegion::GetBounds() const
+{
+    DirtyRect bounds = rects[0];
+    for (size_t i = 1; i < count; ++i)
+    {
+        bounds = Union(bounds, rects[i]);
+    }
+    return bounds;
+}
+
+void DirtyRegion::Merge(DirtyRect rect)
+{
+    // a merged rect can reach further rects, so keep folding until nothing touches it anymore
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (Touches(rects[i], rect))
+            {
+                rect = Union(rects[i], rect);
+                Remove(i);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    if (count < MAXDIRTYRECTS)
+    {
+        rects[count++] = rect;
+        return;
+    }
+
+    // full, grow the entry that adds the least area
+    size_t best = 0;
+    int32_t bestGrowth = INT32_MAX;
+    for (size_t i = 0; i < count; ++i)
+    {
+        int32_t growth = Area(Union(rects[i], rect)) - Area(rects[i]);
+        if (growth < bestGrowth)
+        {
+            bestGrowth = growth;
+            best = i;
+        }
+    }
+    rect = Union(rects[best], rect);
+    Remove(best);
+    Merge(rect);
+}
+
+void DirtyRegion::Remove(size_t index)
+{
+    rects[index] = rects[--count];
+}
@@ -0,0 +1,45 @@
+#ifndef DIRTYREGION_H
+#define DIRTYREGION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define MAXDIRTYRECTS 16
+
+namespace Tergos2D
+{
+    // end coordinates are exclusive, like the clipping area
+    struct DirtyRect
+    {
+        int16_t startX, startY, endX, endY;
+    };
+
+    // Merged list of the areas written since the last Reset. Rects that overlap or touch are merged,
+    // once the list is full a new rect is merged into the entry that grows the least.
+    class DirtyRegion
+    {
+    public:
+        DirtyRegion() = default;
+        ~DirtyRegion() = default;
+
+        void Add(int16_t startX, int16_t startY, int16_t endX, int16_t endY);
+        void Add(const DirtyRegion &other);
+        void Reset();
+
+        size_t GetCount() const;
+        const DirtyRect &GetRect(size_t index) const;
+        bool IsEmpty() const;
+
+        // bounding box of all rects, only valid when not empty
+        DirtyRect GetBounds() const;
+
+    private:
+        void Merge(DirtyRect rect);
+        void Remove(size_t index);
+
+        DirtyRect rects[MAXDIRTYRECTS];
+        size_t count = 0;
+    };
+}
+
+#endif // !DIRTYREGION_H
@@ -0,0 +1,456 @@
+#include "DisplayList.h"
+#include "../data/PixelFormat/PixelFormatInfo.h"
+#include "../data/PixelFormat/PixelConverter.h"
+#include <algorithm>
+#include <cstring>
+#include <math.h>
+
+using namespace Tergos2D;
+
+static inline bool Intersects(const DirtyRect &a, const DirtyRect &b)
+{
+    return a.startX < b.endX && b.startX < a.endX && a.startY < b.endY && b.startY < a.endY;
+}
+
+static inline bool Contains(const DirtyRect &outer, const DirtyRect &inner)
+{
+    return outer.startX <= inner.startX && outer.startY <= inner.startY && outer.endX >= inner.endX && outer.endY >= inner.endY;
+}
+
+static inline int16_t ClampToInt16(float value)
+{
+    return static_cast<int16_t>(std::max(-32768.0f, std::min(value, 32767.0f)));
+}
+
+// bounding box of a width x height rect moved by the matrix, as the renderers compute it. Perspective
+// matrices divide by w, a corner behind the viewer (w <= 0) can reach anywhere
+static DirtyRect TransformedBounds(const float matrix[3][3], float width, float height)
+{
+    const float corners[4][2] = {{0, 0}, {width, 0}, {0, height}, {width, height}};
+    bool perspective = matrix[2][0] != 0.0f || matrix[2][1] != 0.0f || matrix[2][2] != 1.0f;
+    float minX = corners[0][0], minY = corners[0][1], maxX = minX, maxY = minY;
+    for (int i = 0; i < 4; ++i)
+    {
+        float x = matrix[0][0] * corners[i][0] + matrix[0][1] * corners[i][1] + matrix[0][2];
+        float y = matrix[1][0] * corners[i][0] + matrix[1][1] * corners[i][1] + matrix[1][2];
+        if (perspective)
+        {
+            float w = matrix[2][0] * corners[i][0] + matrix[2][1] * corners[i][1] + matrix[2][2];
+            if (w <= 0.0f)
+                return {-32768, -32768, 32767, 32767};
+            x /= w;
+            y /= w;
+        }
+        if (i == 0 || x < minX) minX = x;
+        if (i == 0 || y < minY) minY = y;
+        if (i == 0 || x > maxX) maxX = x;
+        if (i == 0 || y > maxY) maxY = y;
+    }
+    return {ClampToInt16(std::floor(minX)), ClampToInt16(std::floor(minY)), ClampToInt16(std::ceil(maxX)), ClampToInt16(std::ceil(maxY))};
+}
+
+static bool SameState(const DrawState &a, const DrawState &b)
+{
+    const BlendContext &x = a.blendContext;
+    const BlendContext &y = b.blendContext;
+    return x.mode == y.mode &&
+           x.colorBlendFactorSrc == y.colorBlendFactorSrc && x.colorBlendFactorDst == y.colorBlendFactorDst &&
+           x.colorBlendOperation == y.colorBlendOperation &&
+           x.alphaBlendFactorSrc == y.alphaBlendFactorSrc && x.alphaBlendFactorDst == y.alphaBlendFactorDst &&
+           x.alphaBlendOperation == y.alphaBlendOperation && x.kernel == y.kernel &&
+           a.coloring.colorEnabled == b.coloring.colorEnabled &&
+           std::memcmp(a.coloring.color.data, b.coloring.color.data, 4) == 0 &&
+           a.clipping == b.clipping &&
+           (!a.clipping || (a.clippingArea.startX == b.clippingArea.startX && a.clippingArea.startY == b.clippingArea.startY &&
+                            a.clippingArea.endX == b.clippingArea.endX && a.clippingArea.endY == b.clippingArea.endY)) &&
+           a.samplingMethod == b.samplingMethod && a.antialiasing == b.antialiasing && a.blendFunc == b.blendFunc;
+}
+
+void DisplayList::Clear()
+{
+    commands.clear();
+    states.clear();
+    polygonPoints.clear();
+}
+
+size_t DisplayList::GetCommandCount() const
+{
+    return commands.size();
+}
+
+const DrawCommand &DisplayList::GetCommand(size_t index) const
+{
+    return commands[index];
+}
+
+const DrawState &DisplayList::GetState(size_t index) const
+{
+    return states[index];
+}
+
+const PolygonPoint *DisplayList::GetPolygonPoints(const DrawCommand &command) const
+{
+    return polygonPoints.data() + command.polygon.firstPoint;
+}
+
+DrawCommand &DisplayList::Push(RenderContext2D &context, DrawCommandType type, DirtyRect bounds)
+{
+    DrawState state;
+    state.blendContext = context.GetBlendContext();
+    state.coloring = context.GetColoring();
+    state.clippingArea = context.GetClippingArea();
+    state.clipping = context.IsClippingEnabled();
+    state.samplingMethod = context.GetSamplingMethod();
+    state.antialiasing = context.IsAntialiasingEnabled();
+    state.blendFunc = context.GetBlendFunc();
+
+    if (states.empty() || !SameState(states.back(), state))
+        states.push_back(state);
+
+    if (state.clipping)
+    {
+        bounds.startX = std::max(bounds.startX, state.clippingArea.startX);
+        bounds.startY = std::max(bounds.startY, state.clippingArea.startY);
+        bounds.endX = std::min(bounds.endX, state.clippingArea.endX);
+        bounds.endY = std::min(bounds.endY, state.clippingArea.endY);
+    }
+
+    commands.emplace_back();
+    DrawCommand &command = commands.back();
+    command.type = type;
+    command.stateIndex = static_cast<uint32_t>(states.size() - 1);
+    command.bounds = bounds;
+    return command;
+}
+
+void DisplayList::RecordClear(RenderContext2D &context, Color color, DirtyRect area)
+{
+    // clears ignore clipping, so the bounds are set again after Push
+    DrawCommand &command = Push(context, DrawCommandType::CLEAR, area);
+    command.bounds = area;
+    command.color = color;
+}
+
+void DisplayList::RecordRect(RenderContext2D &context, Color color, int16_t x, int16_t y, uint16_t length, uint16_t height)
+{
+    DrawCommand &command = Push(context, DrawCommandType::RECT,
+                                {x, y, static_cast<int16_t>(x + length), static_cast<int16_t>(y + height)});
+    command.color = color;
+    command.rect = {x, y, length, height};
+}
+
+void DisplayList::RecordLine(RenderContext2D &context, Color color, int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+    // both end points are drawn, so the bounds end one past them on every path of DrawLine
+    DrawCommand &command = Push(context, DrawCommandType::LINE,
+                                {std::min(x0, x1), std::min(y0, y1),
+                                 static_cast<int16_t>(std::max(x0, x1) + 1), static_cast<int16_t>(std::max(y0, y1) + 1)});
+    command.color = color;
+    command.line = {x0, y0, x1, y1};
+}
+
+void DisplayList::RecordTransformedRect(RenderContext2D &context, Color color, uint16_t length, uint16_t height, const float transformationMatrix[3][3])
+{
+    DrawCommand &command = Push(context, DrawCommandType::TRANSFORMEDRECT, TransformedBounds(transformationMatrix, length, height));
+    command.color = color;
+    std::memcpy(command.transform.matrix, transformationMatrix, sizeof(command.transform.matrix));
+    command.transform.startX = 0;
+    command.transform.startY = 0;
+    command.transform.endX = length;
+    command.transform.endY = height;
+}
+
+void DisplayList::RecordTexture(RenderContext2D &context, Texture &texture, int16_t x, int16_t y)
+{
+    DrawCommand &command = Push(context, DrawCommandType::TEXTURE,
+                                {x, y, static_cast<int16_t>(x + texture.GetWidth()), static_cast<int16_t>(y + texture.GetHeight())});
+    command.texture = &texture;
+    command.textureParams = {x, y, 1.0f, 1.0f};
+}
+
+void DisplayList::RecordScaledTexture(RenderContext2D &context, Texture &texture, int16_t x, int16_t y, float scaleX, float scaleY)
+{
+    uint16_t dstWidth = static_cast<uint16_t>(texture.GetWidth() * scaleX);
+    uint16_t dstHeight = static_cast<uint16_t>(texture.GetHeight() * scaleY);
+    DrawCommand &command = Push(context, DrawCommandType::SCALEDTEXTURE,
+                                {x, y, static_cast<int16_t>(x + dstWidth), static_cast<int16_t>(y + dstHeight)});
+    command.texture = &texture;
+    command.textureParams = {x, y, scaleX, scaleY};
+}
+
+void DisplayList::RecordTransformedTexture(RenderContext2D &context, Texture &texture, const float transformationMatrix[3][3],
+                                           int startX, int startY, int endX, int endY)
+{
+    DrawCommand &command = Push(context, DrawCommandType::TRANSFORMEDTEXTURE,
+                                TransformedBounds(transformationMatrix, texture.GetWidth(), texture.GetHeight()));
+    command.texture = &texture;
+    std::memcpy(command.transform.matrix, transformationMatrix, sizeof(command.transform.matrix));
+    command.transform.startX = startX;
+    command.transform.startY = startY;
+    command.transform.endX = endX;
+    command.transform.endY = endY;
+}
+
+void DisplayList::RecordPolygon(RenderContext2D &context, Color color, const PolygonPoint *points, uint16_t count, FillRule rule)
+{
+    if (points == nullptr || count < 3)
+        return;
+    float minX = points[0].x, minY = points[0].y, maxX = minX, maxY = minY;
+    for (uint16_t i = 1; i < count; ++i)
+    {
+        minX = std::min(minX, points[i].x);
+        minY = std::min(minY, points[i].y);
+        maxX = std::max(maxX, points[i].x);
+        maxY = std::max(maxY, points[i].y);
+    }
+    DrawCommand &command = Push(context, DrawCommandType::POLYGON,
+                                {ClampToInt16(std::floor(minX)), ClampToInt16(std::floor(minY)), ClampToInt16(std::ceil(maxX)), ClampToInt16(std::ceil(maxY))});
+    command.color = color;
+    command.polygon = {static_cast<uint32_t>(polygonPoints.size()), count, rule};
+    polygonPoints.insert(polygonPoints.end(), points, points + count);
+}
+
+void DisplayList::RecordEllipse(RenderContext2D &context, Color color, int16_t centerX, int16_t centerY, uint16_t radiusX, uint16_t radiusY)
+{
+    DrawCommand &command = Push(context, DrawCommandType::ELLIPSE,
+                                {ClampToInt16(centerX - radiusX), ClampToInt16(centerY - radiusY),
+                                 ClampToInt16(centerX + radiusX + 1), ClampToInt16(centerY + radiusY + 1)});
+    command.color = color;
+    command.ellipse = {centerX, centerY, radiusX, radiusY};
+}
+
+void DisplayList::RecordRoundedRect(RenderContext2D &context, Color color, int16_t x, int16_t y, uint16_t length, uint16_t height, uint16_t radius)
+{
+    DrawCommand &command = Push(context, DrawCommandType::ROUNDEDRECT,
+                                {x, y, static_cast<int16_t>(x + length), static_cast<int16_t>(y + height)});
+    command.color = color;
+    command.roundedRect = {x, y, length, height, radius};
+}
+
+void DisplayList::RecordArc(RenderContext2D &context, Color color, int16_t centerX, int16_t centerY, uint16_t radius, uint16_t thickness,
+                            float startAngle, float endAngle)
+{
+    DrawCommand &command = Push(context, DrawCommandType::ARC,
+                                {ClampToInt16(centerX - radius), ClampToInt16(centerY - radius),
+                                 ClampToInt16(centerX + radius + 1), ClampToInt16(centerY + radius + 1)});
+    command.color = color;
+    command.arc = {centerX, centerY, radius, thickness, startAngle, endAngle};
+}
+
+void DisplayList::SortByTexture()
+{
+    std::vector<DrawCommand> sorted;
+    sorted.reserve(commands.size());
+
+    for (const DrawCommand &command : commands)
+    {
+        size_t insertAt = sorted.size();
+        if (command.type != DrawCommandType::CLEAR)
+        {
+            // walk back until the last command with the same texture, stop at the first overlap
+            for (size_t i = sorted.size(); i-- > 0;)
+            {
+                if (sorted[i].texture == command.texture && sorted[i].type != DrawCommandType::CLEAR)
+                {
+                    insertAt = i + 1;
+                    break;
+                }
+                if (Intersects(sorted[i].bounds, command.bounds))
+                    break;
+            }
+        }
+        sorted.insert(sorted.begin() + insertAt, command);
+    }
+
+    commands.swap(sorted);
+}
+
+// whether the texture renderers convert the texture onto a target of targetFormat when they don't blend,
+// they draw nothing for sources they have no conversion for
+static bool ConvertsTexture(const DrawCommand &command, const DrawState &state, PixelFormat targetFormat)
+{
+    Texture &texture = *command.texture;
+    if (!texture.GetData())
+        return false;
+    const PixelFormatInfo &info = PixelFormatRegistry::GetInfo(texture.GetFormat());
+    bool scaled = command.type == DrawCommandType::SCALEDTEXTURE &&
+                  (command.textureParams.scaleX != 1 || command.textureParams.scaleY != 1);
+    // indexed rows go through the palette in ARGB8888, A4 and A1 rows are unpacked to A8 and only drawn unscaled
+    if (info.isIndexed)
+        return texture.GetPalette() && !PixelFormatRegistry::GetInfo(targetFormat).isBitFormat &&
+               PixelConverter::GetConversionFunction(PixelFormat::ARGB8888, targetFormat);
+    if (info.isBitFormat)
+        return !scaled && PixelConverter::GetConversionFunction(PixelFormat::A8, targetFormat);
+    // bilinear scaling samples packed 16 bit rows in ARGB8888
+    if (scaled && state.samplingMethod == SamplingMethod::LINEAR && info.bytesPerPixel == 2)
+        return PixelConverter::GetConversionFunction(info.format, PixelFormat::ARGB8888) &&
+               PixelConverter::GetConversionFunction(PixelFormat::ARGB8888, targetFormat);
+    return PixelConverter::GetConversionFunction(info.format, targetFormat) != nullptr;
+}
+
+bool DisplayList::IsOpaque(const DrawCommand &command, PixelFormat targetFormat) const
+{
+    const DrawState &state = states[command.stateIndex];
+    switch (command.type)
+    {
+    case DrawCommandType::CLEAR:
+        return true;
+    case DrawCommandType::RECT:
+        // DrawRect switches to NOBLEND for opaque colors
+        return command.color.data[0] == 255;
+    case DrawCommandType::TEXTURE:
+    case DrawCommandType::SCALEDTEXTURE:
+    {
+        // same decision as RenderContext2D::BlendModeToUse, indexed textures decide on their palette
+        const PixelFormatInfo &info = PixelFormatRegistry::GetInfo(command.texture->GetFormat());
+        bool hasAlpha = info.isIndexed ? command.texture->PaletteHasAlpha() : info.hasAlpha;
+        bool noBlend = state.blendContext.mode == BlendMode::NOBLEND || (!hasAlpha && !state.coloring.colorEnabled);
+        return noBlend && ConvertsTexture(command, state, targetFormat);
+    }
+    default:
+        return false;
+    }
+}
+
+size_t DisplayList::CullOccluded(PixelFormat targetFormat)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < commands.size(); ++i)
+    {
+        bool covered = false;
+        for (size_t j = i + 1; j < commands.size() && !covered; ++j)
+        {
+            covered = IsOpaque(commands[j], targetFormat) && Contains(commands[j].bounds, commands[i].bounds);
+        }
+        if (!covered)
+            commands[kept++] = commands[i];
+    }
+
+    size_t removed = commands.size() - kept;
+    commands.resize(kept);
+    return removed;
+}
+
+void DisplayList::Replay(RenderContext2D &context) const
+{
+    Replay(context, nullptr, commands.size(), nullptr);
+}
+
+void DisplayList::Replay(RenderContext2D &context, const uint32_t *indices, size_t count, const ClippingArea *area) const
+{
+    DisplayList *recording = context.GetRecordingList();
+    context.EndRecording();
+
+    BlendContext savedBlendContext = context.GetBlendContext();
+    Coloring savedColoring = context.GetColoring();
+    ClippingArea savedClippingArea = context.GetClippingArea();
+    bool savedClipping = context.IsClippingEnabled();
+    SamplingMethod savedSamplingMethod = context.GetSamplingMethod();
+    bool savedAntialiasing = context.IsAntialiasingEnabled();
+    BlendFunc savedBlendFunc = context.GetBlendFunc();
+
+    size_t currentState = SIZE_MAX;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const DrawCommand &command = commands[indices != nullptr ? indices[i] : i];
+        if (area != nullptr && !Intersects(command.bounds, {area->startX, area->startY, area->endX, area->endY}))
+            continue;
+
+        if (command.stateIndex != currentState)
+        {
+            const DrawState &state = states[command.stateIndex];
+            ClippingArea clippingArea = state.clippingArea;
+            bool clipping = state.clipping;
+            if (area != nullptr)
+            {
+                if (!clipping)
+                    clippingArea = *area;
+                clippingArea.startX = std::max(clippingArea.startX, area->startX);
+                clippingArea.startY = std::max(clippingArea.startY, area->startY);
+                clippingArea.endX = std::min(clippingArea.endX, area->endX);
+                clippingArea.endY = std::min(clippingArea.endY, area->endY);
+                clipping = true;
+            }
+            context.SetBlendContext(state.blendContext);
+            context.SetColoringSettings(state.coloring);
+            context.SetClipping(clippingArea.startX, clippingArea.startY, clippingArea.endX, clippingArea.endY);
+            context.EnableClipping(clipping);
+            context.SetSamplingMethod(state.samplingMethod);
+            context.EnableAntialiasing(state.antialiasing);
+            context.SetBlendFunc(state.blendFunc);
+            currentState = command.stateIndex;
+        }
+
+        switch (command.type)
+        {
+        case DrawCommandType::CLEAR:
+            if (area == nullptr && command.bounds.endX == INT16_MAX && command.bounds.endY == INT16_MAX)
+            {
+                context.ClearTarget(command.color);
+            }
+            else
+            {
+                // clears ignore clipping, so the area is applied to the cleared rect
+                DirtyRect rect = command.bounds;
+                if (area != nullptr)
+                {
+                    rect.startX = std::max(rect.startX, area->startX);
+                    rect.startY = std::max(rect.startY, area->startY);
+                    rect.endX = std::min(rect.endX, area->endX);
+                    rect.endY = std::min(rect.endY, area->endY);
+                }
+                DirtyRegion region;
+                region.Add(rect.startX, rect.startY, rect.endX, rect.endY);
+                context.ClearTarget(command.color, region);
+            }
+            break;
+        case DrawCommandType::RECT:
+            context.primitivesRenderer.DrawRect(command.color, command.rect.x, command.rect.y, command.rect.length, command.rect.height);
+            break;
+        case DrawCommandType::LINE:
+            context.primitivesRenderer.DrawLine(command.color, command.line.x0, command.line.y0, command.line.x1, command.line.y1);
+            break;
+        case DrawCommandType::TRANSFORMEDRECT:
+            context.primitivesRenderer.DrawTransformedRect(command.color, command.transform.endX, command.transform.endY, command.transform.matrix);
+            break;
+        case DrawCommandType::TEXTURE:
+            context.basicTextureRenderer.DrawTexture(*command.texture, command.textureParams.x, command.textureParams.y);
+            break;
+        case DrawCommandType::SCALEDTEXTURE:
+            context.scaleTextureRenderer.DrawTexture(*command.texture, command.textureParams.x, command.textureParams.y,
+                                                     command.textureParams.scaleX, command.textureParams.scaleY);
+            break;
+        case DrawCommandType::TRANSFORMEDTEXTURE:
+            context.transformedTextureRenderer.DrawTexture(*command.texture, command.transform.matrix,
+                                                           command.transform.startX, command.transform.startY,
+                                                           command.transform.endX, command.transform.endY);
+            break;
+        case DrawCommandType::POLYGON:
+            context.primitivesRenderer.FillPolygon(command.color, GetPolygonPoints(command), command.polygon.pointCount, command.polygon.rule);
+            break;
+        case DrawCommandType::ELLIPSE:
+            context.primitivesRenderer.FillEllipse(command.color, command.ellipse.centerX, command.ellipse.centerY,
+                                                   command.ellipse.radiusX, command.ellipse.radiusY);
+            break;
+        case DrawCommandType::ROUNDEDRECT:
+            context.primitivesRenderer.FillRoundedRect(command.color, command.roundedRect.x, command.roundedRect.y,
+                                                       command.roundedRect.length, command.roundedRect.height, command.roundedRect.radius);
+            break;
+        case DrawCommandType::ARC:
+            context.primitivesRenderer.DrawArc(command.color, command.arc.centerX, command.arc.centerY, command.arc.radius,
+                                               command.arc.thickness, command.arc.startAngle, command.arc.endAngle);
+            break;
+        }
+    }
+
+    context.SetBlendContext(savedBlendContext);
+    context.SetColoringSettings(savedColoring);
+    context.SetClipping(savedClippingArea.startX, savedClippingArea.startY, savedClippingArea.endX, savedClippingArea.endY);
+    context.EnableClipping(savedClipping);
+    context.SetSamplingMethod(savedSamplingMethod);
+    context.EnableAntialiasing(savedAntialiasing);
+    context.SetBlendFunc(savedBlendFunc);
+
+    if (recording != nullptr)
+        context.BeginRecording(*recording);
+}
@@ -0,0 +1,174 @@
+#ifndef DISPLAYLIST_H
+#define DISPLAYLIST_H
+
+#include <stdint.h>
+#include <vector>
+#include "../data/Color.h"
+#include "../data/Texture.h"
+#include "../data/BlendMode/BlendMode.h"
+#include "../data/BlendMode/BlendFunctions.h"
+#include "DirtyRegion.h"
+#include "RenderContext2D.h"
+
+namespace Tergos2D
+{
+    enum class DrawCommandType : uint8_t
+    {
+        CLEAR,
+        RECT,
+        LINE,
+        TRANSFORMEDRECT,
+        TEXTURE,
+        SCALEDTEXTURE,
+        TRANSFORMEDTEXTURE,
+        POLYGON,
+        ELLIPSE,
+        ROUNDEDRECT,
+        ARC
+    };
+
+    // context state a command was recorded with, commands recorded with the same state share one entry
+    struct DrawState
+    {
+        BlendContext blendContext;
+        Coloring coloring;
+        ClippingArea clippingArea;
+        bool clipping;
+        SamplingMethod samplingMethod;
+        bool antialiasing;
+        BlendFunc blendFunc;
+    };
+
+    struct RectParams
+    {
+        int16_t x, y;
+        uint16_t length, height;
+    };
+
+    struct LineParams
+    {
+        int16_t x0, y0, x1, y1;
+    };
+
+    struct TextureParams
+    {
+        int16_t x, y;
+        float scaleX, scaleY;
+    };
+
+    struct TransformParams
+    {
+        float matrix[3][3];
+        // rect size for TRANSFORMEDRECT, source sub area for TRANSFORMEDTEXTURE
+        int16_t startX, startY, endX, endY;
+    };
+
+    struct PolygonParams
+    {
+        // points are stored in the list, see DisplayList::GetPolygonPoints
+        uint32_t firstPoint;
+        uint16_t pointCount;
+        FillRule rule;
+    };
+
+    struct EllipseParams
+    {
+        int16_t centerX, centerY;
+        uint16_t radiusX, radiusY;
+    };
+
+    struct RoundedRectParams
+    {
+        int16_t x, y;
+        uint16_t length, height, radius;
+    };
+
+    struct ArcParams
+    {
+        int16_t centerX, centerY;
+        uint16_t radius, thickness;
+        float startAngle, endAngle;
+    };
+
+    struct DrawCommand
+    {
+        Color color;
+        Texture *texture = nullptr;
+        // area the command writes to, clipped but not limited to a target size
+        DirtyRect bounds;
+        DrawCommandType type;
+        // index into the state list, see DisplayList::GetState
+        uint32_t stateIndex;
+        union
+        {
+            RectParams rect;
+            LineParams line;
+            TextureParams textureParams;
+            TransformParams transform;
+            PolygonParams polygon;
+            EllipseParams ellipse;
+            RoundedRectParams roundedRect;
+            ArcParams arc;
+        };
+    };
+
+    // Draw calls captured while a RenderContext2D is recording, the list can be reordered,
+    // culled and replayed later onto any target. Textures are referenced, not copied, so they
+    // have to stay alive until the list is replayed.
+    class DisplayList
+    {
+    public:
+        DisplayList() = default;
+        ~DisplayList() = default;
+
+        void Clear();
+        size_t GetCommandCount() const;
+        const DrawCommand &GetCommand(size_t index) const;
+        const DrawState &GetState(size_t index) const;
+        const PolygonPoint *GetPolygonPoints(const DrawCommand &command) const;
+
+        // called by the renderers while recording
+        void RecordClear(RenderContext2D &context, Color color, DirtyRect area);
+        void RecordRect(RenderContext2D &context, Color color, int16_t x, int16_t y, uint16_t length, uint16_t height);
+        void RecordLine(RenderContext2D &context, Color color, int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+        void RecordTransformedRect(RenderContext2D &context, Color color, uint16_t length, uint16_t height, const float transformationMatrix[3][3]);
+        void RecordTexture(RenderContext2D &context, Texture &texture, int16_t x, int16_t y);
+        void RecordScaledTexture(RenderContext2D &context, Texture &texture, int16_t x, int16_t y, float scaleX, float scaleY);
+        void RecordTransformedTexture(RenderContext2D &context, Texture &texture, const float transformationMatrix[3][3],
+                                      int startX, int startY, int endX, int endY);
+        void RecordPolygon(RenderContext2D &context, Color color, const PolygonPoint *points, uint16_t count, FillRule rule);
+        void RecordEllipse(RenderContext2D &context, Color color, int16_t centerX, int16_t centerY, uint16_t radiusX, uint16_t radiusY);
+        void RecordRoundedRect(RenderContext2D &context, Color color, int16_t x, int16_t y, uint16_t length, uint16_t height, uint16_t radius);
+        void RecordArc(RenderContext2D &context, Color color, int16_t centerX, int16_t centerY, uint16_t radius, uint16_t thickness,
+                       float startAngle, float endAngle);
+
+        /// @brief Groups commands drawing the same texture, a command only moves past commands it doesn't overlap
+        void SortByTexture();
+
+        /// @brief Removes commands that are completely covered by a later opaque rect, texture or clear
+        /// @param targetFormat format of the target the list is replayed onto
+        /// @return number of removed commands
+        size_t CullOccluded(PixelFormat targetFormat);
+
+        /// @brief Executes all commands on the current target of context, the context state is restored afterwards
+        void Replay(RenderContext2D &context) const;
+
+        /// @brief Executes the listed commands limited to area, clears included
+        /// @param indices command indices in drawing order, nullptr for all commands
+        /// @param area clipping applied on top of the recorded one, nullptr for none
+        void Replay(RenderContext2D &context, const uint32_t *indices, size_t count, const ClippingArea *area) const;
+
+        /// @brief Whether the command overwrites every pixel in its bounds on a target of targetFormat
+        /// without reading it
+        bool IsOpaque(const DrawCommand &command, PixelFormat targetFormat) const;
+
+    private:
+        DrawCommand &Push(RenderContext2D &context, DrawCommandType type, DirtyRect bounds);
+
+        std::vector<DrawCommand> commands;
+        std::vector<DrawState> states;
+        std::vector<PolygonPoint> polygonPoints;
+    };
+}
+
+#endif // !DISPLAYLIST_H
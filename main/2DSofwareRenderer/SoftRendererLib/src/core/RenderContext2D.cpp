@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include "../util/MemHandler.h"
 #include "../data/BlendMode/BlendFunctions.h"
+#include "DisplayList.h"
 
 using namespace Tergos2D;
 
@@ -13,6 +14,7 @@ using namespace Tergos2D;
 
 RenderContext2D::RenderContext2D() : primitivesRenderer(*this), basicTextureRenderer(*this), transformedTextureRenderer(*this),scaleTextureRenderer(*this)
 {
+    m_BlendContext.kernel = BlendFunctions::GetBlendKernel(m_BlendContext);
 }
 void RenderContext2D::SetTargetTexture(Texture *targettexture)
 {
@@ -47,9 +49,25 @@ SamplingMethod Tergos2D::RenderContext2D::GetSamplingMethod()
     return samplingMethod;
 }
 
+void Tergos2D::RenderContext2D::EnableAntialiasing(bool antialiasing)
+{
+    this->enableAntialiasing = antialiasing;
+}
+
+bool Tergos2D::RenderContext2D::IsAntialiasingEnabled()
+{
+    return enableAntialiasing;
+}
+
 
 void RenderContext2D::ClearTarget(Color color)
 {
+    if (recordingList != nullptr)
+    {
+        recordingList->RecordClear(*this, color, {0, 0, INT16_MAX, INT16_MAX});
+        return;
+    }
+
     if (targetTexture == nullptr)
     {
         return;
@@ -59,25 +77,77 @@ void RenderContext2D::ClearTarget(Color color)
     PixelFormatInfo info = PixelFormatRegistry::GetInfo(format);
 
     uint8_t *textureData = targetTexture->GetData();
-    uint16_t width = targetTexture->GetWidth();
-    uint16_t height = targetTexture->GetHeight();
+    uint16_t originX = targetTexture->GetOriginX();
+    uint16_t originY = targetTexture->GetOriginY();
+    uint16_t width = targetTexture->GetWidth() - originX;
+    uint16_t height = targetTexture->GetHeight() - originY;
     uint32_t pitch = targetTexture->GetPitch();
 
     uint8_t pixelData[4];
     color.ConvertTo(format, pixelData);
 
     // Fill the first row with the pixel data
-    uint8_t *row = textureData;
-    for (uint32_t x = 0; x < width; ++x)
-    {
-        MemHandler::MemCopy(row + x * info.bytesPerPixel, pixelData, info.bytesPerPixel);
-    }
+    PixelConverter::Fill(textureData, pixelData, width, info.bytesPerPixel);
 
     // Copy the first row to the rest of the rows
     for (uint32_t y = 1; y < height; ++y)
     {
         MemHandler::MemCopy(textureData + y * pitch, textureData, width * info.bytesPerPixel);
     }
+
+    MarkDirty(originX, originY, originX + width, originY + height);
+}
+
+void RenderContext2D::ClearTarget(Color color, const DirtyRegion &region)
+{
+    if (recordingList != nullptr)
+    {
+        for (size_t i = 0; i < region.GetCount(); ++i)
+        {
+            recordingList->RecordClear(*this, color, region.GetRect(i));
+        }
+        return;
+    }
+
+    if (targetTexture == nullptr)
+    {
+        return;
+    }
+
+    PixelFormat format = targetTexture->GetFormat();
+    PixelFormatInfo info = PixelFormatRegistry::GetInfo(format);
+
+    uint8_t *textureData = targetTexture->GetData();
+    int16_t originX = targetTexture->GetOriginX();
+    int16_t originY = targetTexture->GetOriginY();
+    int16_t width = targetTexture->GetWidth();
+    int16_t height = targetTexture->GetHeight();
+    uint32_t pitch = targetTexture->GetPitch();
+
+    uint8_t pixelData[4];
+    color.ConvertTo(format, pixelData);
+
+    for (size_t i = 0; i < region.GetCount(); ++i)
+    {
+        const DirtyRect &rect = region.GetRect(i);
+        int16_t startX = std::max(rect.startX, originX);
+        int16_t startY = std::max(rect.startY, originY);
+        int16_t endX = std::min(rect.endX, width);
+        int16_t endY = std::min(rect.endY, height);
+        if (startX >= endX || startY >= endY)
+            continue;
+
+        // Fill the first row of the rect and copy it to the others
+        uint8_t *firstRow = textureData + (startY - originY) * pitch + (startX - originX) * info.bytesPerPixel;
+        size_t bytesPerRow = (endX - startX) * info.bytesPerPixel;
+        PixelConverter::Fill(firstRow, pixelData, endX - startX, info.bytesPerPixel);
+        for (int16_t y = startY + 1; y < endY; ++y)
+        {
+            MemHandler::MemCopy(firstRow + (y - startY) * pitch, firstRow, bytesPerRow);
+        }
+
+        MarkDirty(startX, startY, endX, endY);
+    }
 }
 
 
@@ -123,7 +193,7 @@ BlendFunc Tergos2D::RenderContext2D::GetBlendFunc()
     return blendFunc;
 }
 
-BlendContext &Tergos2D::RenderContext2D::GetBlendContext()
+const BlendContext &Tergos2D::RenderContext2D::GetBlendContext()
 {
     return m_BlendContext;
 }
@@ -131,4 +201,55 @@ BlendContext &Tergos2D::RenderContext2D::GetBlendContext()
 void Tergos2D::RenderContext2D::SetBlendContext(BlendContext context)
 {
     this->m_BlendContext = context;
+    this->m_BlendContext.kernel = BlendFunctions::GetBlendKernel(context);
+}
+
+void Tergos2D::RenderContext2D::EnableDirtyTracking(bool tracking)
+{
+    this->enableDirtyTracking = tracking;
+}
+
+bool Tergos2D::RenderContext2D::IsDirtyTrackingEnabled()
+{
+    return enableDirtyTracking;
+}
+
+void Tergos2D::RenderContext2D::MarkDirty(int16_t startX, int16_t startY, int16_t endX, int16_t endY)
+{
+    if (!enableDirtyTracking || targetTexture == nullptr)
+        return;
+
+    // renderers pass their clipped area, only the texture bounds are enforced here
+    dirtyRegion.Add(std::max<int16_t>(startX, 0), std::max<int16_t>(startY, 0),
+                    std::min<int16_t>(endX, targetTexture->GetWidth()), std::min<int16_t>(endY, targetTexture->GetHeight()));
+}
+
+const DirtyRegion &Tergos2D::RenderContext2D::GetDirtyRegion()
+{
+    return dirtyRegion;
+}
+
+void Tergos2D::RenderContext2D::ResetDirtyRegion()
+{
+    dirtyRegion.Reset();
+}
+
+void Tergos2D::RenderContext2D::BeginRecording(DisplayList &list)
+{
+    this->recordingList = &list;
+}
+
+void Tergos2D::RenderContext2D::EndRecording()
+{
+    this->recordingList = nullptr;
+}
+
+bool Tergos2D::RenderContext2D::IsRecording()
+{
+    return recordingList != nullptr;
+}
+
+DisplayList *Tergos2D::RenderContext2D::GetRecordingList()
+{
+    return recordingList;
 }
@@ -6,6 +6,7 @@
 #include "../data/Color.h"
 #include "../data/BlendMode/BlendMode.h"
 #include "../data/BlendMode/BlendFunctions.h"
+#include "DirtyRegion.h"
 #include "Renderers/PrimitivesRenderer.h"
 #include "Renderers/BasicTextureRenderer.h"
 #include "Renderers/TransformedTextureRenderer.h"
@@ -18,6 +19,8 @@
 
 namespace Tergos2D
 {
+    class DisplayList;
+
     enum class SamplingMethod
     {
         NEAREST,
@@ -51,6 +54,11 @@ namespace Tergos2D
         void SetSamplingMethod(SamplingMethod method);
         SamplingMethod GetSamplingMethod();
 
+        // When enabled lines and polygons get anti-aliased edges, the partly covered pixels are
+        // blended with their coverage even when the color is opaque
+        void EnableAntialiasing(bool antialiasing);
+        bool IsAntialiasingEnabled();
+
 
         void ClearTarget(Color color);
         void EnableClipping(bool clipping);
@@ -65,19 +73,43 @@ namespace Tergos2D
         void SetBlendFunc(BlendFunc blendFunc);
         BlendFunc GetBlendFunc();
 
-        BlendContext& GetBlendContext();
+        const BlendContext& GetBlendContext();
         void SetBlendContext(BlendContext context);
 
+        // When enabled every renderer adds the target area it writes to the dirty region,
+        // so clears and display flushes can be limited to what changed.
+        void EnableDirtyTracking(bool tracking);
+        bool IsDirtyTrackingEnabled();
+        void MarkDirty(int16_t startX, int16_t startY, int16_t endX, int16_t endY);
+        const DirtyRegion& GetDirtyRegion();
+        void ResetDirtyRegion();
+
+        // Clears only the rects of region, for example the region a buffer was drawn with last time
+        void ClearTarget(Color color, const DirtyRegion& region);
+
+        // While recording, clears and renderer draw calls are added to list instead of being executed,
+        // use DisplayList::Replay to draw them
+        void BeginRecording(DisplayList& list);
+        void EndRecording();
+        bool IsRecording();
+        DisplayList* GetRecordingList();
+
     private:
         Texture *targetTexture = nullptr;
         BlendContext m_BlendContext = BlendContext();
         SamplingMethod samplingMethod = SamplingMethod::NEAREST;
+        bool enableAntialiasing = false;
 
         Coloring colorOverlay;
         BlendFunc blendFunc = BlendFunctions::BlendRow;
         // clipping area
         ClippingArea clippingArea;
         bool enableClipping = false;
+
+        DirtyRegion dirtyRegion;
+        bool enableDirtyTracking = false;
+
+        DisplayList *recordingList = nullptr;
     };
 }
 #endif
\ No newline at end of file
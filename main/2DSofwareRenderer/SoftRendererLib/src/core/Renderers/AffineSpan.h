@@ -0,0 +1,213 @@
+#ifndef AFFINESPAN_H
+#define AFFINESPAN_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace Tergos2D
+{
+    /// @brief false when the matrix is not invertible
+    inline bool InvertMatrix(const float matrix[3][3], float inverse[3][3])
+    {
+        float det = matrix[0][0] * (matrix[1][1] * matrix[2][2] - matrix[1][2] * matrix[2][1]) -
+                    matrix[0][1] * (matrix[1][0] * matrix[2][2] - matrix[1][2] * matrix[2][0]) +
+                    matrix[0][2] * (matrix[1][0] * matrix[2][1] - matrix[1][1] * matrix[2][0]);
+        if (det == 0.0f)
+            return false;
+
+        float invDet = 1.0f / det;
+        inverse[0][0] = (matrix[1][1] * matrix[2][2] - matrix[1][2] * matrix[2][1]) * invDet;
+        inverse[0][1] = (matrix[0][2] * matrix[2][1] - matrix[0][1] * matrix[2][2]) * invDet;
+        inverse[0][2] = (matrix[0][1] * matrix[1][2] - matrix[0][2] * matrix[1][1]) * invDet;
+        inverse[1][0] = (matrix[1][2] * matrix[2][0] - matrix[1][0] * matrix[2][2]) * invDet;
+        inverse[1][1] = (matrix[0][0] * matrix[2][2] - matrix[0][2] * matrix[2][0]) * invDet;
+        inverse[1][2] = (matrix[0][2] * matrix[1][0] - matrix[0][0] * matrix[1][2]) * invDet;
+        inverse[2][0] = (matrix[1][0] * matrix[2][1] - matrix[1][1] * matrix[2][0]) * invDet;
+        inverse[2][1] = (matrix[0][1] * matrix[2][0] - matrix[0][0] * matrix[2][1]) * invDet;
+        inverse[2][2] = (matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0]) * invDet;
+        return true;
+    }
+
+    /// @brief Rounds the interval spanStart..spanEnd of row pixels to x0..x1 - 1 within startX..endX and
+    /// settles both ends with inside(x), the exact test of a single pixel
+    template <typename Inside>
+    inline void SettleSpan(float spanStart, float spanEnd, int16_t startX, int16_t endX, Inside inside, int16_t &x0, int16_t &x1)
+    {
+        // an interval that came out empty may still hold a pixel right at a limit
+        x0 = static_cast<int16_t>(std::clamp(std::ceil(spanStart), static_cast<float>(startX), static_cast<float>(endX)));
+        x1 = static_cast<int16_t>(std::clamp(std::ceil(spanEnd), static_cast<float>(x0), static_cast<float>(endX)));
+        while (x0 > startX && inside(x0 - 1))
+            --x0;
+        while (x0 < x1 && !inside(x0))
+            ++x0;
+        while (x1 < endX && inside(x1))
+            ++x1;
+        while (x1 > x0 && !inside(x1 - 1))
+            --x1;
+    }
+
+    // The first two rows of the inverse of a transformation matrix, mapping a target pixel back into
+    // the untransformed source. Along a target row both source coordinates are linear in x, so the
+    // pixels that map into a source rectangle form a single interval per row.
+    struct AffineInverse
+    {
+        float m[2][3];
+
+        /// @brief false when the matrix is not invertible
+        bool Set(const float matrix[3][3])
+        {
+            float inverse[3][3];
+            if (!InvertMatrix(matrix, inverse))
+                return false;
+            std::memcpy(m, inverse, sizeof(m));
+            return true;
+        }
+
+        inline float U(float x, float y) const { return m[0][0] * x + m[0][1] * y + m[0][2]; }
+        inline float V(float x, float y) const { return m[1][0] * x + m[1][1] * y + m[1][2]; }
+
+        /// @brief source position of the target pixel x, y, an affine mapping reaches every pixel
+        inline bool Map(float x, float y, float &u, float &v) const
+        {
+            u = U(x, y);
+            v = V(x, y);
+            return true;
+        }
+
+        /// @brief linear interpolation is exact, so every run can have the full length n
+        inline int Subspan(int, float, int n) const { return n; }
+
+        /// @brief where the source point u, v lands in the target
+        static bool Project(const float matrix[3][3], float u, float v, float &x, float &y)
+        {
+            x = matrix[0][0] * u + matrix[0][1] * v + matrix[0][2];
+            y = matrix[1][0] * u + matrix[1][1] * v + matrix[1][2];
+            return true;
+        }
+
+        /// @brief Pixels x0 to x1 - 1 of row y, between startX and endX, that map into minU..maxU and
+        /// minV..maxV. The rounded ends of the interval are settled with inside(x), the exact test of a
+        /// single pixel, which also decides whether the limits themselves are included
+        template <typename Inside>
+        void RowSpan(int16_t y, int16_t startX, int16_t endX, float minU, float maxU, float minV, float maxV,
+                     Inside inside, int16_t &x0, int16_t &x1) const
+        {
+            float spanStart = startX;
+            float spanEnd = endX;
+            Limit(m[0][1] * y + m[0][2], m[0][0], minU, maxU, spanStart, spanEnd);
+            Limit(m[1][1] * y + m[1][2], m[1][0], minV, maxV, spanStart, spanEnd);
+            SettleSpan(spanStart, spanEnd, startX, endX, inside, x0, x1);
+        }
+
+    private:
+        // narrows spanStart..spanEnd to the x for which low <= value + step * x <= high
+        static void Limit(float value, float step, float low, float high, float &spanStart, float &spanEnd)
+        {
+            if (step == 0.0f)
+            {
+                if (value < low || value > high)
+                    spanEnd = spanStart;
+                return;
+            }
+            float first = (low - value) / step;
+            float last = (high - value) / step;
+            if (step < 0)
+                std::swap(first, last);
+            spanStart = std::max(spanStart, first);
+            spanEnd = std::min(spanEnd, last);
+        }
+    };
+
+    // The full inverse of a perspective matrix. A target pixel maps to u / w, v / w where u, v and w are
+    // linear in x along a row, so the source rectangle still is a single interval of the row: every limit
+    // u >= minU * w and so on stays linear as long as w is positive, i.e. the pixel is in front of the viewer.
+    struct PerspectiveInverse
+    {
+        float m[3][3];
+
+        /// @brief false when the matrix is not invertible
+        bool Set(const float matrix[3][3])
+        {
+            return InvertMatrix(matrix, m);
+        }
+
+        /// @brief source position of the target pixel x, y, false when it lies behind the viewer
+        inline bool Map(float x, float y, float &u, float &v) const
+        {
+            float w = m[2][0] * x + m[2][1] * y + m[2][2];
+            if (w <= 0.0f)
+                return false;
+            float invW = 1.0f / w;
+            u = (m[0][0] * x + m[0][1] * y + m[0][2]) * invW;
+            v = (m[1][0] * x + m[1][1] * y + m[1][2]) * invW;
+            return true;
+        }
+
+        /// @brief The longest run of n, a power of two, or fewer pixels starting at a multiple of its length
+        /// that holds x and along which interpolating u and v linearly stays within a quarter pixel of the
+        /// exact mapping. That error grows with n * n * dw / w, so runs only get shorter where the quad is
+        /// strongly foreshortened
+        inline int Subspan(int x, float y, int n) const
+        {
+            float dw = std::abs(m[2][0]);
+            for (; n > 1; n >>= 1)
+            {
+                float w = m[2][0] * (x & ~(n - 1)) + m[2][1] * y + m[2][2];
+                if (n * n * dw <= std::min(w, w + m[2][0] * n))
+                    break;
+            }
+            return n;
+        }
+
+        /// @brief where the source point u, v lands in the target, false when it lies behind the viewer
+        static bool Project(const float matrix[3][3], float u, float v, float &x, float &y)
+        {
+            float w = matrix[2][0] * u + matrix[2][1] * v + matrix[2][2];
+            if (w <= 0.0f)
+                return false;
+            x = (matrix[0][0] * u + matrix[0][1] * v + matrix[0][2]) / w;
+            y = (matrix[1][0] * u + matrix[1][1] * v + matrix[1][2]) / w;
+            return true;
+        }
+
+        /// @brief same as AffineInverse::RowSpan
+        template <typename Inside>
+        void RowSpan(int16_t y, int16_t startX, int16_t endX, float minU, float maxU, float minV, float maxV,
+                     Inside inside, int16_t &x0, int16_t &x1) const
+        {
+            float u = m[0][1] * y + m[0][2];
+            float v = m[1][1] * y + m[1][2];
+            float w = m[2][1] * y + m[2][2];
+            float spanStart = startX;
+            float spanEnd = endX;
+            AtLeastZero(w, m[2][0], spanStart, spanEnd);
+            AtLeastZero(u - minU * w, m[0][0] - minU * m[2][0], spanStart, spanEnd);
+            AtLeastZero(maxU * w - u, maxU * m[2][0] - m[0][0], spanStart, spanEnd);
+            AtLeastZero(v - minV * w, m[1][0] - minV * m[2][0], spanStart, spanEnd);
+            AtLeastZero(maxV * w - v, maxV * m[2][0] - m[1][0], spanStart, spanEnd);
+            SettleSpan(spanStart, spanEnd, startX, endX, inside, x0, x1);
+        }
+
+    private:
+        // narrows spanStart..spanEnd to the x for which value + step * x >= 0
+        static void AtLeastZero(float value, float step, float &spanStart, float &spanEnd)
+        {
+            if (step == 0.0f)
+            {
+                if (value < 0.0f)
+                    spanEnd = spanStart;
+                return;
+            }
+            float bound = -value / step;
+            if (step > 0)
+                spanStart = std::max(spanStart, bound);
+            else
+                spanEnd = std::min(spanEnd, bound);
+        }
+    };
+}
+
+#endif // !AFFINESPAN_H
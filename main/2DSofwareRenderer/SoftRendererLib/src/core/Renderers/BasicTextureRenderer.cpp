@@ -5,6 +5,7 @@
 #include "../../data/BlendMode/BlendFunctions.h"
 #include "../../data/PixelFormat/PixelConverter.h"
 #include "../RenderContext2D.h"
+#include "../DisplayList.h"
 
 using namespace Tergos2D;
 
@@ -14,6 +15,12 @@ BasicTextureRenderer::BasicTextureRenderer(RenderContext2D &context) : RendererB
 
 void BasicTextureRenderer::DrawTexture(Texture &texture, int16_t x, int16_t y)
 {
+    if (context.IsRecording())
+    {
+        context.GetRecordingList()->RecordTexture(context, texture, x, y);
+        return;
+    }
+
     auto targetTexture = context.GetTargetTexture();
     if (!targetTexture || !texture.GetData())
         return;
@@ -45,24 +52,105 @@ void BasicTextureRenderer::DrawTexture(Texture &texture, int16_t x, int16_t y)
     clipEndX = std::min(clipEndX, (int16_t)targetWidth);
     clipEndY = std::min(clipEndY, (int16_t)targetHeight);
 
-    // Adjust clipping start positions for negative coordinates
-    if (x < 0)
-    {
-        clipStartX = std::max(clipStartX, static_cast<int16_t>(0));
-    }
-    if (y < 0)
-    {
-        clipStartY = std::max(clipStartY, static_cast<int16_t>(0));
-    }
+    // Adjust clipping start positions for negative coordinates and the origin of the target
+    int16_t originX = targetTexture->GetOriginX();
+    int16_t originY = targetTexture->GetOriginY();
+    clipStartX = std::max(clipStartX, originX);
+    clipStartY = std::max(clipStartY, originY);
 
     // Check if there is anything to draw
     if (clipStartX >= clipEndX || clipStartY >= clipEndY)
         return;
 
+    context.MarkDirty(clipStartX, clipStartY, clipEndX, clipEndY);
+
+    // from here on target positions count from the first stored pixel, source offsets stay the same
+    x -= originX;
+    y -= originY;
+    clipStartX -= originX;
+    clipEndX -= originX;
+    clipStartY -= originY;
+    clipEndY -= originY;
+
     // Determine blending mode
     BlendContext bc = context.GetBlendContext();
     bc.mode = context.BlendModeToUse(sourceInfo);
 
+    // indexed rows are expanded through the palette, copies go straight into the target row with
+    // the palette converted to the target format, blends take the ARGB8888 entries chunk wise
+    if (sourceInfo.isIndexed)
+    {
+        const uint8_t *palette = texture.GetPalette();
+        if (!palette || targetInfo.isBitFormat)
+            return;
+        sourceInfo.hasAlpha = texture.PaletteHasAlpha();
+        bc.mode = context.BlendModeToUse(sourceInfo);
+        const PixelFormatInfo &entryInfo = PixelFormatRegistry::GetInfo(PixelFormat::ARGB8888);
+        auto blendFunc = context.GetBlendFunc();
+        if (bc.mode != BlendMode::NOBLEND && !blendFunc)
+            return;
+        const auto &coloring = context.GetColoring();
+
+        // indices past the end of the palette read zero entries
+        alignas(4) uint8_t entries[256 * 4] = {};
+        uint16_t paletteSize = std::min<uint16_t>(texture.GetPaletteSize(), 1 << sourceInfo.bitsPerPixel);
+        if (bc.mode == BlendMode::NOBLEND)
+            PixelConverter::Convert(PixelFormat::ARGB8888, targetFormat, palette, entries, paletteSize);
+        else
+            MemHandler::MemCopy(entries, palette, paletteSize * 4);
+
+        const int16_t expandChunk = 64;
+        alignas(4) uint8_t expanded[expandChunk * 4];
+        for (int16_t j = clipStartY; j < clipEndY; ++j)
+        {
+            const uint8_t *sourceRow = sourceData + (j - y) * sourcePitch;
+            uint8_t *targetRow = targetData + j * targetPitch;
+            if (bc.mode == BlendMode::NOBLEND)
+            {
+                PixelConverter::ExpandIndexed(sourceFormat, sourceRow, clipStartX - x, entries, targetInfo.bytesPerPixel,
+                                              targetRow + clipStartX * targetInfo.bytesPerPixel, clipEndX - clipStartX);
+                continue;
+            }
+            for (int16_t i = clipStartX; i < clipEndX; i += expandChunk)
+            {
+                size_t count = std::min<int16_t>(expandChunk, clipEndX - i);
+                PixelConverter::ExpandIndexed(sourceFormat, sourceRow, i - x, entries, 4, expanded, count);
+                blendFunc(targetRow + i * targetInfo.bytesPerPixel, expanded, count, targetInfo, entryInfo, coloring, false, bc);
+            }
+        }
+        return;
+    }
+
+    // A4 and A1 rows can start inside a byte, they are unpacked to A8 chunk wise and drawn as A8
+    if (sourceInfo.isBitFormat)
+    {
+        const PixelFormatInfo &maskInfo = PixelFormatRegistry::GetInfo(PixelFormat::A8);
+        PixelConverter::ConvertFunc convertFunc = PixelConverter::GetConversionFunction(PixelFormat::A8, targetFormat);
+        auto blendFunc = context.GetBlendFunc();
+        if (bc.mode == BlendMode::NOBLEND ? !convertFunc : !blendFunc)
+            return;
+        const auto &coloring = context.GetColoring();
+
+        const int16_t maskChunk = 64;
+        uint8_t mask[maskChunk];
+        for (int16_t j = clipStartY; j < clipEndY; ++j)
+        {
+            const uint8_t *sourceRow = sourceData + (j - y) * sourcePitch;
+            uint8_t *targetRow = targetData + j * targetPitch;
+            for (int16_t i = clipStartX; i < clipEndX; i += maskChunk)
+            {
+                size_t count = std::min<int16_t>(maskChunk, clipEndX - i);
+                PixelConverter::UnpackAlpha(sourceFormat, sourceRow, i - x, mask, count);
+                uint8_t *target = targetRow + i * targetInfo.bytesPerPixel;
+                if (bc.mode == BlendMode::NOBLEND)
+                    convertFunc(mask, target, count);
+                else
+                    blendFunc(target, mask, count, targetInfo, maskInfo, coloring, false, bc);
+            }
+        }
+        return;
+    }
+
     switch (bc.mode)
     {
     case BlendMode::NOBLEND:
@@ -93,7 +181,40 @@ void BasicTextureRenderer::DrawTexture(Texture &texture, int16_t x, int16_t y)
         auto blendFunc = context.GetBlendFunc();
         if(!blendFunc) return;
         const auto &coloring = context.GetColoring();
-        
+
+        const TextureSpans *spans = texture.GetSpans();
+        if (spans && TextureSpans::CanSkipTransparent(bc))
+        {
+            // only partial spans are blended, opaque spans are converted when that gives the same result
+            PixelConverter::ConvertFunc convertFunc = TextureSpans::CanCopyOpaque(bc, coloring)
+                                                          ? PixelConverter::GetConversionFunction(sourceFormat, targetFormat)
+                                                          : nullptr;
+            uint16_t spanStartX = clipStartX - x;
+            uint16_t spanEndX = clipEndX - x;
+            for (uint16_t j = clipStartY; j < clipEndY; ++j)
+            {
+                size_t count;
+                const TextureSpan *span = spans->GetRow(j - y, count);
+                for (const TextureSpan *end = span + count; span != end; ++span)
+                {
+                    uint16_t start = std::max(span->start, spanStartX);
+                    uint16_t stop = std::min(span->end, spanEndX);
+                    if (start >= stop || span->type == SpanType::TRANSPARENT)
+                        continue;
+
+                    uint8_t *target = targetRow + (start - spanStartX) * targetInfo.bytesPerPixel;
+                    const uint8_t *source = sourceRow + (start - spanStartX) * sourceInfo.bytesPerPixel;
+                    if (span->type == SpanType::OPAQUE && convertFunc)
+                        convertFunc(source, target, stop - start);
+                    else
+                        blendFunc(target, source, stop - start, targetInfo, sourceInfo, coloring, false, bc);
+                }
+                targetRow += targetPitch;
+                sourceRow += sourcePitch;
+            }
+            break;
+        }
+
         for (uint16_t j = clipStartY; j < clipEndY; ++j)
         {
             blendFunc(targetRow, sourceRow, clipEndX - clipStartX, targetInfo, sourceInfo, coloring, false, bc);
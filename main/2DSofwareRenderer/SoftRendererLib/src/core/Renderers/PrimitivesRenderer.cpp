@@ -1,19 +1,137 @@
 #include "PrimitivesRenderer.h"
+#include "AffineSpan.h"
 #include <algorithm>
 #include "../util/MemHandler.h"
 #include "../data/BlendMode/BlendFunctions.h"
+#include "../data/PixelFormat/PixelConverter.h"
 
 #include "../RenderContext2D.h"
+#include "../DisplayList.h"
 #include <float.h>
 #include <math.h>
 
 using namespace Tergos2D;
 
+// Shapes are written as solid spans and, for anti-aliased edges, as A8 coverage runs. A coverage run
+// is blended with one blend function call using the draw colour as tint, which the mask kernels of
+// the 16 and 24 bit targets handle directly
+struct PrimitivesRenderer::SpanTarget
+{
+    // data holds the pixel at originX, originY
+    uint8_t *data;
+    uint32_t pitch;
+    int16_t originX, originY;
+    PixelFormatInfo info;
+    int16_t clipStartX, clipStartY, clipEndX, clipEndY;
+    BlendFunc blendFunc;
+
+    // solid spans, copied for opaque colours like DrawRect does
+    Color color;
+    uint8_t pixelData[MAXBYTESPERPIXEL];
+    BlendContext fillBc;
+    Coloring fillColoring;
+
+    Coloring coverageColoring;
+    BlendContext coverageBc;
+    bool coverageVisible;
+
+    // pixels x0 to x1 - 1, clipped
+    void Fill(int y, int x0, int x1)
+    {
+        if (y < clipStartY || y >= clipEndY)
+            return;
+        x0 = std::max<int>(x0, clipStartX);
+        x1 = std::min<int>(x1, clipEndX);
+        if (x0 >= x1)
+            return;
+        uint8_t *dest = data + (y - originY) * pitch + (x0 - originX) * info.bytesPerPixel;
+        if (fillBc.mode == BlendMode::NOBLEND)
+            PixelConverter::Fill(dest, pixelData, x1 - x0, info.bytesPerPixel);
+        else
+            blendFunc(dest, color.data, x1 - x0, info, PixelFormatRegistry::GetInfo(PixelFormat::ARGB8888), fillColoring, true, fillBc);
+    }
+
+    // clipped per pixel, so runs drawn under different clipping areas line up
+    void Blend(int x, int y, const uint8_t *coverage, int count)
+    {
+        if (!coverageVisible || y < clipStartY || y >= clipEndY)
+            return;
+        int start = std::max<int>(x, clipStartX);
+        int end = std::min<int>(x + count, clipEndX);
+        if (start >= end)
+            return;
+        blendFunc(data + (y - originY) * pitch + (start - originX) * info.bytesPerPixel, coverage + (start - x), end - start, info,
+                  PixelFormatRegistry::GetInfo(PixelFormat::A8), coverageColoring, false, coverageBc);
+    }
+};
+
 PrimitivesRenderer::PrimitivesRenderer(RenderContext2D &context) : RendererBase(context)
 {
 }
+
+bool PrimitivesRenderer::BeginSpans(Color color, SpanTarget &target)
+{
+    auto targetTexture = context.GetTargetTexture();
+    target.blendFunc = context.GetBlendFunc();
+    if (!targetTexture || !target.blendFunc)
+        return false;
+
+    target.data = targetTexture->GetData();
+    target.pitch = targetTexture->GetPitch();
+    target.originX = targetTexture->GetOriginX();
+    target.originY = targetTexture->GetOriginY();
+    target.info = PixelFormatRegistry::GetInfo(targetTexture->GetFormat());
+    if (target.info.isBitFormat || target.info.isIndexed)
+        return false;
+
+    target.clipStartX = target.originX;
+    target.clipStartY = target.originY;
+    target.clipEndX = targetTexture->GetWidth();
+    target.clipEndY = targetTexture->GetHeight();
+    if (context.IsClippingEnabled())
+    {
+        auto clippingArea = context.GetClippingArea();
+        target.clipStartX = std::max(target.clipStartX, clippingArea.startX);
+        target.clipStartY = std::max(target.clipStartY, clippingArea.startY);
+        target.clipEndX = std::min(target.clipEndX, clippingArea.endX);
+        target.clipEndY = std::min(target.clipEndY, clippingArea.endY);
+    }
+
+    target.color = color;
+    color.ConvertTo(targetTexture->GetFormat(), target.pixelData);
+    target.fillColoring = context.GetColoring();
+    target.fillBc = context.GetBlendContext();
+    if (color.GetAlpha() == 255)
+        target.fillBc.mode = BlendMode::NOBLEND;
+
+    // the colour becomes the tint of the coverage, an enabled tint is applied to it first the way
+    // the blend kernels apply it to a solid source colour
+    Color tinted = color;
+    const Coloring &coloring = context.GetColoring();
+    if (coloring.colorEnabled && coloring.color.data[0] != 0)
+    {
+        for (int i = 0; i < 4; ++i)
+            tinted.data[i] = (color.data[i] * coloring.color.data[i]) >> 8;
+    }
+    // a tint with alpha 0 counts as disabled, the runs would come out white
+    target.coverageVisible = tinted.data[0] != 0;
+    target.coverageColoring.colorEnabled = true;
+    target.coverageColoring.color = tinted;
+
+    // partly covered pixels always blend, also for opaque colours and coloring only
+    target.coverageBc = context.GetBlendContext();
+    target.coverageBc.mode = BlendMode::BLEND;
+    return true;
+}
+
 void PrimitivesRenderer::DrawRect(Color color, int16_t x, int16_t y, uint16_t length, uint16_t height)
 {
+    if (context.IsRecording())
+    {
+        context.GetRecordingList()->RecordRect(context, color, x, y, length, height);
+        return;
+    }
+
     auto targetTexture = context.GetTargetTexture();
     if (!targetTexture)
         return;
@@ -28,11 +146,15 @@ void PrimitivesRenderer::DrawRect(Color color, int16_t x, int16_t y, uint16_t le
 
     if (x < 0)
     {
+        if (length <= -x)
+            return;
         length = length + x;
         x = 0;
     }
     if (y < 0)
     {
+        if (height <= -y)
+            return;
         height = height + y;
         y = 0;
     }
@@ -45,6 +167,10 @@ void PrimitivesRenderer::DrawRect(Color color, int16_t x, int16_t y, uint16_t le
     uint16_t clipEndY = context.IsClippingEnabled() ? std::min(static_cast<int>(y + height), static_cast<int>(clippingArea.endY)) : y + height;
 
     // Restrict drawing within the texture bounds
+    uint16_t originX = targetTexture->GetOriginX();
+    uint16_t originY = targetTexture->GetOriginY();
+    clipStartX = std::max(clipStartX, originX);
+    clipStartY = std::max(clipStartY, originY);
     clipEndX = std::min(clipEndX, textureWidth);
     clipEndY = std::min(clipEndY, textureHeight);
 
@@ -52,6 +178,8 @@ void PrimitivesRenderer::DrawRect(Color color, int16_t x, int16_t y, uint16_t le
     if (clipStartX >= clipEndX || clipStartY >= clipEndY)
         return;
 
+    context.MarkDirty(clipStartX, clipStartY, clipEndX, clipEndY);
+
     // Calculate the number of bytes in a row
     size_t bytesPerRow = (clipEndX - clipStartX) * info.bytesPerPixel;
 
@@ -59,7 +187,7 @@ void PrimitivesRenderer::DrawRect(Color color, int16_t x, int16_t y, uint16_t le
 
     if (color.GetAlpha() == 255)
         bc.mode = BlendMode::NOBLEND;
-    uint8_t *dest = textureData + (clipStartY * pitch) + (clipStartX * info.bytesPerPixel);
+    uint8_t *dest = textureData + ((clipStartY - originY) * pitch) + ((clipStartX - originX) * info.bytesPerPixel);
 
     uint8_t pixelData[MAXBYTESPERPIXEL];
     uint8_t rowPixelData[MAXROWLENGTH * MAXBYTESPERPIXEL];
@@ -74,10 +202,7 @@ void PrimitivesRenderer::DrawRect(Color color, int16_t x, int16_t y, uint16_t le
         uint8_t singlePixelData[MAXBYTESPERPIXEL];
         MemHandler::MemCopy(singlePixelData, pixelData, info.bytesPerPixel);
 
-        for (size_t byteIndex = 0; byteIndex < bytesPerRow; byteIndex += info.bytesPerPixel)
-        {
-            MemHandler::MemCopy(rowPixelData + byteIndex, singlePixelData, info.bytesPerPixel);
-        }
+        PixelConverter::Fill(rowPixelData, singlePixelData, clipEndX - clipStartX, info.bytesPerPixel);
 
         for (uint16_t j = clipStartY; j < clipEndY; ++j)
         {
@@ -89,8 +214,8 @@ void PrimitivesRenderer::DrawRect(Color color, int16_t x, int16_t y, uint16_t le
     }
     default:
     {
-        //Prepare data set
-        for (size_t byteIndex = 0; byteIndex < bytesPerRow; byteIndex += 4)
+        //Prepare data set, the blend source is always ARGB8888
+        for (size_t byteIndex = 0; byteIndex < (size_t)(clipEndX - clipStartX) * 4; byteIndex += 4)
         {
             MemHandler::MemCopy(rowPixelData + byteIndex, color.data, 4);
         }
@@ -100,7 +225,7 @@ void PrimitivesRenderer::DrawRect(Color color, int16_t x, int16_t y, uint16_t le
             uint8_t *rowDest = dest + (j - clipStartY) * pitch;
             size_t rowLength = (clipEndX - clipStartX); // Number of pixels per row
             PixelFormatInfo infosrcColor = PixelFormatRegistry::GetInfo(PixelFormat::ARGB8888);
-            context.GetBlendFunc()(rowDest, rowPixelData, rowLength, info, infosrcColor, context.GetColoring(),true,context.GetBlendContext());
+            context.GetBlendFunc()(rowDest, rowPixelData, rowLength, info, infosrcColor, context.GetColoring(),true,bc);
         }
         break;
     }
@@ -109,101 +234,27 @@ void PrimitivesRenderer::DrawRect(Color color, int16_t x, int16_t y, uint16_t le
 
 void PrimitivesRenderer::DrawLine(Color color, int16_t x0, int16_t y0, int16_t x1, int16_t y1)
 {
+    if (context.IsRecording())
+    {
+        context.GetRecordingList()->RecordLine(context, color, x0, y0, x1, y1);
+        return;
+    }
+
     auto targetTexture = context.GetTargetTexture();
     if (!targetTexture)
         return;
 
+    // both end points are drawn like on the Bresenham path, a zero length line is a single pixel
     if (x0 == x1)
     {
-        DrawRect(color, x0, y0, 1, y1 - y0);
+        DrawRect(color, x0, std::min(y0, y1), 1, std::abs(y1 - y0) + 1);
         return;
     }
     if (y0 == y1)
     {
-        DrawRect(color, x0, y0, x1 - x0, 1);
+        DrawRect(color, std::min(x0, x1), y0, std::abs(x1 - x0) + 1, 1);
         return;
     }
-    auto clippingArea = context.GetClippingArea();
-
-    // Clip the line to the clipping area
-    if (context.IsClippingEnabled())
-    {
-        // Cohen-Sutherland clipping algorithm
-        auto clipCode = [](int16_t x, int16_t y, const ClippingArea &clip)
-        {
-            int code = 0;
-            if (x < clip.startX)
-                code |= 1;
-            if (x > clip.endX)
-                code |= 2;
-            if (y < clip.startY)
-                code |= 4;
-            if (y > clip.endY)
-                code |= 8;
-            return code;
-        };
-
-        int code0 = clipCode(x0, y0, clippingArea);
-        int code1 = clipCode(x1, y1, clippingArea);
-        bool accept = false;
-
-        while (true)
-        {
-            if (!(code0 | code1))
-            {
-                accept = true;
-                break;
-            }
-            else if (code0 & code1)
-            {
-                return;
-            }
-            else
-            {
-                int codeOut = code0 ? code0 : code1;
-                int16_t x, y;
-
-                if (codeOut & 8)
-                {
-                    x = x0 + (x1 - x0) * (clippingArea.endY - y0) / (y1 - y0);
-                    y = clippingArea.endY;
-                }
-                else if (codeOut & 4)
-                {
-                    x = x0 + (x1 - x0) * (clippingArea.startY - y0) / (y1 - y0);
-                    y = clippingArea.startY;
-                }
-                else if (codeOut & 2)
-                {
-                    y = y0 + (y1 - y0) * (clippingArea.endX - x0) / (x1 - x0);
-                    x = clippingArea.endX;
-                }
-                else
-                {
-                    y = y0 + (y1 - y0) * (clippingArea.startX - x0) / (x1 - x0);
-                    x = clippingArea.startX;
-                }
-
-                if (codeOut == code0)
-                {
-                    x0 = x;
-                    y0 = y;
-                    code0 = clipCode(x0, y0, clippingArea);
-                }
-                else
-                {
-                    x1 = x;
-                    y1 = y;
-                    code1 = clipCode(x1, y1, clippingArea);
-                }
-            }
-        }
-
-        if (!accept)
-        {
-            return;
-        }
-    }
 
     PixelFormat format = targetTexture->GetFormat();
     PixelFormatInfo info = PixelFormatRegistry::GetInfo(format);
@@ -213,6 +264,40 @@ void PrimitivesRenderer::DrawLine(Color color, int16_t x0, int16_t y0, int16_t x
     uint16_t textureHeight = targetTexture->GetHeight();
     uint32_t pitch = targetTexture->GetPitch();
 
+    // Clip per pixel instead of moving the end points, so a clipped line covers exactly
+    // the pixels of the unclipped one and tiles drawn with different clipping areas line up
+    int16_t originX = targetTexture->GetOriginX();
+    int16_t originY = targetTexture->GetOriginY();
+    int16_t clipStartX = originX;
+    int16_t clipStartY = originY;
+    int16_t clipEndX = textureWidth;
+    int16_t clipEndY = textureHeight;
+    if (context.IsClippingEnabled())
+    {
+        auto clippingArea = context.GetClippingArea();
+        clipStartX = std::max(clipStartX, clippingArea.startX);
+        clipStartY = std::max(clipStartY, clippingArea.startY);
+        clipEndX = std::min(clipEndX, clippingArea.endX);
+        clipEndY = std::min(clipEndY, clippingArea.endY);
+    }
+
+    int16_t boundsStartX = std::max(std::min(x0, x1), clipStartX);
+    int16_t boundsStartY = std::max(std::min(y0, y1), clipStartY);
+    int16_t boundsEndX = std::min(static_cast<int16_t>(std::max(x0, x1) + 1), clipEndX);
+    int16_t boundsEndY = std::min(static_cast<int16_t>(std::max(y0, y1) + 1), clipEndY);
+    if (boundsStartX >= boundsEndX || boundsStartY >= boundsEndY)
+        return;
+
+    context.MarkDirty(boundsStartX, boundsStartY, boundsEndX, boundsEndY);
+
+    if (context.IsAntialiasingEnabled())
+    {
+        SpanTarget target;
+        if (BeginSpans(color, target))
+            DrawLineAntialiased(target, x0, y0, x1, y1);
+        return;
+    }
+
     int16_t dx = std::abs(x1 - x0);
     int16_t dy = std::abs(y1 - y0);
     int16_t sx = (x0 < x1) ? 1 : -1;
@@ -227,16 +312,16 @@ void PrimitivesRenderer::DrawLine(Color color, int16_t x0, int16_t y0, int16_t x
 
     while (true)
     {
-        if (x0 >= 0 && x0 < textureWidth && y0 >= 0 && y0 < textureHeight)
+        if (x0 >= clipStartX && x0 < clipEndX && y0 >= clipStartY && y0 < clipEndY)
         {
-            uint8_t *targetPixel = textureData + (y0 * pitch) + (x0 * info.bytesPerPixel);
+            uint8_t *targetPixel = textureData + ((y0 - originY) * pitch) + ((x0 - originX) * info.bytesPerPixel);
             switch (bc.mode)
             {
             case BlendMode::NOBLEND:
                 MemHandler::MemCopy(targetPixel, pixelData, info.bytesPerPixel);
                 break;
             default:
-                context.GetBlendFunc()(targetPixel, pixelData, 1, info, PixelFormatRegistry::GetInfo(PixelFormat::ARGB8888), context.GetColoring(),false,context.GetBlendContext());
+                context.GetBlendFunc()(targetPixel, color.data, 1, info, PixelFormatRegistry::GetInfo(PixelFormat::ARGB8888), context.GetColoring(),false,bc);
                 break;
             }
         }
@@ -261,6 +346,12 @@ void PrimitivesRenderer::DrawLine(Color color, int16_t x0, int16_t y0, int16_t x
 
 void PrimitivesRenderer::DrawTransformedRect(Color color, uint16_t length, uint16_t height, const float transformationMatrix[3][3])
 {
+    if (context.IsRecording())
+    {
+        context.GetRecordingList()->RecordTransformedRect(context, color, length, height, transformationMatrix);
+        return;
+    }
+
     auto targetTexture = context.GetTargetTexture();
     if (!targetTexture)
         return;
@@ -309,77 +400,142 @@ void PrimitivesRenderer::DrawTransformedRect(Color color, uint16_t length, uint1
         return;
     }
 
-
-
-    PixelFormat format = targetTexture->GetFormat();
-    PixelFormatInfo info = PixelFormatRegistry::GetInfo(format);
-
-    uint8_t *textureData = targetTexture->GetData();
-    uint16_t textureWidth = targetTexture->GetWidth();
-    uint16_t textureHeight = targetTexture->GetHeight();
-    uint32_t pitch = targetTexture->GetPitch();
-
+    SpanTarget target;
+    if (!BeginSpans(color, target))
+        return;
 
     // Calculate the bounding box of the transformed rectangle
     float minX = std::numeric_limits<float>::max();
     float minY = std::numeric_limits<float>::max();
-    float maxX = std::numeric_limits<float>::min();
-    float maxY = std::numeric_limits<float>::min();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
 
-    std::vector<std::pair<float, float>> corners = {
+    const float corners[4][2] = {
         {0, 0},
         {static_cast<float>(length), 0},
         {0, static_cast<float>(height)},
         {static_cast<float>(length), static_cast<float>(height)}
     };
 
-    for (const auto& corner : corners)
+    for (const auto &corner : corners)
+    {
+        float x = transformationMatrix[0][0] * corner[0] + transformationMatrix[0][1] * corner[1] + transformationMatrix[0][2];
+        float y = transformationMatrix[1][0] * corner[0] + transformationMatrix[1][1] * corner[1] + transformationMatrix[1][2];
+
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+
+    // Clamp the bounding box to the clipped target
+    int16_t startX = static_cast<int16_t>(std::max(std::floor(minX), static_cast<float>(target.clipStartX)));
+    int16_t startY = static_cast<int16_t>(std::max(std::floor(minY), static_cast<float>(target.clipStartY)));
+    int16_t endX = static_cast<int16_t>(std::min(std::ceil(maxX), static_cast<float>(target.clipEndX)));
+    int16_t endY = static_cast<int16_t>(std::min(std::ceil(maxY), static_cast<float>(target.clipEndY)));
+    if (startX >= endX || startY >= endY)
+        return;
+
+    context.MarkDirty(startX, startY, endX, endY);
+
+    AffineInverse inverse;
+    if (!inverse.Set(transformationMatrix))
+        return; // Transformation matrix is not invertible
+
+    // a pixel is drawn when its corner maps into the untransformed rectangle, every row is a single solid span
+    for (int16_t y = startY; y < endY; ++y)
+    {
+        auto inside = [&](int16_t x)
+        {
+            float srcX = inverse.U(x, y);
+            float srcY = inverse.V(x, y);
+            return srcX >= 0 && srcX < length && srcY >= 0 && srcY < height;
+        };
+        int16_t x0, x1;
+        inverse.RowSpan(y, startX, endX, 0, length, 0, height, inside, x0, x1);
+        target.Fill(y, x0, x1);
+    }
+}
+void PrimitivesRenderer::FillPolygon(Color color, const PolygonPoint *points, uint16_t count, FillRule rule)
+{
+    if (context.IsRecording())
     {
-        float x = transformationMatrix[0][0] * corner.first + transformationMatrix[0][1] * corner.second + transformationMatrix[0][2];
-        float y = transformationMatrix[1][0] * corner.first + transformationMatrix[1][1] * corner.second + transformationMatrix[1][2];
+        context.GetRecordingList()->RecordPolygon(context, color, points, count, rule);
+        return;
+    }
 
-        if (x < minX) minX = x;
-        if (y < minY) minY = y;
-        if (x > maxX) maxX = x;
-        if (y > maxY) maxY = y;
+    auto targetTexture = context.GetTargetTexture();
+    if (!targetTexture || points == nullptr || count < 3)
+        return;
+
+    if (context.IsAntialiasingEnabled())
+    {
+        SpanTarget target;
+        if (BeginSpans(color, target))
+            FillPolygonAntialiased(target, points, count, rule);
+        return;
     }
 
-    // Clamp the bounding box to the target texture's dimensions
-    int16_t startX = std::max(static_cast<int16_t>(std::floor(minX)), static_cast<int16_t>(0));
-    int16_t startY = std::max(static_cast<int16_t>(std::floor(minY)), static_cast<int16_t>(0));
-    int16_t endX = std::min(static_cast<int16_t>(std::ceil(maxX)), static_cast<int16_t>(textureWidth));
-    int16_t endY = std::min(static_cast<int16_t>(std::ceil(maxY)), static_cast<int16_t>(textureHeight));
+    PixelFormat format = targetTexture->GetFormat();
+    PixelFormatInfo info = PixelFormatRegistry::GetInfo(format);
 
+    uint8_t *textureData = targetTexture->GetData();
+    uint32_t pitch = targetTexture->GetPitch();
+
+    int16_t originX = targetTexture->GetOriginX();
+    int16_t originY = targetTexture->GetOriginY();
+    int16_t clipStartX = originX;
+    int16_t clipStartY = originY;
+    int16_t clipEndX = targetTexture->GetWidth();
+    int16_t clipEndY = targetTexture->GetHeight();
     if (context.IsClippingEnabled())
     {
         auto clippingArea = context.GetClippingArea();
-        startX = std::max(startX, static_cast<int16_t>(clippingArea.startX));
-        startY = std::max(startY, static_cast<int16_t>(clippingArea.startY));
-        endX = std::min(endX, static_cast<int16_t>(clippingArea.endX));
-        endY = std::min(endY, static_cast<int16_t>(clippingArea.endY));
+        clipStartX = std::max(clipStartX, clippingArea.startX);
+        clipStartY = std::max(clipStartY, clippingArea.startY);
+        clipEndX = std::min(clipEndX, clippingArea.endX);
+        clipEndY = std::min(clipEndY, clippingArea.endY);
     }
 
-    // Define the inverse transformation matrix
-    float invMatrix[3][3];
-    float det = transformationMatrix[0][0] * (transformationMatrix[1][1] * transformationMatrix[2][2] - transformationMatrix[1][2] * transformationMatrix[2][1]) -
-                transformationMatrix[0][1] * (transformationMatrix[1][0] * transformationMatrix[2][2] - transformationMatrix[1][2] * transformationMatrix[2][0]) +
-                transformationMatrix[0][2] * (transformationMatrix[1][0] * transformationMatrix[2][1] - transformationMatrix[1][1] * transformationMatrix[2][0]);
+    // edge table, a scanline y samples the pixel centres at y + 0.5 so an edge from a.y to b.y
+    // covers the scanlines ceil(a.y - 0.5) to ceil(b.y - 0.5) - 1, horizontal edges cover none
+    edges.clear();
+    float minX = points[0].x, maxX = points[0].x;
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        PolygonPoint a = points[i];
+        PolygonPoint b = points[i + 1 < count ? i + 1 : 0];
+        minX = std::min(minX, a.x);
+        maxX = std::max(maxX, a.x);
 
-    if (det == 0.0f)
-        return; // Transformation matrix is not invertible
+        int8_t winding = 1;
+        if (a.y > b.y)
+        {
+            std::swap(a, b);
+            winding = -1;
+        }
+        float firstY = std::max(std::ceil(a.y - 0.5f), static_cast<float>(clipStartY));
+        float endY = std::min(std::ceil(b.y - 0.5f), static_cast<float>(clipEndY));
+        if (firstY >= endY)
+            continue;
 
-    float invDet = 1.0f / det;
+        float slope = (b.x - a.x) / (b.y - a.y);
+        edges.push_back({a.x, a.y, b.y, slope, 0, static_cast<int16_t>(firstY), static_cast<int16_t>(endY), winding});
+    }
+    if (edges.empty())
+        return;
+    std::sort(edges.begin(), edges.end(), [](const PolygonEdge &a, const PolygonEdge &b) { return a.firstY < b.firstY; });
+
+    int16_t startY = edges.front().firstY;
+    int16_t endY = startY;
+    for (const PolygonEdge &edge : edges)
+        endY = std::max(endY, edge.endY);
+    int16_t startX = static_cast<int16_t>(std::max(std::floor(minX), static_cast<float>(clipStartX)));
+    int16_t endX = static_cast<int16_t>(std::min(std::ceil(maxX), static_cast<float>(clipEndX)));
+    if (startX >= endX)
+        return;
 
-    // Calculate the inverse matrix
-    invMatrix[0][0] = (transformationMatrix[1][1] * transformationMatrix[2][2] - transformationMatrix[1][2] * transformationMatrix[2][1]) * invDet;
-    invMatrix[0][1] = (transformationMatrix[0][2] * transformationMatrix[2][1] - transformationMatrix[0][1] * transformationMatrix[2][2]) * invDet;
-    invMatrix[0][2] = (transformationMatrix[0][1] * transformationMatrix[1][2] - transformationMatrix[0][2] * transformationMatrix[1][1]) * invDet;
-    invMatrix[1][0] = (transformationMatrix[1][2] * transformationMatrix[2][0] - transformationMatrix[1][0] * transformationMatrix[2][2]) * invDet;
-    invMatrix[1][1] = (transformationMatrix[0][0] * transformationMatrix[2][2] - transformationMatrix[0][2] * transformationMatrix[2][0]) * invDet;
-    invMatrix[1][2] = (transformationMatrix[0][2] * transformationMatrix[1][0] - transformationMatrix[0][0] * transformationMatrix[1][2]) * invDet;
-    invMatrix[2][0] = (transformationMatrix[1][0] * transformationMatrix[2][1] - transformationMatrix[1][1] * transformationMatrix[2][0]) * invDet;
-    invMatrix[2][1] = (transformationMatrix[0][1] * transformationMatrix[2][0] - transformationMatrix[0][0] * transformationMatrix[2][1]) * invDet;
-    invMatrix[2][2] = (transformationMatrix[0][0] * transformationMatrix[1][1] - transformationMatrix[0][1] * transformationMatrix[1][0]) * invDet;
+    context.MarkDirty(startX, startY, endX, endY);
 
     BlendContext bc = context.GetBlendContext();
     if (color.GetAlpha() == 255)
@@ -387,31 +543,700 @@ void PrimitivesRenderer::DrawTransformedRect(Color color, uint16_t length, uint1
 
     uint8_t pixelData[MAXBYTESPERPIXEL];
     color.ConvertTo(format, pixelData);
+    const PixelFormatInfo &colorInfo = PixelFormatRegistry::GetInfo(PixelFormat::ARGB8888);
+    auto blendFunc = context.GetBlendFunc();
+    if (bc.mode != BlendMode::NOBLEND && !blendFunc)
+        return;
+
+    // the pixels with their centre between left and right, each span is written once so translucent fills blend once
+    auto fillSpan = [&](int16_t y, float left, float right)
+    {
+        int16_t x0 = static_cast<int16_t>(std::max(std::ceil(left - 0.5f), static_cast<float>(startX)));
+        int16_t x1 = static_cast<int16_t>(std::min(std::ceil(right - 0.5f), static_cast<float>(endX)));
+        if (x0 >= x1)
+            return;
+        uint8_t *dest = textureData + (y - originY) * pitch + (x0 - originX) * info.bytesPerPixel;
+        if (bc.mode == BlendMode::NOBLEND)
+            PixelConverter::Fill(dest, pixelData, x1 - x0, info.bytesPerPixel);
+        else
+            blendFunc(dest, color.data, x1 - x0, info, colorInfo, context.GetColoring(), true, bc);
+    };
+
+    activeEdges.clear();
+    size_t nextEdge = 0;
+    for (int16_t y = startY; y < endY; ++y)
+    {
+        activeEdges.erase(std::remove_if(activeEdges.begin(), activeEdges.end(), [y](const PolygonEdge &edge) { return edge.endY <= y; }),
+                          activeEdges.end());
+        while (nextEdge < edges.size() && edges[nextEdge].firstY == y)
+            activeEdges.push_back(edges[nextEdge++]);
+        // computed from the end point instead of stepped, so tiles starting at different scanlines agree
+        for (PolygonEdge &edge : activeEdges)
+            edge.x = edge.topX + (y + 0.5f - edge.topY) * edge.slope;
+
+        // insertion sort, the order only changes where edges cross
+        for (size_t i = 1; i < activeEdges.size(); ++i)
+        {
+            PolygonEdge edge = activeEdges[i];
+            size_t j = i;
+            for (; j > 0 && activeEdges[j - 1].x > edge.x; --j)
+                activeEdges[j] = activeEdges[j - 1];
+            activeEdges[j] = edge;
+        }
+
+        int winding = 0;
+        float spanStart = 0;
+        for (const PolygonEdge &edge : activeEdges)
+        {
+            bool wasInside = rule == FillRule::EVENODD ? (winding & 1) : winding != 0;
+            winding += rule == FillRule::EVENODD ? 1 : edge.winding;
+            bool inside = rule == FillRule::EVENODD ? (winding & 1) : winding != 0;
+            if (inside && !wasInside)
+                spanStart = edge.x;
+            else if (!inside && wasInside)
+                fillSpan(y, spanStart, edge.x);
+        }
+    }
+}
+
+void PrimitivesRenderer::DrawLineAntialiased(SpanTarget &target, int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+    // Wu lines, every step along the major axis splits one pixel of coverage between the two pixels
+    // the line passes between. The position is computed from the start point on every step, not
+    // accumulated, so clipped parts match the unclipped line
+    if (std::abs(y1 - y0) > std::abs(x1 - x0))
+    {
+        if (y0 > y1)
+        {
+            std::swap(x0, x1);
+            std::swap(y0, y1);
+        }
+        // a steep line covers two neighbouring pixels per scanline, one run each
+        float gradient = static_cast<float>(x1 - x0) / (y1 - y0);
+        int16_t startY = std::max(y0, target.clipStartY);
+        int16_t endY = std::min(static_cast<int16_t>(y1 + 1), target.clipEndY);
+        for (int16_t y = startY; y < endY; ++y)
+        {
+            float x = x0 + (y - y0) * gradient;
+            float left = std::floor(x);
+            uint8_t coverage = static_cast<uint8_t>((x - left) * 255.0f + 0.5f);
+            uint8_t run[2] = {static_cast<uint8_t>(255 - coverage), coverage};
+            target.Blend(static_cast<int16_t>(left), y, run, 2);
+        }
+        return;
+    }
+
+    if (x0 > x1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    // a flat line covers the scanlines row and row + 1 at each column, their coverage is collected in
+    // two runs and a run is blended once the line has left its scanline or the run is full
+    const int16_t runLength = 64;
+    uint8_t runBuffers[2][runLength];
+    uint8_t *upper = runBuffers[0];
+    uint8_t *lower = runBuffers[1];
+    int16_t upperX = 0, lowerX = 0, upperCount = 0, lowerCount = 0;
+    int16_t row = 0;
+
+    float gradient = static_cast<float>(y1 - y0) / (x1 - x0);
+    int16_t startX = std::max(x0, target.clipStartX);
+    int16_t endX = std::min(static_cast<int16_t>(x1 + 1), target.clipEndX);
+    for (int16_t x = startX; x < endX; ++x)
+    {
+        float y = y0 + (x - x0) * gradient;
+        float top = std::floor(y);
+        int16_t pixelRow = static_cast<int16_t>(top);
+        uint8_t coverage = static_cast<uint8_t>((y - top) * 255.0f + 0.5f);
+
+        if (x == startX)
+        {
+            row = pixelRow;
+            upperX = lowerX = x;
+        }
+        else if (pixelRow == row + 1)
+        {
+            // the upper scanline is done, the lower one becomes the upper one
+            target.Blend(upperX, row, upper, upperCount);
+            std::swap(upper, lower);
+            upperX = lowerX;
+            upperCount = lowerCount;
+            lowerX = x;
+            lowerCount = 0;
+            row = pixelRow;
+        }
+        else if (pixelRow == row - 1)
+        {
+            target.Blend(lowerX, row + 1, lower, lowerCount);
+            std::swap(upper, lower);
+            lowerX = upperX;
+            lowerCount = upperCount;
+            upperX = x;
+            upperCount = 0;
+            row = pixelRow;
+        }
+
+        if (upperCount == runLength)
+        {
+            target.Blend(upperX, row, upper, upperCount);
+            upperX = x;
+            upperCount = 0;
+        }
+        if (lowerCount == runLength)
+        {
+            target.Blend(lowerX, row + 1, lower, lowerCount);
+            lowerX = x;
+            lowerCount = 0;
+        }
+        upper[upperCount++] = 255 - coverage;
+        lower[lowerCount++] = coverage;
+    }
+    target.Blend(upperX, row, upper, upperCount);
+    target.Blend(lowerX, row + 1, lower, lowerCount);
+}
+
+// signed coverage in 16.16 fixed point, integer sums don't depend on the order edges are added in
+static inline int32_t ToFixedCoverage(float coverage)
+{
+    return static_cast<int32_t>(std::floor(coverage * 65536.0f + 0.5f));
+}
+
+// Adds one edge segment inside a scanline to the cells of the pixels cellStart to cellEnd - 1, xa at
+// the top and xb at the bottom of the segment, height is its height times the edge winding. The cells
+// summed from the left up to a pixel give height times the part of that pixel right of the segment.
+// Each sum only depends on the segment and the pixel, so clipped scanlines keep the same values and
+// the parts left of the first cell add up in it
+static void AccumulateCoverage(int32_t *cells, int16_t cellStart, int16_t cellEnd, float xa, float xb, float height,
+                               int16_t &touchedStart, int16_t &touchedEnd)
+{
+    float x0 = std::min(xa, xb);
+    float x1 = std::max(xa, xb);
+    float x0Floor = std::floor(x0);
+    int32_t first = static_cast<int32_t>(x0Floor);
+    int32_t last = static_cast<int32_t>(std::ceil(x1));
+    if (first >= cellEnd)
+        return;
+
+    int32_t full = ToFixedCoverage(height);
+    // relative to the first pixel, keeps the precision for segments far from the origin
+    float u0 = x0 - x0Floor;
+    float u1 = x1 - x0Floor;
+    auto coveredUpTo = [&](int32_t pixel) -> int32_t
+    {
+        if (pixel < first)
+            return 0;
+        if (pixel >= last)
+            return full;
+        float right = static_cast<float>(pixel + 1 - first);
+        if (u1 - u0 < 1e-4f)
+            return ToFixedCoverage(height * std::clamp(right - 0.5f * (u0 + u1), 0.0f, 1.0f));
+        // integral of the covered part of the pixel over the segment, divided by its width
+        auto integral = [right](float u)
+        {
+            if (u >= right)
+                return 0.0f;
+            if (u >= right - 1.0f)
+                return 0.5f * (right - u) * (right - u);
+            return right - u - 0.5f;
+        };
+        return ToFixedCoverage(height * (integral(u0) - integral(u1)) / (u1 - u0));
+    };
+
+    int32_t start = std::max<int32_t>(first, cellStart);
+    int32_t end = std::min<int32_t>(last, cellEnd - 1);
+    // the first cell takes everything left of it as well
+    int32_t previous = 0;
+    for (int32_t pixel = start; pixel <= end; ++pixel)
+    {
+        int32_t covered = coveredUpTo(pixel);
+        cells[pixel - cellStart] += covered - previous;
+        previous = covered;
+    }
+    if (start > end)
+    {
+        // completely left of the cells
+        cells[0] += full;
+        end = start;
+    }
+    touchedStart = std::min<int16_t>(touchedStart, static_cast<int16_t>(start - cellStart));
+    touchedEnd = std::max<int16_t>(touchedEnd, static_cast<int16_t>(end - cellStart));
+}
+
+void PrimitivesRenderer::FillPolygonAntialiased(SpanTarget &target, const PolygonPoint *points, uint16_t count, FillRule rule)
+{
+    // every pixel the outline passes through is partly covered, so the scanlines run from floor to
+    // ceil of the outline, an edge covers the scanlines its y range overlaps
+    edges.clear();
+    float minX = points[0].x, maxX = points[0].x;
+    float minY = points[0].y, maxY = points[0].y;
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        PolygonPoint a = points[i];
+        PolygonPoint b = points[i + 1 < count ? i + 1 : 0];
+        minX = std::min(minX, a.x);
+        maxX = std::max(maxX, a.x);
+        minY = std::min(minY, a.y);
+        maxY = std::max(maxY, a.y);
+
+        int8_t winding = 1;
+        if (a.y > b.y)
+        {
+            std::swap(a, b);
+            winding = -1;
+        }
+        float firstY = std::max(std::floor(a.y), static_cast<float>(target.clipStartY));
+        float endY = std::min(std::ceil(b.y), static_cast<float>(target.clipEndY));
+        if (a.y == b.y || firstY >= endY)
+            continue;
+
+        float slope = (b.x - a.x) / (b.y - a.y);
+        edges.push_back({a.x, a.y, b.y, slope, 0, static_cast<int16_t>(firstY), static_cast<int16_t>(endY), winding});
+    }
+    if (edges.empty())
+        return;
+    std::sort(edges.begin(), edges.end(), [](const PolygonEdge &a, const PolygonEdge &b) { return a.firstY < b.firstY; });
 
-    // Iterate over the bounding box in the target texture
+    int16_t startX = static_cast<int16_t>(std::max(std::floor(minX), static_cast<float>(target.clipStartX)));
+    int16_t endX = static_cast<int16_t>(std::min(std::ceil(maxX), static_cast<float>(target.clipEndX)));
+    int16_t startY = static_cast<int16_t>(std::max(std::floor(minY), static_cast<float>(target.clipStartY)));
+    int16_t endY = static_cast<int16_t>(std::min(std::ceil(maxY), static_cast<float>(target.clipEndY)));
+    if (startX >= endX || startY >= endY)
+        return;
+
+    context.MarkDirty(startX, startY, endX, endY);
+
+    int16_t width = endX - startX;
+    coverageCells.assign(width, 0);
+    coverageRow.resize(width);
+    int32_t *cells = coverageCells.data();
+    uint8_t *coverage = coverageRow.data();
+
+    activeEdges.clear();
+    size_t nextEdge = 0;
     for (int16_t y = startY; y < endY; ++y)
     {
-        for (int16_t x = startX; x < endX; ++x)
+        activeEdges.erase(std::remove_if(activeEdges.begin(), activeEdges.end(), [y](const PolygonEdge &edge) { return edge.endY <= y; }),
+                          activeEdges.end());
+        while (nextEdge < edges.size() && edges[nextEdge].firstY <= y)
+            activeEdges.push_back(edges[nextEdge++]);
+
+        int16_t touchedStart = width;
+        int16_t touchedEnd = 0;
+        for (const PolygonEdge &edge : activeEdges)
+        {
+            float top = std::max(edge.topY, static_cast<float>(y));
+            float bottom = std::min(edge.bottomY, static_cast<float>(y + 1));
+            if (top >= bottom)
+                continue;
+            float xa = edge.topX + (top - edge.topY) * edge.slope;
+            float xb = edge.topX + (bottom - edge.topY) * edge.slope;
+            AccumulateCoverage(cells, startX, endX, xa, xb, (bottom - top) * edge.winding, touchedStart, touchedEnd);
+        }
+        if (touchedStart > touchedEnd)
+            continue;
+
+        int32_t sum = 0;
+        auto toCoverage = [rule](int32_t sum)
+        {
+            int32_t area = std::abs(sum);
+            if (rule == FillRule::EVENODD)
+            {
+                area &= 0x1FFFF;
+                if (area > 0x10000)
+                    area = 0x20000 - area;
+            }
+            else
+            {
+                area = std::min(area, 0x10000);
+            }
+            return static_cast<uint8_t>((area * 255 + 0x8000) >> 16);
+        };
+        for (int16_t i = touchedStart; i <= touchedEnd; ++i)
+        {
+            sum += cells[i];
+            coverage[i] = toCoverage(sum);
+            cells[i] = 0;
+        }
+        // right of the last touched cell the sum stays the same, it is only not 0 where the polygon
+        // continues past the clipping area
+        int16_t runEnd = touchedEnd + 1;
+        if (toCoverage(sum) != 0)
+        {
+            std::fill(coverage + runEnd, coverage + width, toCoverage(sum));
+            runEnd = width;
+        }
+        target.Blend(startX + touchedStart, y, coverage + touchedStart, runEnd - touchedStart);
+    }
+}
+
+// larger radii would overflow the 64 bit terms of the midpoint recurrences
+static const uint16_t maxShapeRadius = 16383;
+
+// Half widths of the rows of an ellipse around a pixel centre, extents[dy] is the largest dx with the
+// pixel centre dx, dy inside the ellipse with semi axes radiusX + 0.5 and radiusY + 0.5. Midpoint
+// recurrence on 4 dx^2 b + 4 dy^2 a - a b with a = (2 radiusX + 1)^2 and b = (2 radiusY + 1)^2
+static void EllipseExtents(uint16_t radiusX, uint16_t radiusY, std::vector<int16_t> &extents)
+{
+    extents.resize(radiusY + 1);
+    int64_t a = (2 * radiusX + 1) * static_cast<int64_t>(2 * radiusX + 1);
+    int64_t b = (2 * radiusY + 1) * static_cast<int64_t>(2 * radiusY + 1);
+    int64_t dx = radiusX;
+    int64_t value = 4 * dx * dx * b - a * b;
+    for (int64_t dy = 0; dy <= radiusY; ++dy)
+    {
+        while (value > 0)
+        {
+            value -= 4 * b * (2 * dx - 1);
+            --dx;
+        }
+        extents[dy] = static_cast<int16_t>(dx);
+        value += 4 * a * (2 * dy + 1);
+    }
+}
+
+// Pixels a rounded corner cuts off the rows of a rounded rect, insets[t] for the t-th row from the top
+// or bottom. A pixel is kept when its centre lies inside the circle around the corner's inner point,
+// counted in half pixels (2 k + 1)^2 + (2 (radius - t) - 1)^2 <= (2 radius)^2 with k the pixels
+// between it and the circle centre
+static void CornerInsets(uint16_t radius, std::vector<int16_t> &insets)
+{
+    insets.resize(radius);
+    int64_t k = radius - 1;
+    int64_t dy = 1;
+    int64_t value = (2 * k + 1) * (2 * k + 1) + dy * dy - 4 * static_cast<int64_t>(radius) * radius;
+    for (int t = radius - 1; t >= 0; --t)
+    {
+        while (value > 0)
+        {
+            value -= 8 * k;
+            --k;
+        }
+        insets[t] = static_cast<int16_t>(radius - 1 - k);
+        value += 4 * dy + 4;
+        dy += 2;
+    }
+}
+
+// pixels of one scanline an ellipse touches, innerStart to innerEnd - 1 lie completely inside
+struct EllipseRow
+{
+    int outerStart, outerEnd, innerStart, innerEnd;
+};
+
+// the widest and narrowest chord of the ellipse within the scanline give the touched and the
+// covered pixels, an empty inner range sits at the centre
+static bool GetEllipseRow(float centerX, float centerY, float a, float b, int y, EllipseRow &row)
+{
+    float top = y - centerY;
+    float bottom = y + 1 - centerY;
+    float nearest = (top <= 0 && bottom >= 0) ? 0 : std::min(std::fabs(top), std::fabs(bottom));
+    float farthest = std::max(std::fabs(top), std::fabs(bottom));
+    if (nearest >= b)
+        return false;
+
+    float outer = a * std::sqrt(1.0f - (nearest / b) * (nearest / b));
+    float inner = farthest < b ? a * std::sqrt(1.0f - (farthest / b) * (farthest / b)) : 0;
+    row.outerStart = static_cast<int>(std::floor(centerX - outer));
+    row.outerEnd = static_cast<int>(std::ceil(centerX + outer));
+    row.innerStart = static_cast<int>(std::ceil(centerX - inner));
+    row.innerEnd = static_cast<int>(std::floor(centerX + inner));
+    if (row.innerStart >= row.innerEnd)
+        row.innerStart = row.innerEnd = static_cast<int>(std::floor(centerX));
+    return true;
+}
+
+static inline uint8_t ToCoverage(float coverage)
+{
+    return static_cast<uint8_t>(std::clamp(coverage, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+// coverage of the pixel with its centre at x, y relative to the ellipse centre, from the signed
+// distance to the outline estimated by the implicit function over its gradient. The estimate assumes
+// a straight outline through the pixel, so for thin ellipses it is limited by the part of the pixel
+// between the widest horizontal and vertical chords within the pixel
+static inline float EllipseCoverage(float x, float y, float a, float b)
+{
+    float inverseA2 = 1.0f / (a * a);
+    float inverseB2 = 1.0f / (b * b);
+    float value = x * x * inverseA2 + y * y * inverseB2 - 1.0f;
+    float gradient = 2.0f * std::sqrt(x * x * inverseA2 * inverseA2 + y * y * inverseB2 * inverseB2);
+    float coverage = gradient == 0 ? 1.0f : 0.5f - value / gradient;
+
+    float nearestY = std::max(0.0f, std::fabs(y) - 0.5f);
+    float nearestX = std::max(0.0f, std::fabs(x) - 0.5f);
+    float chordX = a * std::sqrt(std::max(0.0f, 1.0f - nearestY * nearestY * inverseB2));
+    float chordY = b * std::sqrt(std::max(0.0f, 1.0f - nearestX * nearestX * inverseA2));
+    coverage = std::min(coverage, std::min(x + 0.5f, chordX) - std::max(x - 0.5f, -chordX));
+    return std::min(coverage, std::min(y + 0.5f, chordY) - std::max(y - 0.5f, -chordY));
+}
+
+void PrimitivesRenderer::BlendEllipseEdge(SpanTarget &target, int y, int x0, int x1, float centerX, float centerY, float a, float b)
+{
+    x0 = std::max<int>(x0, target.clipStartX);
+    x1 = std::min<int>(x1, target.clipEndX);
+    if (x0 >= x1 || y < target.clipStartY || y >= target.clipEndY)
+        return;
+    if (coverageRow.size() < static_cast<size_t>(x1 - x0))
+        coverageRow.resize(x1 - x0);
+
+    float py = y + 0.5f - centerY;
+    for (int x = x0; x < x1; ++x)
+        coverageRow[x - x0] = ToCoverage(EllipseCoverage(x + 0.5f - centerX, py, a, b));
+    target.Blend(x0, y, coverageRow.data(), x1 - x0);
+}
+
+void PrimitivesRenderer::FillCircle(Color color, int16_t centerX, int16_t centerY, uint16_t radius)
+{
+    FillEllipse(color, centerX, centerY, radius, radius);
+}
+
+void PrimitivesRenderer::FillEllipse(Color color, int16_t centerX, int16_t centerY, uint16_t radiusX, uint16_t radiusY)
+{
+    if (context.IsRecording())
+    {
+        context.GetRecordingList()->RecordEllipse(context, color, centerX, centerY, radiusX, radiusY);
+        return;
+    }
+
+    SpanTarget target;
+    if (!BeginSpans(color, target))
+        return;
+
+    radiusX = std::min(radiusX, maxShapeRadius);
+    radiusY = std::min(radiusY, maxShapeRadius);
+    int startX = std::max<int>(centerX - radiusX, target.clipStartX);
+    int startY = std::max<int>(centerY - radiusY, target.clipStartY);
+    int endX = std::min<int>(centerX + radiusX + 1, target.clipEndX);
+    int endY = std::min<int>(centerY + radiusY + 1, target.clipEndY);
+    if (startX >= endX || startY >= endY)
+        return;
+
+    context.MarkDirty(startX, startY, endX, endY);
+
+    if (context.IsAntialiasingEnabled())
+    {
+        // the covered middle of a row is one span, only the pixels on the outline get a coverage run
+        float cx = centerX + 0.5f;
+        float cy = centerY + 0.5f;
+        float a = radiusX + 0.5f;
+        float b = radiusY + 0.5f;
+        for (int y = startY; y < endY; ++y)
         {
-            // Apply the inverse transformation to find the corresponding source pixel
-            float srcX = invMatrix[0][0] * x + invMatrix[0][1] * y + invMatrix[0][2];
-            float srcY = invMatrix[1][0] * x + invMatrix[1][1] * y + invMatrix[1][2];
+            EllipseRow row;
+            if (!GetEllipseRow(cx, cy, a, b, y, row))
+                continue;
+            BlendEllipseEdge(target, y, row.outerStart, row.innerStart, cx, cy, a, b);
+            target.Fill(y, row.innerStart, row.innerEnd);
+            BlendEllipseEdge(target, y, row.innerEnd, row.outerEnd, cx, cy, a, b);
+        }
+        return;
+    }
+
+    // the recurrence always runs from the centre row, so every clipped part gets the same rows
+    EllipseExtents(radiusX, radiusY, rowExtents);
+    for (int y = startY; y < endY; ++y)
+    {
+        int halfWidth = rowExtents[std::abs(y - centerY)];
+        target.Fill(y, centerX - halfWidth, centerX + halfWidth + 1);
+    }
+}
+
+void PrimitivesRenderer::FillRoundedRect(Color color, int16_t x, int16_t y, uint16_t length, uint16_t height, uint16_t radius)
+{
+    if (context.IsRecording())
+    {
+        context.GetRecordingList()->RecordRoundedRect(context, color, x, y, length, height, radius);
+        return;
+    }
+
+    SpanTarget target;
+    if (!BeginSpans(color, target))
+        return;
+
+    radius = std::min<uint16_t>(radius, std::min(length, height) / 2);
+    int right = x + length;
+    int bottom = y + height;
+    int startX = std::max<int>(x, target.clipStartX);
+    int startY = std::max<int>(y, target.clipStartY);
+    int endX = std::min<int>(right, target.clipEndX);
+    int endY = std::min<int>(bottom, target.clipEndY);
+    if (startX >= endX || startY >= endY)
+        return;
+
+    context.MarkDirty(startX, startY, endX, endY);
 
-            // Check if the source pixel is within bounds
-            if (srcX >= 0 && srcX < length && srcY >= 0 && srcY < height)
+    if (context.IsAntialiasingEnabled())
+    {
+        // the straight edges lie on pixel borders, only the corners get coverage runs
+        float r = radius;
+        for (int row = startY; row < endY; ++row)
+        {
+            if (row - y >= radius && bottom - 1 - row >= radius)
             {
-                uint8_t *dest = textureData + y * pitch + x * info.bytesPerPixel;
-
-                switch (bc.mode)
-                {
-                case BlendMode::NOBLEND:
-                    MemHandler::MemCopy(dest, pixelData, info.bytesPerPixel);
-                    break;
-                default:
-                    context.GetBlendFunc()(dest, pixelData, 1, info, PixelFormatRegistry::GetInfo(PixelFormat::ARGB8888), context.GetColoring(), true, bc);
-                    break;
-                }
+                target.Fill(row, x, right);
+                continue;
             }
+            float cy = row - y < radius ? y + r : bottom - r;
+            EllipseRow left, rightCorner;
+            GetEllipseRow(x + r, cy, r, r, row, left);
+            GetEllipseRow(right - r, cy, r, r, row, rightCorner);
+            int fillStart = std::min(left.innerStart, x + radius);
+            int fillEnd = std::max(rightCorner.innerEnd, right - radius);
+            BlendEllipseEdge(target, row, left.outerStart, fillStart, x + r, cy, r, r);
+            target.Fill(row, fillStart, fillEnd);
+            BlendEllipseEdge(target, row, fillEnd, rightCorner.outerEnd, right - r, cy, r, r);
         }
+        return;
+    }
+
+    CornerInsets(radius, rowExtents);
+    for (int row = startY; row < endY; ++row)
+    {
+        int fromEdge = std::min(row - y, bottom - 1 - row);
+        int inset = fromEdge < radius ? rowExtents[fromEdge] : 0;
+        target.Fill(row, x + inset, right - inset);
+    }
+}
+
+void PrimitivesRenderer::DrawArc(Color color, int16_t centerX, int16_t centerY, uint16_t radius, uint16_t thickness, float startAngle, float endAngle)
+{
+    if (context.IsRecording())
+    {
+        context.GetRecordingList()->RecordArc(context, color, centerX, centerY, radius, thickness, startAngle, endAngle);
+        return;
+    }
+
+    // clockwise sweep from the start angle, nothing for an empty one
+    float sweep = endAngle - startAngle;
+    bool fullRing = sweep >= 360.0f;
+    if (!fullRing)
+    {
+        sweep = std::fmod(sweep, 360.0f);
+        if (sweep < 0)
+            sweep += 360.0f;
     }
-}
\ No newline at end of file
+    if (thickness == 0 || sweep == 0)
+        return;
+
+    SpanTarget target;
+    if (!BeginSpans(color, target))
+        return;
+
+    radius = std::min(radius, maxShapeRadius);
+    int startX = std::max<int>(centerX - radius, target.clipStartX);
+    int startY = std::max<int>(centerY - radius, target.clipStartY);
+    int endX = std::min<int>(centerX + radius + 1, target.clipEndX);
+    int endY = std::min<int>(centerY + radius + 1, target.clipEndY);
+    if (startX >= endX || startY >= endY)
+        return;
+
+    context.MarkDirty(startX, startY, endX, endY);
+
+    // distance of a point relative to the centre to the lines through the start and end direction,
+    // positive inside the arc. Up to 180 degrees a point has to be inside both, above inside either
+    const float toRadians = 3.14159265358979323846f / 180.0f;
+    float startDirX = std::cos(startAngle * toRadians);
+    float startDirY = std::sin(startAngle * toRadians);
+    float endDirX = std::cos(endAngle * toRadians);
+    float endDirY = std::sin(endAngle * toRadians);
+    bool wide = sweep > 180.0f;
+    auto angleDistance = [&](float px, float py)
+    {
+        float fromStart = startDirX * py - startDirY * px;
+        float toEnd = px * endDirY - py * endDirX;
+        return wide ? std::max(fromStart, toEnd) : std::min(fromStart, toEnd);
+    };
+
+    int innerRadius = radius - thickness;
+    if (context.IsAntialiasingEnabled())
+    {
+        float cx = centerX + 0.5f;
+        float cy = centerY + 0.5f;
+        float outer = radius + 0.5f;
+        float inner = outer - thickness;
+        auto blendSegment = [&](int y, int x0, int x1)
+        {
+            x0 = std::max<int>(x0, target.clipStartX);
+            x1 = std::min<int>(x1, target.clipEndX);
+            if (x0 >= x1)
+                return;
+            if (coverageRow.size() < static_cast<size_t>(x1 - x0))
+                coverageRow.resize(x1 - x0);
+            float py = y + 0.5f - cy;
+            for (int x = x0; x < x1; ++x)
+            {
+                float px = x + 0.5f - cx;
+                float distance = std::sqrt(px * px + py * py);
+                float coverage = std::min(outer - distance, distance - inner) + 0.5f;
+                if (!fullRing)
+                    coverage = std::min(coverage, 1.0f) * std::clamp(angleDistance(px, py) + 0.5f, 0.0f, 1.0f);
+                coverageRow[x - x0] = ToCoverage(coverage);
+            }
+            target.Blend(x0, y, coverageRow.data(), x1 - x0);
+        };
+
+        for (int y = startY; y < endY; ++y)
+        {
+            EllipseRow row;
+            if (!GetEllipseRow(cx, cy, outer, outer, y, row))
+                continue;
+            // pixels completely inside the inner circle stay untouched
+            EllipseRow hole;
+            if (inner > 0 && GetEllipseRow(cx, cy, inner, inner, y, hole) && hole.innerStart < hole.innerEnd)
+            {
+                blendSegment(y, row.outerStart, hole.innerStart);
+                blendSegment(y, hole.innerEnd, row.outerEnd);
+            }
+            else
+            {
+                blendSegment(y, row.outerStart, row.outerEnd);
+            }
+        }
+        return;
+    }
+
+    // a ring row is the row of the outer circle without the row of the inner one, the pixels inside
+    // the angle are collected into spans
+    auto fillSegment = [&](int y, int x0, int x1)
+    {
+        if (fullRing)
+        {
+            target.Fill(y, x0, x1);
+            return;
+        }
+        x0 = std::max<int>(x0, target.clipStartX);
+        x1 = std::min<int>(x1, target.clipEndX);
+        int spanStart = -1;
+        for (int x = x0; x < x1; ++x)
+        {
+            bool inside = angleDistance(static_cast<float>(x - centerX), static_cast<float>(y - centerY)) >= 0;
+            if (inside && spanStart < 0)
+                spanStart = x;
+            else if (!inside && spanStart >= 0)
+            {
+                target.Fill(y, spanStart, x);
+                spanStart = -1;
+            }
+        }
+        if (spanStart >= 0)
+            target.Fill(y, spanStart, x1);
+    };
+
+    EllipseExtents(radius, radius, rowExtents);
+    if (innerRadius >= 0)
+        EllipseExtents(innerRadius, innerRadius, innerRowExtents);
+    for (int y = startY; y < endY; ++y)
+    {
+        int dy = std::abs(y - centerY);
+        int outerHalf = rowExtents[dy];
+        if (dy > innerRadius)
+        {
+            fillSegment(y, centerX - outerHalf, centerX + outerHalf + 1);
+            continue;
+        }
+        int innerHalf = innerRowExtents[dy];
+        fillSegment(y, centerX - outerHalf, centerX - innerHalf);
+        fillSegment(y, centerX + innerHalf + 1, centerX + outerHalf + 1);
+    }
+}
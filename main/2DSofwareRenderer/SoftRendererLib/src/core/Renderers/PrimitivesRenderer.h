@@ -3,9 +3,21 @@
 
 #include "../RendererBase.h"
 #include "../../data/Color.h"
+#include <vector>
 
 namespace Tergos2D
 {
+    // decides which parts of a self overlapping polygon are filled
+    enum class FillRule : uint8_t
+    {
+        EVENODD, // inside where the outline is crossed an odd number of times
+        NONZERO  // inside where the outline winds around the point at least once
+    };
+
+    struct PolygonPoint
+    {
+        float x, y;
+    };
 
     class PrimitivesRenderer : RendererBase
     {
@@ -19,7 +31,56 @@ namespace Tergos2D
 
         void DrawTransformedRect(Color color, uint16_t length, uint16_t height, const float transformationMatrix[3][3]);
 
+        /// @brief Fills a convex or concave polygon, the outline is closed from the last point back to the first.
+        /// A pixel is filled when its centre lies inside, so polygons sharing an edge don't overlap.
+        /// With anti-aliasing enabled the edge pixels are blended with the part of their area inside instead,
+        /// where the outline crosses itself within a pixel that part is approximated
+        void FillPolygon(Color color, const PolygonPoint *points, uint16_t count, FillRule rule = FillRule::NONZERO);
+
+        /// @brief Fills the circle around the centre of pixel centerX, centerY, 2 * radius + 1 pixels wide
+        void FillCircle(Color color, int16_t centerX, int16_t centerY, uint16_t radius);
+
+        /// @brief Fills the ellipse around the centre of pixel centerX, centerY, 2 * radiusX + 1 pixels wide and 2 * radiusY + 1 high
+        void FillEllipse(Color color, int16_t centerX, int16_t centerY, uint16_t radiusX, uint16_t radiusY);
+
+        /// @brief Fills a rect with its corners rounded by quarter circles, radius is limited to half the shorter side
+        void FillRoundedRect(Color color, int16_t x, int16_t y, uint16_t length, uint16_t height, uint16_t radius);
+
+        /// @brief Draws the part of a ring from startAngle to endAngle, the outer edge matches FillCircle with the same radius
+        /// and the ring is thickness pixels wide towards the centre
+        /// @param startAngle in degrees, 0 points right and angles grow clockwise
+        /// @param endAngle in degrees, the arc runs clockwise from startAngle to endAngle, a full ring for 360 degrees or more
+        void DrawArc(Color color, int16_t centerX, int16_t centerY, uint16_t radius, uint16_t thickness, float startAngle, float endAngle);
+
         private:
+        // one non horizontal polygon edge, covering the scanlines firstY to endY - 1
+        struct PolygonEdge
+        {
+            float topX, topY; // upper end point
+            float bottomY;
+            float slope;      // x step per scanline
+            float x;          // x at the pixel centre of the current scanline
+            int16_t firstY, endY;
+            int8_t winding; // 1 for edges going down, -1 for edges going up
+        };
+
+        // target, clipping and colour of a draw call writing solid spans and coverage runs
+        struct SpanTarget;
+        bool BeginSpans(Color color, SpanTarget &target);
+        void DrawLineAntialiased(SpanTarget &target, int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+        void FillPolygonAntialiased(SpanTarget &target, const PolygonPoint *points, uint16_t count, FillRule rule);
+        // blends the pixels x0 to x1 - 1 of row y with their coverage of the ellipse with semi axes a and b
+        void BlendEllipseEdge(SpanTarget &target, int y, int x0, int x1, float centerX, float centerY, float a, float b);
+
+        // kept between calls so filling doesn't allocate once they have grown
+        std::vector<PolygonEdge> edges;
+        std::vector<PolygonEdge> activeEdges;
+        // signed area accumulated per cell of an anti-aliased scanline and the coverage built from it
+        std::vector<int32_t> coverageCells;
+        std::vector<uint8_t> coverageRow;
+        // half widths of the rows of circles and ellipses, insets of rounded corners
+        std::vector<int16_t> rowExtents;
+        std::vector<int16_t> innerRowExtents;
     };
 
 } // namespace Tergos2D
@@ -0,0 +1,38 @@
+#ifndef SAMPLEFILTER_H
+#define SAMPLEFILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../../data/BlendMode/BlendMode.h"
+#include "../../data/PixelFormat/PixelFormatInfo.h"
+
+namespace Tergos2D
+{
+    // Bilinear and mip filtering of the scale and transformed texture renderers. The filters weigh every
+    // byte of neighbouring samples on its own, which is only right for colours that are premultiplied, a
+    // transparent pixel with straight alpha still has a colour and would bleed it into its neighbours as a
+    // dark fringe. Straight alpha sources that are blended are therefore filtered in ARGB8888_PRE, like the
+    // mips are averaged, and go to the blend functions premultiplied.
+
+    /// @brief Format filtered samples of a source are kept in, ARGB8888_PRE for straight alpha that is
+    /// blended, ARGB8888 for the packed 16 bit and indexed formats and the format itself otherwise
+    /// @param hasAlpha taken from the palette for indexed formats
+    /// @param mode the mode the draw blends with, copies ignore alpha and filter the stored channels
+    inline PixelFormat FilterFormat(const PixelFormatInfo &info, bool hasAlpha, BlendMode mode)
+    {
+        if (mode != BlendMode::NOBLEND && hasAlpha && !info.isPremultiplied && info.numChannels == 4)
+            return PixelFormat::ARGB8888_PRE;
+        if (info.isIndexed || info.bytesPerPixel == 2)
+            return PixelFormat::ARGB8888;
+        return info.format;
+    }
+
+    /// @brief Blends count bytes of a and b, weight is the share of b out of 256
+    inline void LerpBytes(const uint8_t *a, const uint8_t *b, uint16_t weight, size_t count, uint8_t *out)
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = static_cast<uint8_t>((a[i] * (256 - weight) + b[i] * weight + 128) >> 8);
+    }
+}
+
+#endif // !SAMPLEFILTER_H
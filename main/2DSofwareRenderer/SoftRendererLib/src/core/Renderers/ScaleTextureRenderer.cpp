@@ -1,13 +1,97 @@
 #include "ScaleTextureRenderer.h"
 #include <algorithm>
+#include <cstring>
 #include "../../util/MemHandler.h"
 #include "../../data/BlendMode/BlendFunctions.h"
 #include "../../data/PixelFormat/PixelConverter.h"
 #include "../RenderContext2D.h"
+#include "../DisplayList.h"
+#include "SampleFilter.h"
 #include <float.h>
 #include <math.h>
 using namespace Tergos2D;
 
+// copies the nearest sample of every column
+template <uint8_t Bytes, typename Column>
+static void GatherRow(const uint8_t *row, const Column *columns, size_t count, uint8_t *out)
+{
+    for (size_t i = 0; i < count; ++i, out += Bytes)
+    {
+        std::memcpy(out, row + columns[i].offset0, Bytes);
+    }
+}
+
+// blends the two neighbours of every column, the row is in the filter format of SampleFilter.h
+template <uint8_t Bytes, typename Column>
+static void FilterRow(const uint8_t *row, const Column *columns, size_t count, uint8_t *out)
+{
+    for (size_t i = 0; i < count; ++i, out += Bytes)
+        LerpBytes(row + columns[i].offset0, row + columns[i].offset1, columns[i].weight, Bytes, out);
+}
+
+// 16.16 source position of target pixel i, i * sourceSize / targetSize, stepped with the remainder of
+// the division carried along so it stays the exact floor and ties land where the float mapping put them
+struct FixedStepper
+{
+    uint32_t position, step;
+    uint32_t remainder, remainderStep, divisor;
+
+    FixedStepper(uint16_t sourceSize, uint16_t targetSize, uint32_t first)
+    {
+        uint64_t scaled = static_cast<uint64_t>(sourceSize) << 16;
+        step = static_cast<uint32_t>(scaled / targetSize);
+        remainderStep = static_cast<uint32_t>(scaled % targetSize);
+        divisor = targetSize;
+        position = static_cast<uint32_t>(scaled * first / targetSize);
+        remainder = static_cast<uint32_t>(scaled * first % targetSize);
+    }
+
+    inline void Next()
+    {
+        position += step;
+        remainder += remainderStep;
+        if (remainder >= divisor)
+        {
+            remainder -= divisor;
+            ++position;
+        }
+    }
+};
+
+// nearest rounds the source position, bilinear keeps 8 bits of its fraction as the weight
+static inline void SourcePosition(uint32_t position, uint16_t size, bool linear, uint16_t &first, uint16_t &second, uint8_t &weight)
+{
+    if (!linear)
+    {
+        first = second = static_cast<uint16_t>(std::min<uint32_t>((position + 0x8000) >> 16, size - 1));
+        weight = 0;
+        return;
+    }
+    first = static_cast<uint16_t>(std::min<uint32_t>(position >> 16, size - 1));
+    second = std::min<uint16_t>(first + 1, size - 1);
+    weight = first == size - 1 ? 0 : static_cast<uint8_t>(position >> 8);
+}
+
+// span types of one source row for positions that never decrease, like the columns of a target row
+struct SpanWalker
+{
+    const TextureSpan *span, *last;
+
+    SpanWalker(const TextureSpans &spans, uint16_t y)
+    {
+        size_t count;
+        span = spans.GetRow(y, count);
+        last = span + count - 1;
+    }
+
+    inline SpanType TypeAt(uint16_t x)
+    {
+        while (x >= span->end && span != last)
+            ++span;
+        return span->type;
+    }
+};
+
 ScaleTextureRenderer::ScaleTextureRenderer(RenderContext2D &context) : RendererBase(context)
 {
 }
@@ -15,6 +99,12 @@ ScaleTextureRenderer::ScaleTextureRenderer(RenderContext2D &context) : RendererB
 void ScaleTextureRenderer::DrawTexture(Texture &texture, int16_t x, int16_t y,
                                        float scaleX, float scaleY)
 {
+    if (context.IsRecording())
+    {
+        context.GetRecordingList()->RecordScaledTexture(context, texture, x, y, scaleX, scaleY);
+        return;
+    }
+
     auto targetTexture = context.GetTargetTexture();
     if (!targetTexture || !texture.GetData() || scaleX <= 0 || scaleY <= 0)
         return;
@@ -24,6 +114,10 @@ void ScaleTextureRenderer::DrawTexture(Texture &texture, int16_t x, int16_t y,
         context.basicTextureRenderer.DrawTexture(texture, x, y);
         return;
     }
+    // packed A4 and A1 masks are only drawn unscaled, convert them to A8 for scaling
+    const PixelFormatInfo &textureInfo = PixelFormatRegistry::GetInfo(texture.GetFormat());
+    if (textureInfo.isBitFormat && !textureInfo.isIndexed)
+        return;
     // Get format information
     PixelFormat targetFormat = targetTexture->GetFormat();
     PixelFormatInfo targetInfo = PixelFormatRegistry::GetInfo(targetFormat);
@@ -44,6 +138,8 @@ void ScaleTextureRenderer::DrawTexture(Texture &texture, int16_t x, int16_t y,
     // Calculate scaled dimensions
     uint16_t dstWidth = static_cast<uint16_t>(sourceWidth * scaleX);
     uint16_t dstHeight = static_cast<uint16_t>(sourceHeight * scaleY);
+    if (dstWidth == 0 || dstHeight == 0)
+        return;
 
     // Set clipping boundaries based on SCALED size
     auto clippingArea = context.GetClippingArea();
@@ -57,107 +153,280 @@ void ScaleTextureRenderer::DrawTexture(Texture &texture, int16_t x, int16_t y,
                            : y + dstHeight;
 
     // Clamp to target texture bounds
+    int16_t originX = targetTexture->GetOriginX();
+    int16_t originY = targetTexture->GetOriginY();
+    clipStartX = std::max(clipStartX, originX);
+    clipStartY = std::max(clipStartY, originY);
     clipEndX = std::min(clipEndX, (int16_t)targetWidth);
     clipEndY = std::min(clipEndY, (int16_t)targetHeight);
 
     if (clipStartX >= clipEndX || clipStartY >= clipEndY)
         return;
 
+    bool linear = context.GetSamplingMethod() == SamplingMethod::LINEAR;
+
+    // indexed textures blend on the alpha of their palette
+    PixelFormatInfo blendInfo = sourceInfo;
+    if (sourceInfo.isIndexed)
+    {
+        if (!texture.GetPalette())
+            return;
+        blendInfo.hasAlpha = texture.PaletteHasAlpha();
+    }
+
     // Prepare blending mode
     BlendContext bc = context.GetBlendContext();
-    bc.mode = context.BlendModeToUse(sourceInfo);
+    bc.mode = context.BlendModeToUse(blendInfo);
 
-    uint8_t dstBuffer[MAXBYTESPERPIXEL];
+    // nearest sampling copies source pixels and keeps the rows in the source format, bilinear sampling
+    // widens them to the filter format, see SampleFilter.h. Indexed rows are always expanded through a
+    // copy of the palette, indices past its end read zero entries
+    PixelFormat sampleFormat = linear              ? FilterFormat(sourceInfo, blendInfo.hasAlpha, bc.mode)
+                               : sourceInfo.isIndexed ? PixelFormat::ARGB8888
+                                                      : sourceFormat;
+    PixelFormatInfo sampleInfo = PixelFormatRegistry::GetInfo(sampleFormat);
+    sampleInfo.hasAlpha = blendInfo.hasAlpha;
+    uint8_t sampleBytes = sampleInfo.bytesPerPixel;
 
-    for (int16_t dy = clipStartY; dy < clipEndY; dy++)
+    alignas(4) uint8_t entries[256 * 4] = {};
+    PixelConverter::ConvertFunc widenFunc = nullptr;
+    if (sourceInfo.isIndexed)
     {
-        if (dy < 0)
-            continue;
-        for (int16_t dx = clipStartX; dx < clipEndX; dx++)
+        uint16_t paletteSize = std::min<uint16_t>(texture.GetPaletteSize(), 1 << sourceInfo.bitsPerPixel);
+        MemHandler::MemCopy(entries, texture.GetPalette(), paletteSize * 4);
+        if (sampleFormat == PixelFormat::ARGB8888_PRE)
+            PixelConverter::GetConversionFunction(PixelFormat::ARGB8888, sampleFormat)(entries, entries, paletteSize);
+    }
+    else if (sampleFormat != sourceFormat)
+    {
+        widenFunc = PixelConverter::GetConversionFunction(sourceFormat, sampleFormat);
+        if (!widenFunc)
+            return;
+    }
+
+    auto blendFunc = context.GetBlendFunc();
+    PixelConverter::ConvertFunc convertFunc = PixelConverter::GetConversionFunction(sampleFormat, targetFormat);
+    if (bc.mode == BlendMode::NOBLEND ? !convertFunc : !blendFunc)
+        return;
+    const auto &coloring = context.GetColoring();
+
+    // shrinking samples the mips, like OpenGL the axis that shrinks most picks the level. Nearest takes
+    // the smallest level that still has at least the target size, bilinear blends it with the next one
+    const TextureMips *mips = texture.GetMips();
+    float level = mips ? mips->LevelOf(1.0f / std::min(scaleX, scaleY)) : 0.0f;
+    uint8_t firstLevel = static_cast<uint8_t>(level);
+    uint16_t levelWeight = linear ? static_cast<uint16_t>(std::lround((level - firstLevel) * 256)) : 0;
+    if (levelWeight == 256)
+    {
+        ++firstLevel;
+        levelWeight = 0;
+    }
+
+    // samples from transparent spans are skipped, samples from opaque spans are copied instead of blended,
+    // the index only describes the texture itself, not its mips
+    const TextureSpans *spans = firstLevel == 0 && levelWeight == 0 && TextureSpans::CanSkipTransparent(bc) ? texture.GetSpans() : nullptr;
+    bool copyOpaque = spans && convertFunc && TextureSpans::CanCopyOpaque(bc, coloring);
+
+    context.MarkDirty(clipStartX, clipStartY, clipEndX, clipEndY);
+
+    // the column tables are built once per draw
+    size_t count = clipEndX - clipStartX;
+    size_t lineBytes = count * sampleBytes;
+    int levelCount = levelWeight ? 2 : 1;
+    for (int i = 0; i < levelCount; ++i)
+    {
+        LevelSampler &sampler = levels[i];
+        sampler.shift = firstLevel + i;
+        if (sampler.shift == 0)
         {
-            if (dx < 0)
-                continue;
-            // Calculate normalized texture coordinates with inverse scaling
-            float tx = (dx - x) * (static_cast<float>(sourceWidth) / dstWidth);
-            float ty = (dy - y) * (static_cast<float>(sourceHeight) / dstHeight);
-
-            // Clamp coordinates to texture size
-            tx = std::max(0.0f, std::min(tx, static_cast<float>(sourceWidth - 1)));
-            ty = std::max(0.0f, std::min(ty, static_cast<float>(sourceHeight - 1)));
-
-            // Sample texture
-            switch (context.GetSamplingMethod())
-            {
-            case SamplingMethod::NEAREST:
-            {
-                // Nearest neighbor sampling
-                uint16_t sx = static_cast<uint16_t>(tx + 0.5f);
-                uint16_t sy = static_cast<uint16_t>(ty + 0.5f);
-                const uint8_t *srcPixel = sourceData +
-                                          sy * sourcePitch +
-                                          sx * sourceInfo.bytesPerPixel;
-
-                PixelConverter::Convert(
-                    sourceFormat,
-                    targetFormat,
-                    srcPixel,
-                    dstBuffer,
-                    1);
-                break;
-            }
+            sampler.data = sourceData;
+            sampler.width = sourceWidth;
+            sampler.height = sourceHeight;
+            sampler.pitch = sourcePitch;
+        }
+        else
+        {
+            uint16_t levelPitch;
+            sampler.data = mips->GetLevel(sampler.shift, sampler.width, sampler.height, levelPitch);
+            sampler.pitch = levelPitch;
+        }
+        sampler.sourceBytes = sourceInfo.bytesPerPixel;
+        sampler.sampleBytes = sampleBytes;
+        sampler.linear = linear;
+        sampler.widenFunc = widenFunc;
+        sampler.format = sourceFormat;
+        sampler.entries = sourceInfo.isIndexed ? entries : nullptr;
+        sampler.Prepare(sourceWidth, dstWidth, clipStartX - x, count);
+    }
+    if (levelWeight)
+        blendedLine.resize(lineBytes);
+    const std::vector<ScaleColumn> &columns = levels[0].columns;
 
-            case SamplingMethod::LINEAR:
-            {
-                // Bilinear interpolation
-                int x0 = static_cast<int>(tx);
-                int y0 = static_cast<int>(ty);
-                int x1 = std::min(x0 + 1, static_cast<int>(sourceWidth - 1));
-                int y1 = std::min(y0 + 1, static_cast<int>(sourceHeight - 1));
-
-                float fx = tx - x0;
-                float fy = ty - y0;
-
-                // Get four neighboring pixels
-                const uint8_t *pixels[4] = {
-                    sourceData + y0 * sourcePitch + x0 * sourceInfo.bytesPerPixel, // (x0,y0)
-                    sourceData + y0 * sourcePitch + x1 * sourceInfo.bytesPerPixel, // (x1,y0)
-                    sourceData + y1 * sourcePitch + x0 * sourceInfo.bytesPerPixel, // (x0,y1)
-                    sourceData + y1 * sourcePitch + x1 * sourceInfo.bytesPerPixel  // (x1,y1)
-                };
-
-                // Convert all four pixels to ARGB8888 color format
-                Color colors[4];
-                for (int i = 0; i < 4; i++)
-                {
-                    colors[i] = Color(pixels[i], sourceFormat);
-                }
-
-                // Horizontal interpolation
-                Color top = Color::Lerp(colors[0], colors[1], fx);
-                Color bottom = Color::Lerp(colors[2], colors[3], fx);
-
-                // Vertical interpolation
-                Color finalColor = Color::Lerp(top, bottom, fy);
-
-                finalColor.ConvertTo(targetFormat, dstBuffer);
-                break;
-            }
-            }
+    FixedStepper stepY(sourceHeight, dstHeight, clipStartY - y);
+    for (int16_t dy = clipStartY; dy < clipEndY; ++dy, stepY.Next())
+    {
+        const uint8_t *line = levels[0].Row(stepY.position);
+        if (levelWeight)
+        {
+            LerpBytes(line, levels[1].Row(stepY.position), levelWeight, lineBytes, blendedLine.data());
+            line = blendedLine.data();
+        }
 
-            // Get destination pixel location
-            uint8_t *dstPixel = targetData +
-                                dy * targetPitch +
-                                dx * targetInfo.bytesPerPixel;
+        uint8_t *targetRow = targetData + (dy - originY) * targetPitch + (clipStartX - originX) * targetInfo.bytesPerPixel;
+        if (!spans)
+        {
+            if (bc.mode == BlendMode::NOBLEND)
+                convertFunc(line, targetRow, count);
+            else
+                blendFunc(targetRow, line, count, targetInfo, sampleInfo, coloring, false, bc);
+            continue;
+        }
 
-            // Handle blending
-            if (bc.mode != BlendMode::NOBLEND)
-            {
-                context.GetBlendFunc()(dstPixel, dstBuffer, 1, targetInfo, sourceInfo, context.GetColoring(),false,bc);
-            }
+        // a bilinear sample only takes the type of its neighbours when all four share it
+        uint16_t y0 = levels[0].y0;
+        uint16_t y1 = levels[0].y1;
+        SpanWalker walkers[4] = {{*spans, y0}, {*spans, y0}, {*spans, y1}, {*spans, y1}};
+        auto sampleType = [&](const ScaleColumn &column)
+        {
+            SpanType type = walkers[0].TypeAt(column.x0);
+            if (linear && (walkers[1].TypeAt(column.x1) != type || walkers[2].TypeAt(column.x0) != type ||
+                           walkers[3].TypeAt(column.x1) != type))
+                return SpanType::PARTIAL;
+            return type;
+        };
+        auto drawRun = [&](size_t start, size_t end, SpanType type)
+        {
+            if (type == SpanType::TRANSPARENT)
+                return;
+            uint8_t *target = targetRow + start * targetInfo.bytesPerPixel;
+            const uint8_t *sample = line + start * sampleBytes;
+            if (type == SpanType::OPAQUE && copyOpaque)
+                convertFunc(sample, target, end - start);
             else
+                blendFunc(target, sample, end - start, targetInfo, sampleInfo, coloring, false, bc);
+        };
+        size_t runStart = 0;
+        SpanType runType = sampleType(columns[0]);
+        for (size_t i = 1; i < count; ++i)
+        {
+            SpanType type = sampleType(columns[i]);
+            if (type != runType)
             {
-                MemHandler::MemCopy(dstPixel, dstBuffer, targetInfo.bytesPerPixel);
+                drawRun(runStart, i, runType);
+                runStart = i;
+                runType = type;
             }
         }
+        drawRun(runStart, count, runType);
     }
-}
\ No newline at end of file
+}
+
+void ScaleTextureRenderer::LevelSampler::Prepare(uint16_t textureWidth, uint16_t dstWidth, uint16_t firstColumn, size_t count)
+{
+    columns.resize(count);
+    FixedStepper stepX(textureWidth, dstWidth, firstColumn);
+    for (size_t i = 0; i < count; ++i, stepX.Next())
+    {
+        ScaleColumn &column = columns[i];
+        SourcePosition(stepX.position >> shift, width, linear, column.x0, column.x1, column.weight);
+    }
+
+    // widened rows only hold the columns that are read
+    bool widen = widenFunc || entries;
+    firstX = widen ? columns.front().x0 : 0;
+    widenedCount = columns.back().x1 - firstX + 1;
+    for (ScaleColumn &column : columns)
+    {
+        column.offset0 = (column.x0 - firstX) * sampleBytes;
+        column.offset1 = (column.x1 - firstX) * sampleBytes;
+    }
+    if (widen)
+        widenedRow.resize(widenedCount * 4);
+    widenedY = -1;
+
+    size_t lineBytes = count * sampleBytes;
+    lineBuffer.resize(lineBytes);
+    filteredY[0] = filteredY[1] = -1;
+    if (linear)
+        filteredRows.resize(lineBytes * 2);
+}
+
+// source row sy as sampled pixels, pixel firstX + i at byte i * sampleBytes
+const uint8_t *ScaleTextureRenderer::LevelSampler::SampleRow(uint16_t sy)
+{
+    const uint8_t *row = data + sy * pitch;
+    if (!widenFunc && !entries)
+        return row;
+    if (widenedY != sy)
+    {
+        widenedY = sy;
+        if (entries)
+            PixelConverter::ExpandIndexed(format, row, firstX, entries, 4, widenedRow.data(), widenedCount);
+        else
+            widenFunc(row + firstX * sourceBytes, widenedRow.data(), widenedCount);
+    }
+    return widenedRow.data();
+}
+
+// horizontally filtered rows are kept for the next target row, upscaling reads each source row
+// for several target rows and filters it once
+const uint8_t *ScaleTextureRenderer::LevelSampler::FilteredRow(uint16_t sy, int32_t keep)
+{
+    size_t lineBytes = columns.size() * sampleBytes;
+    for (int slot = 0; slot < 2; ++slot)
+    {
+        if (filteredY[slot] == sy)
+            return filteredRows.data() + slot * lineBytes;
+    }
+    int slot = filteredY[0] == keep ? 1 : 0;
+    filteredY[slot] = sy;
+    uint8_t *out = filteredRows.data() + slot * lineBytes;
+    const uint8_t *row = SampleRow(sy);
+    // widened rows have 4 bytes per pixel, so a filtered row never has 2
+    switch (sampleBytes)
+    {
+    case 1:
+        FilterRow<1>(row, columns.data(), columns.size(), out);
+        break;
+    case 3:
+        FilterRow<3>(row, columns.data(), columns.size(), out);
+        break;
+    default:
+        FilterRow<4>(row, columns.data(), columns.size(), out);
+        break;
+    }
+    return out;
+}
+
+const uint8_t *ScaleTextureRenderer::LevelSampler::Row(uint32_t positionY)
+{
+    SourcePosition(positionY >> shift, height, linear, y0, y1, weightY);
+    size_t count = columns.size();
+    if (linear)
+    {
+        const uint8_t *top = FilteredRow(y0, y1);
+        const uint8_t *bottom = FilteredRow(y1, y0);
+        if (weightY == 0)
+            return top;
+        LerpBytes(top, bottom, weightY, count * sampleBytes, lineBuffer.data());
+        return lineBuffer.data();
+    }
+
+    const uint8_t *row = SampleRow(y0);
+    switch (sampleBytes)
+    {
+    case 1:
+        GatherRow<1>(row, columns.data(), count, lineBuffer.data());
+        break;
+    case 2:
+        GatherRow<2>(row, columns.data(), count, lineBuffer.data());
+        break;
+    case 3:
+        GatherRow<3>(row, columns.data(), count, lineBuffer.data());
+        break;
+    default:
+        GatherRow<4>(row, columns.data(), count, lineBuffer.data());
+        break;
+    }
+    return lineBuffer.data();
+}
@@ -3,6 +3,8 @@
 
 #include "../RendererBase.h"
 #include "../../data/Texture.h"
+#include "../../data/PixelFormat/PixelConverter.h"
+#include <vector>
 
 namespace Tergos2D
 {
@@ -13,10 +15,63 @@ namespace Tergos2D
         ~ScaleTextureRenderer() = default;
 
 
+        /// @brief Draws the texture scaled, rows are stepped in 16.16 fixed point and sampled with the
+        /// sampling method of the context, nearest or bilinear, into a line buffer that is converted or
+        /// blended into the target with one call per row. Shrinking a texture with mips samples the level
+        /// closest to the target size instead, bilinear sampling blends the two levels around it
         void DrawTexture(Texture &texture, int16_t x, int16_t y,
                          float scaleX, float scaleY);
         private:
+        // source pixels of one target column, as byte offsets into a sampled row, x1 is the right
+        // neighbour and weight its share out of 256 for bilinear sampling
+        struct ScaleColumn
+        {
+            uint32_t offset0, offset1;
+            uint16_t x0, x1;
+            uint8_t weight;
+        };
 
+        // Samples the target rows from one level, the texture itself or one of its mips. Positions are
+        // 16.16 on the texture and shifted down by the level, rows are sampled in the source format
+        // or widened to ARGB8888 or ARGB8888_PRE when widenFunc or the palette entries are set
+        struct LevelSampler
+        {
+            const uint8_t *data;
+            uint16_t width, height;
+            size_t pitch;
+            uint8_t shift;
+            uint8_t sourceBytes, sampleBytes;
+            bool linear;
+            PixelConverter::ConvertFunc widenFunc;
+            PixelFormat format;
+            const uint8_t *entries;
+
+            // source rows of the last sampled target row and the share of y1 out of 256
+            uint16_t y0, y1;
+            uint8_t weightY;
+
+            std::vector<ScaleColumn> columns;
+            // widened source rows, two horizontally filtered rows and the finished row
+            std::vector<uint8_t> widenedRow;
+            std::vector<uint8_t> filteredRows;
+            std::vector<uint8_t> lineBuffer;
+
+            /// @brief Builds the column table for count target columns from their texture positions
+            void Prepare(uint16_t textureWidth, uint16_t dstWidth, uint16_t firstColumn, size_t count);
+            /// @brief The sampled pixels of the target row at texture position positionY
+            const uint8_t *Row(uint32_t positionY);
+
+        private:
+            const uint8_t *SampleRow(uint16_t sy);
+            const uint8_t *FilteredRow(uint16_t sy, int32_t keep);
+            uint16_t firstX, widenedCount;
+            int32_t widenedY;
+            int32_t filteredY[2];
+        };
+
+        // the level closest to the target size and the next smaller one for blending two levels
+        LevelSampler levels[2];
+        std::vector<uint8_t> blendedLine;
     };
 
 }
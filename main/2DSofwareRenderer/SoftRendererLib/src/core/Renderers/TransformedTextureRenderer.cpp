@@ -1,15 +1,392 @@
 
 #include "TransformedTextureRenderer.h"
+#include "AffineSpan.h"
 #include <algorithm>
+#include <cstring>
+#include <limits>
 #include "../../util/MemHandler.h"
 #include "../../data/BlendMode/BlendFunctions.h"
 #include "../../data/PixelFormat/PixelConverter.h"
 #include "../RenderContext2D.h"
+#include "../DisplayList.h"
+#include "SampleFilter.h"
 #include <float.h>
 #include <math.h>
 #include <cstdio>
 using namespace Tergos2D;
 
+// samples of count pixels along a target row, u and v are 16.16 source positions stepped by du and dv
+// and clamped to the last column and row, maxU and maxV
+template <uint8_t Bytes>
+static void SampleNearest(const uint8_t *source, size_t pitch, int32_t u, int32_t v, int32_t du, int32_t dv,
+                          int32_t maxU, int32_t maxV, int count, uint8_t *out)
+{
+    for (int i = 0; i < count; ++i, u += du, v += dv, out += Bytes)
+    {
+        int32_t sx = std::clamp(u, 0, maxU) >> 16;
+        int32_t sy = std::clamp(v, 0, maxV) >> 16;
+        std::memcpy(out, source + sy * pitch + sx * Bytes, Bytes);
+    }
+}
+
+// blends the four neighbours of a sample with 8 bit weights, the filter of the scale renderer applied to
+// one sample, first along the row and then down
+template <uint8_t Bytes>
+static inline void FilterSample(const uint8_t *p00, const uint8_t *p01, const uint8_t *p10, const uint8_t *p11,
+                                uint16_t wx, uint16_t wy, uint8_t *out)
+{
+    uint8_t top[Bytes], bottom[Bytes];
+    LerpBytes(p00, p01, wx, Bytes, top);
+    LerpBytes(p10, p11, wx, Bytes, bottom);
+    LerpBytes(top, bottom, wy, Bytes, out);
+}
+
+// bilinear samples of sources that are stored in their filter format, the last column and row are their
+// own right and lower neighbours
+template <uint8_t Bytes>
+static void SampleBilinear(const uint8_t *source, size_t pitch, int32_t u, int32_t v, int32_t du, int32_t dv,
+                           int32_t maxU, int32_t maxV, int count, uint8_t *out)
+{
+    for (int i = 0; i < count; ++i, u += du, v += dv, out += Bytes)
+    {
+        int32_t cu = std::clamp(u, 0, maxU);
+        int32_t cv = std::clamp(v, 0, maxV);
+        const uint8_t *p00 = source + (cv >> 16) * pitch + (cu >> 16) * Bytes;
+        const uint8_t *p01 = cu < maxU ? p00 + Bytes : p00;
+        size_t down = cv < maxV ? pitch : 0;
+        FilterSample<Bytes>(p00, p01, p00 + down, p01 + down, (cu >> 8) & 0xFF, (cv >> 8) & 0xFF, out);
+    }
+}
+
+// bilinear samples of sources that are widened to their 4 byte filter format first, see SampleFilter.h.
+// The four neighbours of up to 16 samples are gathered in the source format and widened with one call
+static void SampleBilinearWidened(const uint8_t *source, size_t pitch, uint8_t bytes, PixelConverter::ConvertFunc widenFunc,
+                                  int32_t u, int32_t v, int32_t du, int32_t dv, int32_t maxU, int32_t maxV, int count, uint8_t *out)
+{
+    const int batch = 16;
+    alignas(4) uint8_t quads[batch * 4 * 4];
+    alignas(4) uint8_t wide[batch * 4 * 4];
+    for (int done = 0; done < count; done += batch)
+    {
+        int n = std::min(batch, count - done);
+        uint16_t weights[batch][2];
+        uint8_t *quad = quads;
+        for (int i = 0; i < n; ++i, u += du, v += dv)
+        {
+            int32_t cu = std::clamp(u, 0, maxU);
+            int32_t cv = std::clamp(v, 0, maxV);
+            weights[i][0] = (cu >> 8) & 0xFF;
+            weights[i][1] = (cv >> 8) & 0xFF;
+            const uint8_t *p00 = source + (cv >> 16) * pitch + (cu >> 16) * bytes;
+            const uint8_t *p01 = cu < maxU ? p00 + bytes : p00;
+            size_t down = cv < maxV ? pitch : 0;
+            for (const uint8_t *pixel : {p00, p01, p00 + down, p01 + down})
+            {
+                std::memcpy(quad, pixel, bytes);
+                quad += bytes;
+            }
+        }
+        widenFunc(quads, wide, n * 4);
+        for (int i = 0; i < n; ++i, out += 4)
+        {
+            const uint8_t *pixels = wide + i * 16;
+            FilterSample<4>(pixels, pixels + 4, pixels + 8, pixels + 12, weights[i][0], weights[i][1], out);
+        }
+    }
+}
+
+using SampleRowFunc = void (*)(const uint8_t *, size_t, int32_t, int32_t, int32_t, int32_t, int32_t, int32_t, int, uint8_t *);
+
+static SampleRowFunc GetSampleRowFunc(uint8_t bytesPerPixel, bool linear)
+{
+    switch (bytesPerPixel)
+    {
+    case 1:
+        return linear ? SampleBilinear<1> : SampleNearest<1>;
+    case 2:
+        return SampleNearest<2>;
+    case 3:
+        return linear ? SampleBilinear<3> : SampleNearest<3>;
+    default:
+        return linear ? SampleBilinear<4> : SampleNearest<4>;
+    }
+}
+
+// source pixels a target pixel steps over where the texture is shrunk least, the longer of the steps along a
+// row and down a column where the texture corners land. The same everywhere for an affine mapping, for a
+// perspective one the nearest corner decides so it stays sharp. Clipping doesn't change it, so every tile
+// of the tiled renderer picks the same level
+template <typename Inverse>
+static float LeastShrink(const Inverse &inverse, const float transformationMatrix[3][3], uint16_t sourceWidth, uint16_t sourceHeight)
+{
+    float least = std::numeric_limits<float>::max();
+    const float corners[4][2] = {
+        {0, 0},
+        {static_cast<float>(sourceWidth), 0},
+        {0, static_cast<float>(sourceHeight)},
+        {static_cast<float>(sourceWidth), static_cast<float>(sourceHeight)}
+    };
+    for (const auto &corner : corners)
+    {
+        float x, y, u, v, rightU, rightV, downU, downV;
+        if (!Inverse::Project(transformationMatrix, corner[0], corner[1], x, y) || !inverse.Map(x, y, u, v) ||
+            !inverse.Map(x + 1, y, rightU, rightV) || !inverse.Map(x, y + 1, downU, downV))
+            continue;
+        float along = std::hypot(rightU - u, rightV - v);
+        float down = std::hypot(downU - u, downV - v);
+        least = std::min(least, std::max(along, down));
+    }
+    return least == std::numeric_limits<float>::max() ? 1.0f : least;
+}
+
+// general path shared by both draw functions. The pixels of a target row that map into the texture form
+// one interval that is found once, inside it the source position is interpolated in 16.16 fixed point
+// between exact positions at most every Subspan pixels and the samples go to the blend and convert kernels
+// in batches. For an affine Inverse the interpolation is exact, for a perspective one this costs a divide
+// per run instead of one per pixel
+template <typename Inverse, int Subspan>
+static void DrawMappedRows(Texture &texture, const float transformationMatrix[3][3], RenderContext2D &context,
+                           int tstartX, int tStartY, int tendX, int tendY, bool linear)
+{
+    static_assert((Subspan & (Subspan - 1)) == 0, "runs are aligned to their length");
+    auto targetTexture = context.GetTargetTexture();
+    PixelFormat sourceFormat = texture.GetFormat();
+    PixelFormatInfo sourceInfo = PixelFormatRegistry::GetInfo(sourceFormat);
+    if (!targetTexture || sourceInfo.isBitFormat || sourceInfo.isIndexed)
+        return;
+    uint8_t *sourceData = texture.GetData();
+    uint16_t sourceWidth = texture.GetWidth();
+    uint16_t sourceHeight = texture.GetHeight();
+    size_t sourcePitch = texture.GetPitch();
+    if (sourceWidth == 0 || sourceHeight == 0)
+        return;
+
+    PixelFormat targetFormat = targetTexture->GetFormat();
+    PixelFormatInfo targetInfo = PixelFormatRegistry::GetInfo(targetFormat);
+    uint8_t *targetData = targetTexture->GetData();
+    size_t targetPitch = targetTexture->GetPitch();
+
+    // Calculate the bounding box of the transformed source texture, a corner behind the viewer
+    // leaves it open to the whole target
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+
+    const float corners[4][2] = {
+        {0, 0},
+        {static_cast<float>(sourceWidth), 0},
+        {0, static_cast<float>(sourceHeight)},
+        {static_cast<float>(sourceWidth), static_cast<float>(sourceHeight)}
+    };
+
+    for (const auto &corner : corners)
+    {
+        float x, y;
+        if (!Inverse::Project(transformationMatrix, corner[0], corner[1], x, y))
+        {
+            minX = minY = std::numeric_limits<float>::lowest();
+            maxX = maxY = std::numeric_limits<float>::max();
+            break;
+        }
+
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+
+    // Clamp the bounding box to the target texture's dimensions and origin
+    int16_t startX = static_cast<int16_t>(std::clamp(std::floor(minX), 0.0f, static_cast<float>(targetTexture->GetWidth())));
+    int16_t startY = static_cast<int16_t>(std::clamp(std::floor(minY), 0.0f, static_cast<float>(targetTexture->GetHeight())));
+    int16_t endX = static_cast<int16_t>(std::clamp(std::ceil(maxX), 0.0f, static_cast<float>(targetTexture->GetWidth())));
+    int16_t endY = static_cast<int16_t>(std::clamp(std::ceil(maxY), 0.0f, static_cast<float>(targetTexture->GetHeight())));
+    int16_t originX = targetTexture->GetOriginX();
+    int16_t originY = targetTexture->GetOriginY();
+    startX = std::max(startX, originX);
+    startY = std::max(startY, originY);
+
+    // rows are settled on the bounding box alone and clipped afterwards, a row running along an edge of
+    // the texture has pixels whose exact test flips with rounding, so the settled ends must not depend on
+    // the clip or the target size, e.g. the tile view of the tiled renderer
+    int16_t rowStartX = static_cast<int16_t>(std::clamp(std::floor(minX), 0.0f, 32767.0f));
+    int16_t rowEndX = static_cast<int16_t>(std::clamp(std::ceil(maxX), 0.0f, 32767.0f));
+    if (context.IsClippingEnabled())
+    {
+        auto clippingArea = context.GetClippingArea();
+        startX = std::max(startX, static_cast<int16_t>(clippingArea.startX));
+        startY = std::max(startY, static_cast<int16_t>(clippingArea.startY));
+        endX = std::min(endX, static_cast<int16_t>(clippingArea.endX));
+        endY = std::min(endY, static_cast<int16_t>(clippingArea.endY));
+    }
+    if (startX >= endX || startY >= endY)
+        return;
+
+    Inverse inverse;
+    if (!inverse.Set(transformationMatrix))
+        return; // Transformation matrix is not invertible
+
+    BlendContext bc = context.GetBlendContext();
+    bc.mode = context.BlendModeToUse(sourceInfo);
+
+    // bilinear samples are filtered and blended in the filter format of SampleFilter.h, nearest ones
+    // are copied in the source format
+    PixelFormat sampleFormat = linear ? FilterFormat(sourceInfo, sourceInfo.hasAlpha, bc.mode) : sourceFormat;
+    PixelFormatInfo sampleInfo = PixelFormatRegistry::GetInfo(sampleFormat);
+    sampleInfo.hasAlpha = sourceInfo.hasAlpha;
+    PixelConverter::ConvertFunc widenFunc = nullptr;
+    if (sampleFormat != sourceFormat)
+    {
+        widenFunc = PixelConverter::GetConversionFunction(sourceFormat, sampleFormat);
+        if (!widenFunc)
+            return;
+    }
+
+    auto blendFunc = context.GetBlendFunc();
+    PixelConverter::ConvertFunc convertFunc = PixelConverter::GetConversionFunction(sampleFormat, targetFormat);
+    if (bc.mode == BlendMode::NOBLEND ? !convertFunc : !blendFunc)
+        return;
+    const auto &coloring = context.GetColoring();
+
+    context.MarkDirty(startX, startY, endX, endY);
+
+    // the part of the texture that is drawn, the exact test of a pixel decides about its borders
+    float minU = std::max(0, tstartX);
+    float maxU = std::min(static_cast<int>(sourceWidth), tendX);
+    float minV = std::max(0, tStartY);
+    float maxV = std::min(static_cast<int>(sourceHeight), tendY);
+
+    SampleRowFunc sampleRow = GetSampleRowFunc(sourceInfo.bytesPerPixel, linear);
+
+    // shrinking samples the mips like the scale renderer, nearest takes the smallest level that still has
+    // at least the target size, bilinear blends it with the next one. Positions on level n are the ones on
+    // the texture shifted down by n
+    const TextureMips *mips = texture.GetMips();
+    float level = mips ? mips->LevelOf(LeastShrink(inverse, transformationMatrix, sourceWidth, sourceHeight)) : 0.0f;
+    uint8_t firstLevel = static_cast<uint8_t>(level);
+    uint16_t levelWeight = linear ? static_cast<uint16_t>(std::lround((level - firstLevel) * 256)) : 0;
+    if (levelWeight == 256)
+    {
+        ++firstLevel;
+        levelWeight = 0;
+    }
+    struct SampleLevel
+    {
+        const uint8_t *data;
+        size_t pitch;
+        int32_t lastU, lastV;
+    } levels[2];
+    for (uint8_t i = 0; i < (levelWeight ? 2 : 1); ++i)
+    {
+        uint16_t width = sourceWidth;
+        uint16_t height = sourceHeight;
+        uint16_t pitch = sourcePitch;
+        const uint8_t *data = firstLevel + i == 0 ? sourceData : mips->GetLevel(firstLevel + i, width, height, pitch);
+        levels[i] = {data, pitch, static_cast<int32_t>(width - 1) << 16, static_cast<int32_t>(height - 1) << 16};
+    }
+    float fixedScale = 65536.0f / static_cast<float>(1 << firstLevel);
+
+    const int maxPos = MAX_BUFFER_SIZE;
+    uint8_t buffer[maxPos * 4];
+    uint8_t smaller[maxPos * 4];
+    for (int16_t y = startY; y < endY; ++y)
+    {
+        auto inside = [&](int16_t x)
+        {
+            float srcX, srcY;
+            if (!inverse.Map(x, y, srcX, srcY))
+                return false;
+            // in case we don't want to render the entire texture we need to clip it again
+            if (srcX < tstartX || srcX > tendX || srcY < tStartY || srcY > tendY)
+                return false;
+            return srcX >= 0 && srcX < sourceWidth && srcY >= 0 && srcY < sourceHeight;
+        };
+        int16_t x0, x1;
+        inverse.RowSpan(y, rowStartX, rowEndX, minU, maxU, minV, maxV, inside, x0, x1);
+        x0 = std::max(x0, startX);
+        x1 = std::min(x1, endX);
+        if (x0 >= x1)
+            continue;
+
+        // exact 16.16 source position at x, the last one is kept because neighbouring runs share their ends
+        int knownX = -1;
+        int32_t knownU = 0, knownV = 0;
+        auto fixedAt = [&](int x, int32_t &u, int32_t &v)
+        {
+            if (x != knownX)
+            {
+                float srcX = 0, srcY = 0;
+                inverse.Map(x, y, srcX, srcY);
+                knownX = x;
+                knownU = static_cast<int32_t>(std::floor(srcX * fixedScale));
+                knownV = static_cast<int32_t>(std::floor(srcY * fixedScale));
+            }
+            u = knownU;
+            v = knownV;
+        };
+        for (int16_t x = x0; x < x1; x += maxPos)
+        {
+            int count = std::min<int>(maxPos, x1 - x);
+            for (int done = 0, n; done < count; done += n)
+            {
+                // runs are aligned to their length and interpolate between their exact ends, so a pixel gets the
+                // same sample wherever the span, a batch or a tile of the tiled renderer starts
+                int at = x + done;
+                int length = inverse.Subspan(at, y, Subspan);
+                int runStart = at & ~(length - 1);
+                n = std::min(runStart + length - at, count - done);
+                int32_t startU, startV, endU = 0, endV = 0;
+                fixedAt(length == 1 ? at : runStart, startU, startV);
+                if (length > 1)
+                    fixedAt(runStart + length, endU, endV);
+                auto sampleRun = [&](const SampleLevel &sampled, uint8_t shift, uint8_t *out)
+                {
+                    int32_t u = startU >> shift, v = startV >> shift, du = 0, dv = 0;
+                    if (length > 1)
+                    {
+                        du = ((endU >> shift) - u) / length;
+                        dv = ((endV >> shift) - v) / length;
+                        u += (at - runStart) * du;
+                        v += (at - runStart) * dv;
+                    }
+                    if (widenFunc)
+                        SampleBilinearWidened(sampled.data, sampled.pitch, sourceInfo.bytesPerPixel, widenFunc, u, v, du, dv,
+                                              sampled.lastU, sampled.lastV, n, out);
+                    else
+                        sampleRow(sampled.data, sampled.pitch, u, v, du, dv, sampled.lastU, sampled.lastV, n, out);
+                };
+                uint8_t *out = buffer + done * sampleInfo.bytesPerPixel;
+                sampleRun(levels[0], 0, out);
+                if (levelWeight)
+                {
+                    sampleRun(levels[1], 1, smaller);
+                    LerpBytes(out, smaller, levelWeight, n * sampleInfo.bytesPerPixel, out);
+                }
+            }
+
+            uint8_t *targetPixel = targetData + (y - originY) * targetPitch + (x - originX) * targetInfo.bytesPerPixel;
+            if (bc.mode == BlendMode::NOBLEND)
+                convertFunc(buffer, targetPixel, count);
+            else
+                blendFunc(targetPixel, buffer, count, targetInfo, sampleInfo, coloring, false, bc);
+        }
+    }
+}
+
+// affine mappings interpolate exactly, so an exact position every MAX_BUFFER_SIZE pixels is only needed to
+// stop the fixed point error from adding up, perspective ones take one at least every 16 pixels
+static void DrawAffineRows(Texture &texture, const float transformationMatrix[3][3], RenderContext2D &context,
+                           int tstartX, int tStartY, int tendX, int tendY, bool linear)
+{
+    DrawMappedRows<AffineInverse, MAX_BUFFER_SIZE>(texture, transformationMatrix, context, tstartX, tStartY, tendX, tendY, linear);
+}
+
+static void DrawPerspectiveRows(Texture &texture, const float transformationMatrix[3][3], RenderContext2D &context,
+                                int tstartX, int tStartY, int tendX, int tendY, bool linear)
+{
+    DrawMappedRows<PerspectiveInverse, 16>(texture, transformationMatrix, context, tstartX, tStartY, tendX, tendY, linear);
+}
+
 TransformedTextureRenderer::TransformedTextureRenderer(RenderContext2D &context) : RendererBase(context)
 {
 }
@@ -17,6 +394,11 @@ TransformedTextureRenderer::TransformedTextureRenderer(RenderContext2D &context)
 
 void TransformedTextureRenderer::DrawTexture(Texture &texture, const float transformationMatrix[3][3], int startX, int StartY, int endX, int endY)
 {
+    if (context.IsRecording())
+    {
+        context.GetRecordingList()->RecordTransformedTexture(context, texture, transformationMatrix, startX, StartY, endX, endY);
+        return;
+    }
     if(m_drawTexture == nullptr) return;
     if(startX == 0 && StartY == 0 && endX == 0 && endY == 0)
     {
@@ -25,6 +407,56 @@ void TransformedTextureRenderer::DrawTexture(Texture &texture, const float trans
     }
     m_drawTexture(texture,transformationMatrix, context,startX,StartY,endX,endY);
 }
+
+void TransformedTextureRenderer::DrawTextureQuad(Texture &texture, const float corners[4][2], int startX, int StartY, int endX, int endY)
+{
+    if(startX == 0 && StartY == 0 && endX == 0 && endY == 0)
+    {
+        endX = texture.GetWidth();
+        endY = texture.GetHeight();
+    }
+    float transformationMatrix[3][3];
+    if (!QuadTransform(corners, startX, StartY, endX, endY, transformationMatrix))
+        return;
+    // goes through the matrix path, so recording and the selected draw function apply as well
+    DrawTexture(texture, transformationMatrix, startX, StartY, endX, endY);
+}
+
+bool TransformedTextureRenderer::QuadTransform(const float corners[4][2], int startX, int startY, int endX, int endY, float transformationMatrix[3][3])
+{
+    if (endX <= startX || endY <= startY)
+        return false;
+
+    // maps the unit square onto the quad (Heckbert), the corner sums vanish for a parallelogram
+    float sumX = corners[0][0] - corners[1][0] + corners[2][0] - corners[3][0];
+    float sumY = corners[0][1] - corners[1][1] + corners[2][1] - corners[3][1];
+    float dx1 = corners[1][0] - corners[2][0];
+    float dx2 = corners[3][0] - corners[2][0];
+    float dy1 = corners[1][1] - corners[2][1];
+    float dy2 = corners[3][1] - corners[2][1];
+    float det = dx1 * dy2 - dx2 * dy1;
+    if (det == 0.0f)
+        return false;
+    float g = (sumX * dy2 - dx2 * sumY) / det;
+    float h = (dx1 * sumY - sumX * dy1) / det;
+
+    float square[3][3] = {
+        {corners[1][0] - corners[0][0] + g * corners[1][0], corners[3][0] - corners[0][0] + h * corners[3][0], corners[0][0]},
+        {corners[1][1] - corners[0][1] + g * corners[1][1], corners[3][1] - corners[0][1] + h * corners[3][1], corners[0][1]},
+        {g, h, 1.0f}
+    };
+
+    // then the texture rect onto the unit square
+    float scaleX = 1.0f / (endX - startX);
+    float scaleY = 1.0f / (endY - startY);
+    for (int row = 0; row < 3; ++row)
+    {
+        transformationMatrix[row][0] = square[row][0] * scaleX;
+        transformationMatrix[row][1] = square[row][1] * scaleY;
+        transformationMatrix[row][2] = square[row][2] - transformationMatrix[row][0] * startX - transformationMatrix[row][1] * startY;
+    }
+    return true;
+}
 void Tergos2D::TransformedTextureRenderer::DrawTexture(Texture &texture, const float transformationMatrix[3][3], RenderContext2D &context, int tstartX, int tStartY, int tendX, int tendY)
 {
     auto targetTexture = context.GetTargetTexture();
@@ -36,6 +468,10 @@ void Tergos2D::TransformedTextureRenderer::DrawTexture(Texture &texture, const f
      // Get texture information
      PixelFormat sourceFormat = texture.GetFormat();
      PixelFormatInfo sourceInfo = PixelFormatRegistry::GetInfo(sourceFormat);
+     // packed A4 and A1 masks are only drawn untransformed, convert them to A8 for transforming,
+     // indexed textures are only expanded by the basic and scale renderers
+     if (sourceInfo.isBitFormat || sourceInfo.isIndexed)
+         return;
      uint8_t *sourceData = texture.GetData();
      uint16_t sourceWidth = texture.GetWidth();
      uint16_t sourceHeight = texture.GetHeight();
@@ -62,10 +498,11 @@ void Tergos2D::TransformedTextureRenderer::DrawTexture(Texture &texture, const f
     // Check if there's no scaling (approximately 1.0)
     bool noScaling = std::abs(scaleX - 1.0f) < EPSILON && std::abs(scaleY - 1.0f) < EPSILON;
 
-    // Check for perspective transformation
-    bool noPerspective = std::abs(transformationMatrix[2][0]) < EPSILON &&
-                        std::abs(transformationMatrix[2][1]) < EPSILON &&
-                        std::abs(transformationMatrix[2][2] - 1.0f) < EPSILON;
+    // Check for perspective transformation, compared exactly because even tiny terms add up over the
+    // width of the texture, e.g. QuadTransform divides them by it
+    bool noPerspective = transformationMatrix[2][0] == 0.0f &&
+                        transformationMatrix[2][1] == 0.0f &&
+                        transformationMatrix[2][2] == 1.0f;
 
     if (noScaling && noPerspective)
     {
@@ -78,245 +515,177 @@ void Tergos2D::TransformedTextureRenderer::DrawTexture(Texture &texture, const f
 
         if (angle % 90 == 0)
         {
-
-            PixelConverter::ConvertFunc convertFunc = PixelConverter::GetConversionFunction(sourceFormat, targetFormat);
-            if (!convertFunc) return;
-
             // Calculate destination coordinates based on rotation
-            int16_t destX = static_cast<int16_t>(transformationMatrix[0][2]);
-            int16_t destY = static_cast<int16_t>(transformationMatrix[1][2]);
-
-            // Adjust clipping based on rotation
-            int16_t startX = destX;
-            int16_t startY = destY;
-            int16_t width = sourceWidth;
-            int16_t height = sourceHeight;
+            int destX = static_cast<int16_t>(transformationMatrix[0][2]);
+            int destY = static_cast<int16_t>(transformationMatrix[1][2]);
+            if (angle == 0)
+            {
+                context.basicTextureRenderer.DrawTexture(texture, destX, destY);
+                return;
+            }
 
+            PixelConverter::ConvertFunc convertFunc = PixelConverter::GetConversionFunction(sourceFormat, targetFormat);
+            auto blendFunc = context.GetBlendFunc();
+            if (bc.mode == BlendMode::NOBLEND ? !convertFunc : !blendFunc)
+                return;
+
+            // the part of the texture that is drawn and where it lands
+            int srcX0 = std::max(0, tstartX);
+            int srcY0 = std::max(0, tStartY);
+            int srcX1 = std::min(static_cast<int>(sourceWidth), tendX);
+            int srcY1 = std::min(static_cast<int>(sourceHeight), tendY);
+            if (srcX0 >= srcX1 || srcY0 >= srcY1)
+                return;
+
+            int startX, startY, endX, endY;
             switch (angle)
             {
-                case 0:   // 0 degrees
-                    context.basicTextureRenderer.DrawTexture(texture,destX,destY);
-                    return;
+                case 90:
+                    startX = destX - srcY1;
+                    endX = destX - srcY0;
+                    startY = destY + srcX0;
+                    endY = destY + srcX1;
                     break;
-                case 90:  // 90 degrees
-                    startX = destX - sourceHeight;
-                    std::swap(width, height);
+                case 180:
+                    startX = destX - srcX1;
+                    endX = destX - srcX0;
+                    startY = destY - srcY1;
+                    endY = destY - srcY0;
                     break;
-                case 180: // 180 degrees
-                    startX = destX - sourceWidth;
-                    startY = destY - sourceHeight;
-                    break;
-                case 270: // 270 degrees
-                    startY = destY - sourceWidth;
-                    std::swap(width, height);
+                default: // 270
+                    startX = destX + srcY0;
+                    endX = destX + srcY1;
+                    startY = destY - srcX1;
+                    endY = destY - srcX0;
                     break;
             }
 
             // Apply clipping
+            int originX = targetTexture->GetOriginX();
+            int originY = targetTexture->GetOriginY();
+            startX = std::max(startX, originX);
+            startY = std::max(startY, originY);
+            endX = std::min(endX, static_cast<int>(targetWidth));
+            endY = std::min(endY, static_cast<int>(targetHeight));
             if (context.IsClippingEnabled())
             {
                 auto clippingArea = context.GetClippingArea();
-                startX = std::max(startX, static_cast<int16_t>(clippingArea.startX));
-                startY = std::max(startY, static_cast<int16_t>(clippingArea.startY));
-                width = std::min(width, static_cast<int16_t>(clippingArea.endX - startX));
-                height = std::min(height, static_cast<int16_t>(clippingArea.endY - startY));
+                startX = std::max(startX, static_cast<int>(clippingArea.startX));
+                startY = std::max(startY, static_cast<int>(clippingArea.startY));
+                endX = std::min(endX, static_cast<int>(clippingArea.endX));
+                endY = std::min(endY, static_cast<int>(clippingArea.endY));
             }
+            if (startX >= endX || startY >= endY)
+                return;
 
-            // Optimized copy for each rotation
-            const int maxPos = MAX_BUFFER_SIZE;
-            uint8_t buffer[maxPos*4];  // Reuse the buffer from original code
-            int pos = 0;
-            uint8_t* targetPixel = nullptr;
-            for (int16_t y = 0; y < height; ++y)
-            {
-                for (int16_t x = 0; x < width; ++x)
-                {
-                    int sourceX, sourceY;
-                    switch (angle)
-                    {
-                        case 0:
-                            sourceX = x;
-                            sourceY = y;
-                            break;
-                        case 270:
-                            sourceX = height - 1 - y;
-                            sourceY = x;
-                            break;
-                        case 180:
-                            sourceX = width - 1 - x;
-                            sourceY = height - 1 - y;
-                            break;
-                        case 90:
-                            sourceX = y;
-                            sourceY = width - 1 - x;
-                            break;
-                    }
-
-                    // Check texture bounds
-                    if (sourceX < tstartX || sourceX > tendX || sourceY < tStartY || sourceY > tendY)
-                        continue;
-
-                    const uint8_t *sourcePixel = sourceData + sourceY * sourcePitch + sourceX * sourceInfo.bytesPerPixel;
-                    if (pos == 0)
-                    {
-                        targetPixel = targetData + (startY + y) * targetPitch + (startX + x) * targetInfo.bytesPerPixel;
-                    }
+            context.MarkDirty(startX, startY, endX, endY);
 
-                    std::memcpy(buffer + sourceInfo.bytesPerPixel * pos, sourcePixel, sourceInfo.bytesPerPixel);
-                    pos++;
+            // the source pixel of the target pixel startX, startY and the byte steps to the next target
+            // pixel of a row and to the next target row
+            ptrdiff_t sourceBytes = sourceInfo.bytesPerPixel;
+            ptrdiff_t pitch = static_cast<ptrdiff_t>(sourcePitch);
+            int sourceX, sourceY;
+            ptrdiff_t stepX, stepY;
+            switch (angle)
+            {
+                case 90:
+                    sourceX = startY - destY;
+                    sourceY = destX - 1 - startX;
+                    stepX = -pitch;
+                    stepY = sourceBytes;
+                    break;
+                case 180:
+                    sourceX = destX - 1 - startX;
+                    sourceY = destY - 1 - startY;
+                    stepX = -sourceBytes;
+                    stepY = -pitch;
+                    break;
+                default: // 270
+                    sourceX = destY - 1 - startY;
+                    sourceY = startX - destX;
+                    stepX = pitch;
+                    stepY = -sourceBytes;
+                    break;
+            }
+            const uint8_t *origin = sourceData + sourceY * pitch + sourceX * sourceBytes;
+            uint8_t *targetRow = targetData + (startY - originY) * targetPitch + (startX - originX) * targetInfo.bytesPerPixel;
+            int width = endX - startX;
+            int height = endY - startY;
+            bool copy = sourceFormat == targetFormat && bc.mode == BlendMode::NOBLEND;
 
-                    if (pos == maxPos)
-                    {
-                        if (bc.mode == BlendMode::NOBLEND)
-                        {
-                            convertFunc(buffer, targetPixel, pos);
-                        }
-                        else
-                        {
-                            context.GetBlendFunc()(targetPixel, buffer, pos, targetInfo, sourceInfo, context.GetColoring(), false, bc);
-                        }
-                        pos = 0;
-                    }
-                }
+            const int maxPos = MAX_BUFFER_SIZE;
+            const int bandRows = 8;
+            uint8_t buffer[bandRows * maxPos * 4];
+            auto writeRow = [&](const uint8_t *pixels, uint8_t *target, int count)
+            {
+                if (bc.mode == BlendMode::NOBLEND)
+                    convertFunc(pixels, target, count);
+                else
+                    blendFunc(target, pixels, count, targetInfo, sourceInfo, context.GetColoring(), false, bc);
+            };
 
-                // Handle remaining pixels in the row
-                if (pos != 0)
+            if (angle == 180)
+            {
+                // every target row is a source row read backwards
+                for (int y = 0; y < height; ++y, targetRow += targetPitch)
                 {
-                    if (bc.mode == BlendMode::NOBLEND)
+                    const uint8_t *sourceRow = origin + y * stepY;
+                    if (copy)
                     {
-                        convertFunc(buffer, targetPixel, pos);
+                        PixelConverter::Reverse(sourceRow - (width - 1) * sourceBytes, targetRow, width, sourceInfo.bytesPerPixel);
+                        continue;
                     }
-                    else
+                    for (int x = 0; x < width; x += bandRows * maxPos)
                     {
-                        context.GetBlendFunc()(targetPixel, buffer, pos, targetInfo, sourceInfo, context.GetColoring(), false, bc);
+                        int count = std::min(width - x, bandRows * maxPos);
+                        PixelConverter::Reverse(sourceRow - (x + count - 1) * sourceBytes, buffer, count, sourceInfo.bytesPerPixel);
+                        writeRow(buffer, targetRow + x * targetInfo.bytesPerPixel, count);
                     }
-                    pos = 0;
                 }
+                return;
             }
-            return;
-        }
-    }
-
-    // Calculate the bounding box of the transformed source texture
-    float minX = std::numeric_limits<float>::max();
-    float minY = std::numeric_limits<float>::max();
-    float maxX = std::numeric_limits<float>::min();
-    float maxY = std::numeric_limits<float>::min();
-
-    std::vector<std::pair<float, float>> corners = {
-        {0, 0},
-        {static_cast<float>(sourceWidth), 0},
-        {0, static_cast<float>(sourceHeight)},
-        {static_cast<float>(sourceWidth), static_cast<float>(sourceHeight)}
-    };
-
-    for (const auto& corner : corners)
-    {
-        float x = transformationMatrix[0][0] * corner.first + transformationMatrix[0][1] * corner.second + transformationMatrix[0][2];
-        float y = transformationMatrix[1][0] * corner.first + transformationMatrix[1][1] * corner.second + transformationMatrix[1][2];
-
-        if (x < minX) minX = x;
-        if (y < minY) minY = y;
-        if (x > maxX) maxX = x;
-        if (y > maxY) maxY = y;
-    }
-
-    // Clamp the bounding box to the target texture's dimensions
-    int16_t startX = std::max(static_cast<int16_t>(std::floor(minX)), static_cast<int16_t>(0));
-    int16_t startY = std::max(static_cast<int16_t>(std::floor(minY)), static_cast<int16_t>(0));
-    int16_t endX = std::min(static_cast<int16_t>(std::ceil(maxX)), static_cast<int16_t>(targetWidth));
-    int16_t endY = std::min(static_cast<int16_t>(std::ceil(maxY)), static_cast<int16_t>(targetHeight));
-
 
-    if (context.IsClippingEnabled())
-    {
-        auto clippingArea = context.GetClippingArea();
-        startX = std::max(startX, static_cast<int16_t>(clippingArea.startX));
-        startY = std::max(startY, static_cast<int16_t>(clippingArea.startY));
-        endX = std::min(endX, static_cast<int16_t>(clippingArea.endX));
-        endY = std::min(endY, static_cast<int16_t>(clippingArea.endY));
-    }
-
-    // Define the inverse transformation matrix
-    float invMatrix[3][3];
-    float det = transformationMatrix[0][0] * (transformationMatrix[1][1] * transformationMatrix[2][2] - transformationMatrix[1][2] * transformationMatrix[2][1]) -
-                transformationMatrix[0][1] * (transformationMatrix[1][0] * transformationMatrix[2][2] - transformationMatrix[1][2] * transformationMatrix[2][0]) +
-                transformationMatrix[0][2] * (transformationMatrix[1][0] * transformationMatrix[2][1] - transformationMatrix[1][1] * transformationMatrix[2][0]);
-
-    if (det == 0.0f)
-        return; // Transformation matrix is not invertible
-
-    float invDet = 1.0f / det;
-
-    // Calculate the inverse matrix
-    invMatrix[0][0] = (transformationMatrix[1][1] * transformationMatrix[2][2] - transformationMatrix[1][2] * transformationMatrix[2][1]) * invDet;
-    invMatrix[0][1] = (transformationMatrix[0][2] * transformationMatrix[2][1] - transformationMatrix[0][1] * transformationMatrix[2][2]) * invDet;
-    invMatrix[0][2] = (transformationMatrix[0][1] * transformationMatrix[1][2] - transformationMatrix[0][2] * transformationMatrix[1][1]) * invDet;
-    invMatrix[1][0] = (transformationMatrix[1][2] * transformationMatrix[2][0] - transformationMatrix[1][0] * transformationMatrix[2][2]) * invDet;
-    invMatrix[1][1] = (transformationMatrix[0][0] * transformationMatrix[2][2] - transformationMatrix[0][2] * transformationMatrix[2][0]) * invDet;
-    invMatrix[1][2] = (transformationMatrix[0][2] * transformationMatrix[1][0] - transformationMatrix[0][0] * transformationMatrix[1][2]) * invDet;
-    invMatrix[2][0] = (transformationMatrix[1][0] * transformationMatrix[2][1] - transformationMatrix[1][1] * transformationMatrix[2][0]) * invDet;
-    invMatrix[2][1] = (transformationMatrix[0][1] * transformationMatrix[2][0] - transformationMatrix[0][0] * transformationMatrix[2][1]) * invDet;
-    invMatrix[2][2] = (transformationMatrix[0][0] * transformationMatrix[1][1] - transformationMatrix[0][1] * transformationMatrix[1][0]) * invDet;
-
-
-    // Iterate over the bounding box in the target texture
-    const int maxPos = MAX_BUFFER_SIZE;
-    uint8_t buffer[maxPos*4];
-    int pos = 0;
-
-    uint8_t *targetPixel = nullptr;
-    PixelConverter::ConvertFunc convertFunc = PixelConverter::GetConversionFunction(sourceFormat, targetFormat);
-    if(!convertFunc) return;
-    for (int16_t y = startY; y < endY; ++y)
-    {
-        for (int16_t x = startX; x < endX; ++x)
-        {
-            // Apply the inverse transformation to find the corresponding source pixel
-            float srcX = invMatrix[0][0] * x + invMatrix[0][1] * y + invMatrix[0][2];
-            float srcY = invMatrix[1][0] * x + invMatrix[1][1] * y + invMatrix[1][2];
-
-            // in case we don't want to render the entire texture we need to clip it again
-            if (srcX < tstartX || srcX > tendX || srcY < tStartY || srcY > tendY)
-                continue;
-            // Check if the source pixel is within bounds
-            if (srcX >= 0 && srcX < sourceWidth && srcY >= 0 && srcY < sourceHeight)
+            // every target row is a source column, transposed in 8 x 8 tiles so that reading the columns
+            // stays within a few cache lines. Transpose walks along source rows forward, when the target
+            // rows step backwards through them the tiles are written bottom up instead
+            auto transpose = [&](const uint8_t *from, uint8_t *to, ptrdiff_t toPitch, int columns, int rows)
             {
-                uint16_t intSrcX = static_cast<uint16_t>(srcX);
-                uint16_t intSrcY = static_cast<uint16_t>(srcY);
-                if(pos == 0)
+                if (stepY < 0)
                 {
-                    targetPixel = targetData + y * targetPitch + x * targetInfo.bytesPerPixel;
+                    from += (rows - 1) * stepY;
+                    to += (rows - 1) * toPitch;
+                    toPitch = -toPitch;
                 }
-                const uint8_t *sourcePixel = sourceData + intSrcY * sourcePitch + intSrcX * sourceInfo.bytesPerPixel;
-                std::memcpy(buffer + sourceInfo.bytesPerPixel*pos, sourcePixel,sourceInfo.bytesPerPixel);
-                pos++;
+                PixelConverter::Transpose(from, stepX, to, toPitch, columns, rows, sourceInfo.bytesPerPixel);
+            };
 
-                if (pos == maxPos)
-                {
+            if (copy)
+            {
+                transpose(origin, targetRow, targetPitch, width, height);
+                return;
+            }
 
-                    if(bc.mode == BlendMode::NOBLEND){
-                        convertFunc(buffer, targetPixel, pos);
-                    }
-                    else{
-                        context.GetBlendFunc()(targetPixel, buffer, pos, targetInfo, sourceInfo, context.GetColoring(),false,bc);
-                    }
-                    pos = 0;
+            // bands of 8 target rows, converted or blended from the buffer a row at a time
+            ptrdiff_t bufferPitch = maxPos * sourceBytes;
+            for (int y = 0; y < height; y += bandRows, targetRow += bandRows * targetPitch)
+            {
+                int rows = std::min(height - y, bandRows);
+                for (int x = 0; x < width; x += maxPos)
+                {
+                    int count = std::min(width - x, maxPos);
+                    transpose(origin + y * stepY + x * stepX, buffer, bufferPitch, count, rows);
+                    for (int row = 0; row < rows; ++row)
+                        writeRow(buffer + row * bufferPitch, targetRow + row * targetPitch + x * targetInfo.bytesPerPixel, count);
                 }
-
-            }
-        }
-        if(pos != 0)
-        {
-            if(bc.mode == BlendMode::NOBLEND){
-                convertFunc(buffer, targetPixel, pos);
             }
-            else{
-                context.GetBlendFunc()(targetPixel, buffer, pos, targetInfo, sourceInfo, context.GetColoring(),false,bc);
-            }
-            pos = 0;
+            return;
         }
     }
+
+    if (!noPerspective)
+        DrawPerspectiveRows(texture, transformationMatrix, context, tstartX, tStartY, tendX, tendY, false);
+    else
+        DrawAffineRows(texture, transformationMatrix, context, tstartX, tStartY, tendX, tendY, false);
 }
 
 void Tergos2D::TransformedTextureRenderer::DrawTextureSamplingSupp(Texture &texture, const float transformationMatrix[3][3], RenderContext2D &context, int tstartX, int tStartY, int tendX, int tendY)
@@ -343,10 +712,11 @@ void Tergos2D::TransformedTextureRenderer::DrawTextureSamplingSupp(Texture &text
     // Check if there's no scaling (approximately 1.0)
     bool noScaling = std::abs(scaleX - 1.0f) < EPSILON && std::abs(scaleY - 1.0f) < EPSILON;
 
-    // Check for perspective transformation
-    bool noPerspective = std::abs(transformationMatrix[2][0]) < EPSILON &&
-                        std::abs(transformationMatrix[2][1]) < EPSILON &&
-                        std::abs(transformationMatrix[2][2] - 1.0f) < EPSILON;
+    // Check for perspective transformation, compared exactly because even tiny terms add up over the
+    // width of the texture, e.g. QuadTransform divides them by it
+    bool noPerspective = transformationMatrix[2][0] == 0.0f &&
+                        transformationMatrix[2][1] == 0.0f &&
+                        transformationMatrix[2][2] == 1.0f;
 
     if (noScaling && noPerspective)
     {
@@ -364,177 +734,10 @@ void Tergos2D::TransformedTextureRenderer::DrawTextureSamplingSupp(Texture &text
         }
     }
 
-    // Get source texture information
-    PixelFormat sourceFormat = texture.GetFormat();
-    PixelFormatInfo sourceInfo = PixelFormatRegistry::GetInfo(sourceFormat);
-    uint8_t *sourceData = texture.GetData();
-    uint16_t sourceWidth = texture.GetWidth();
-    uint16_t sourceHeight = texture.GetHeight();
-    size_t sourcePitch = texture.GetPitch();
-
-    // Get target texture information
-    PixelFormat targetFormat = targetTexture->GetFormat();
-    PixelFormatInfo targetInfo = PixelFormatRegistry::GetInfo(targetFormat);
-    uint8_t *targetData = targetTexture->GetData();
-    uint16_t targetWidth = targetTexture->GetWidth();
-    uint16_t targetHeight = targetTexture->GetHeight();
-    size_t targetPitch = targetTexture->GetPitch();
-
-    // Calculate the bounding box of the transformed source texture
-    float minX = std::numeric_limits<float>::max();
-    float minY = std::numeric_limits<float>::max();
-    float maxX = std::numeric_limits<float>::min();
-    float maxY = std::numeric_limits<float>::min();
-
-    std::vector<std::pair<float, float>> corners = {
-        {0, 0},
-        {static_cast<float>(sourceWidth), 0},
-        {0, static_cast<float>(sourceHeight)},
-        {static_cast<float>(sourceWidth), static_cast<float>(sourceHeight)}
-    };
-
-    for (const auto& corner : corners)
-    {
-        float x = transformationMatrix[0][0] * corner.first + transformationMatrix[0][1] * corner.second + transformationMatrix[0][2];
-        float y = transformationMatrix[1][0] * corner.first + transformationMatrix[1][1] * corner.second + transformationMatrix[1][2];
-
-        if (x < minX) minX = x;
-        if (y < minY) minY = y;
-        if (x > maxX) maxX = x;
-        if (y > maxY) maxY = y;
-    }
-
-    // Clamp the bounding box to the target texture's dimensions
-    int16_t startX = std::max(static_cast<int16_t>(std::floor(minX)), static_cast<int16_t>(0));
-    int16_t startY = std::max(static_cast<int16_t>(std::floor(minY)), static_cast<int16_t>(0));
-    int16_t endX = std::min(static_cast<int16_t>(std::ceil(maxX)), static_cast<int16_t>(targetWidth));
-    int16_t endY = std::min(static_cast<int16_t>(std::ceil(maxY)), static_cast<int16_t>(targetHeight));
-
-
-    if (context.IsClippingEnabled())
-    {
-        auto clippingArea = context.GetClippingArea();
-        startX = std::max(startX, static_cast<int16_t>(clippingArea.startX));
-        startY = std::max(startY, static_cast<int16_t>(clippingArea.startY));
-        endX = std::min(endX, static_cast<int16_t>(clippingArea.endX));
-        endY = std::min(endY, static_cast<int16_t>(clippingArea.endY));
-    }
-
-    // Define the inverse transformation matrix
-    float invMatrix[3][3];
-    float det = transformationMatrix[0][0] * (transformationMatrix[1][1] * transformationMatrix[2][2] - transformationMatrix[1][2] * transformationMatrix[2][1]) -
-                transformationMatrix[0][1] * (transformationMatrix[1][0] * transformationMatrix[2][2] - transformationMatrix[1][2] * transformationMatrix[2][0]) +
-                transformationMatrix[0][2] * (transformationMatrix[1][0] * transformationMatrix[2][1] - transformationMatrix[1][1] * transformationMatrix[2][0]);
-
-    if (det == 0.0f)
-        return; // Transformation matrix is not invertible
-
-    float invDet = 1.0f / det;
-
-    // Calculate the inverse matrix
-    invMatrix[0][0] = (transformationMatrix[1][1] * transformationMatrix[2][2] - transformationMatrix[1][2] * transformationMatrix[2][1]) * invDet;
-    invMatrix[0][1] = (transformationMatrix[0][2] * transformationMatrix[2][1] - transformationMatrix[0][1] * transformationMatrix[2][2]) * invDet;
-    invMatrix[0][2] = (transformationMatrix[0][1] * transformationMatrix[1][2] - transformationMatrix[0][2] * transformationMatrix[1][1]) * invDet;
-    invMatrix[1][0] = (transformationMatrix[1][2] * transformationMatrix[2][0] - transformationMatrix[1][0] * transformationMatrix[2][2]) * invDet;
-    invMatrix[1][1] = (transformationMatrix[0][0] * transformationMatrix[2][2] - transformationMatrix[0][2] * transformationMatrix[2][0]) * invDet;
-    invMatrix[1][2] = (transformationMatrix[0][2] * transformationMatrix[1][0] - transformationMatrix[0][0] * transformationMatrix[1][2]) * invDet;
-    invMatrix[2][0] = (transformationMatrix[1][0] * transformationMatrix[2][1] - transformationMatrix[1][1] * transformationMatrix[2][0]) * invDet;
-    invMatrix[2][1] = (transformationMatrix[0][1] * transformationMatrix[2][0] - transformationMatrix[0][0] * transformationMatrix[2][1]) * invDet;
-    invMatrix[2][2] = (transformationMatrix[0][0] * transformationMatrix[1][1] - transformationMatrix[0][1] * transformationMatrix[1][0]) * invDet;
-
-    BlendContext bc = context.GetBlendContext();
-    bc.mode = context.BlendModeToUse(sourceInfo);
-
-    // Iterate over the bounding box in the target texture
-    const int maxPos = MAX_BUFFER_SIZE;
-    uint8_t buffer[maxPos*4];
-    int pos = 0;
-
-    uint8_t *targetPixel = nullptr;
-    PixelConverter::ConvertFunc convertFunc = PixelConverter::GetConversionFunction(sourceFormat, targetFormat);
-    if(!convertFunc) return;
-    auto sampMethod = context.GetSamplingMethod();
-    for (int16_t y = startY; y < endY; ++y)
-    {
-        for (int16_t x = startX; x < endX; ++x)
-        {
-            // Apply the inverse transformation to find the corresponding source pixel
-            float srcX = invMatrix[0][0] * x + invMatrix[0][1] * y + invMatrix[0][2];
-            float srcY = invMatrix[1][0] * x + invMatrix[1][1] * y + invMatrix[1][2];
-
-
-            // in case we don't want to render the entire texture we need to clip it again
-            if (srcX < tstartX || srcX > tendX || srcY < tStartY || srcY > tendY)
-                continue;
-
-
-            // Check if the source pixel is within bounds
-            if (srcX >= 0 && srcX < sourceWidth && srcY >= 0 && srcY < sourceHeight)
-            {
-                uint16_t intSrcX = static_cast<uint16_t>(srcX);
-                uint16_t intSrcY = static_cast<uint16_t>(srcY);
-                if(pos == 0)
-                {
-                    targetPixel = targetData + y * targetPitch + x * targetInfo.bytesPerPixel;
-                }
-                const uint8_t *sourcePixel = sourceData + intSrcY * sourcePitch + intSrcX * sourceInfo.bytesPerPixel;
-
-                switch (sampMethod)
-                {
-                case SamplingMethod::LINEAR:
-                    {
-                        // Compute the weights for linear interpolation
-                        float fracX = srcX - intSrcX;
-                        float fracY = srcY - intSrcY;
-
-                        uint8_t *srcPixel00 = sourceData + intSrcY * sourcePitch + intSrcX * sourceInfo.bytesPerPixel;
-                        uint8_t *srcPixel01 = sourceData + intSrcY * sourcePitch + (intSrcX + 1) * sourceInfo.bytesPerPixel;
-                        uint8_t *srcPixel10 = sourceData + (intSrcY + 1) * sourcePitch + intSrcX * sourceInfo.bytesPerPixel;
-                        uint8_t *srcPixel11 = sourceData + (intSrcY + 1) * sourcePitch + (intSrcX + 1) * sourceInfo.bytesPerPixel;
-
-                        // Linear interpolation
-                        for (int c = 0; c < sourceInfo.bytesPerPixel; ++c)
-                        {
-                            float value = (1 - fracX) * (1 - fracY) * srcPixel00[c] +
-                                            fracX * (1 - fracY) * srcPixel01[c] +
-                                            (1 - fracX) * fracY * srcPixel10[c] +
-                                            fracX * fracY * srcPixel11[c];
-
-                            buffer[pos * sourceInfo.bytesPerPixel + c] = static_cast<uint8_t>(value);
-                        }
-                        break;
-                    }
-                default:
-                        std::memcpy(buffer + sourceInfo.bytesPerPixel*pos, sourcePixel,sourceInfo.bytesPerPixel);
-                    break;
-                }
-
-                pos++;
-
-                if (pos == maxPos)
-                {
-                    if(bc.mode == BlendMode::NOBLEND){
-                        convertFunc(buffer, targetPixel, pos);
-                    }
-                    else{
-                        context.GetBlendFunc()(targetPixel, buffer, pos, targetInfo, sourceInfo, context.GetColoring(),false,bc);
-                    }
-                    pos = 0;
-                }
-
-            }
-        }
-        if(pos != 0)
-        {
-            if(bc.mode == BlendMode::NOBLEND){
-                convertFunc(buffer, targetPixel, pos);
-            }
-            else{
-                context.GetBlendFunc()(targetPixel, buffer, pos, targetInfo, sourceInfo, context.GetColoring(),false,bc);
-            }
-            pos = 0;
-        }
-    }
+    if (!noPerspective)
+        DrawPerspectiveRows(texture, transformationMatrix, context, tstartX, tStartY, tendX, tendY, true);
+    else
+        DrawAffineRows(texture, transformationMatrix, context, tstartX, tStartY, tendX, tendY, true);
 }
 
 
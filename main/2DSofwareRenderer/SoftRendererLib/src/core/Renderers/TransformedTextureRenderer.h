@@ -32,6 +32,25 @@ namespace Tergos2D
             int endX = 0,
             int endY = 0);
 
+        /// @brief draw a texture perspective correct into a quad, e.g. for page flips
+        /// @param texture
+        /// @param corners destination of the top left, top right, bottom right and bottom left texture corner
+        /// @param startX the part of the texture that is stretched onto the quad, all 0 for the entire texture
+        /// @param StartY
+        /// @param endX
+        /// @param endY
+        void DrawTextureQuad(Texture &texture, const float corners[4][2],
+            int startX = 0,
+            int StartY = 0,
+            int endX = 0,
+            int endY = 0);
+
+        /// @brief the perspective matrix that maps the rect startX..endX, startY..endY of a texture onto a quad
+        /// @param corners destination of the top left, top right, bottom right and bottom left rect corner
+        /// @param transformationMatrix
+        /// @return false when the rect or the quad has no area
+        static bool QuadTransform(const float corners[4][2], int startX, int startY, int endX, int endY, float transformationMatrix[3][3]);
+
         /// @brief generic implementation without sampling support
         /// @param texture
         /// @param transformationMatrix
@@ -39,7 +58,8 @@ namespace Tergos2D
         static void DrawTexture(Texture &texture,  const float transformationMatrix[3][3], RenderContext2D& context, int startX, int StartY, int endX, int endY);
 
 
-        /// @brief  Implementation with Sampling Support supports any BytePixel format (RGBA32,RGB24,Grayscale8, etc ..) not formats like rgb565
+        /// @brief  Implementation with Sampling Support supports any BytePixel format (RGBA32,RGB24,Grayscale8, etc ..), packed
+        /// formats like rgb565 are widened to ARGB8888 for filtering
         /// @param texture
         /// @param transformationMatrix
         /// @param context
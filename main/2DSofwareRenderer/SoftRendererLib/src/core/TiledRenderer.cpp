@@ -0,0 +1,196 @@
+#include "TiledRenderer.h"
+#include "../data/PixelFormat/PixelFormatInfo.h"
+#include "../util/MemHandler.h"
+#include <algorithm>
+
+using namespace Tergos2D;
+
+TiledRenderer::TiledRenderer(uint16_t tileWidth, uint16_t tileHeight, uint8_t *tileBuffer)
+    : tileWidth(tileWidth), tileHeight(tileHeight), tileBuffer(tileBuffer), storedLocally(tileBuffer == nullptr)
+{
+    if (storedLocally)
+        this->tileBuffer = new uint8_t[tileWidth * tileHeight * MAXBYTESPERPIXEL];
+}
+
+TiledRenderer::~TiledRenderer()
+{
+    ReleaseWorkers();
+    if (storedLocally)
+        delete[] tileBuffer;
+}
+
+void TiledRenderer::SetWorkerPool(WorkerPool *pool, uint8_t *const *tileBuffers)
+{
+    ReleaseWorkers();
+    workerPool = pool;
+    if (pool == nullptr)
+        return;
+
+    for (uint8_t i = 1; i < pool->GetWorkerCount(); ++i)
+    {
+        TileWorker *worker = new TileWorker();
+        worker->storedLocally = tileBuffers == nullptr;
+        worker->tileBuffer = worker->storedLocally ? new uint8_t[tileWidth * tileHeight * MAXBYTESPERPIXEL] : tileBuffers[i - 1];
+        workers.push_back(worker);
+    }
+}
+
+void TiledRenderer::ReleaseWorkers()
+{
+    for (TileWorker *worker : workers)
+    {
+        if (worker->storedLocally)
+            delete[] worker->tileBuffer;
+        delete worker;
+    }
+    workers.clear();
+    workerPool = nullptr;
+}
+
+uint16_t TiledRenderer::GetTileWidth()
+{
+    return tileWidth;
+}
+
+uint16_t TiledRenderer::GetTileHeight()
+{
+    return tileHeight;
+}
+
+void TiledRenderer::Render(RenderContext2D &context, const DisplayList &list)
+{
+    Texture *target = context.GetTargetTexture();
+    if (target == nullptr)
+        return;
+    Render(context, list, {0, 0, static_cast<int16_t>(target->GetWidth()), static_cast<int16_t>(target->GetHeight())});
+}
+
+void TiledRenderer::Render(RenderContext2D &context, const DisplayList &list, ClippingArea area)
+{
+    Texture *target = context.GetTargetTexture();
+    if (target == nullptr || tileWidth == 0 || tileHeight == 0)
+        return;
+
+    int16_t targetWidth = target->GetWidth();
+    int16_t targetHeight = target->GetHeight();
+
+    TileJob job;
+    job.renderer = this;
+    job.context = &context;
+    job.list = &list;
+    job.target = target;
+    job.startY = std::max<int16_t>(area.startY, 0) / tileHeight * tileHeight;
+    job.startX = std::max<int16_t>(area.startX, 0) / tileWidth * tileWidth;
+    job.endY = std::min(area.endY, targetHeight);
+    job.endX = std::min(area.endX, targetWidth);
+    if (job.startX >= job.endX || job.startY >= job.endY)
+        return;
+    job.columns = (job.endX - job.startX + tileWidth - 1) / tileWidth;
+    job.tileCount = job.columns * ((job.endY - job.startY + tileHeight - 1) / tileHeight);
+    job.nextTile = 0;
+
+    if (workerPool != nullptr && workerPool->GetWorkerCount() > 1)
+        workerPool->Run(RenderTiles, &job);
+    else
+        RenderTiles(&job, 0);
+
+    context.SetTargetTexture(target);
+}
+
+void TiledRenderer::RenderTiles(void *data, uint8_t workerIndex)
+{
+    TileJob &job = *static_cast<TileJob *>(data);
+    TiledRenderer &renderer = *job.renderer;
+
+    // worker 0 is the calling thread and renders with the caller's context
+    RenderContext2D *context = job.context;
+    uint8_t *tileBuffer = renderer.tileBuffer;
+    std::vector<uint32_t> *bin = &renderer.bin;
+    if (workerIndex > 0)
+    {
+        TileWorker *worker = renderer.workers[workerIndex - 1];
+        context = &worker->context;
+        tileBuffer = worker->tileBuffer;
+        bin = &worker->bin;
+    }
+
+    // tiles are handed out one at a time, so a worker that got cheap tiles takes more of them
+    int16_t targetWidth = job.target->GetWidth();
+    int16_t targetHeight = job.target->GetHeight();
+    for (uint32_t index = job.nextTile.fetch_add(1, std::memory_order_relaxed); index < job.tileCount;
+         index = job.nextTile.fetch_add(1, std::memory_order_relaxed))
+    {
+        int16_t x = job.startX + (index % job.columns) * renderer.tileWidth;
+        int16_t y = job.startY + (index / job.columns) * renderer.tileHeight;
+        ClippingArea tile = {x, y, static_cast<int16_t>(std::min<int>(x + renderer.tileWidth, targetWidth)),
+                             static_cast<int16_t>(std::min<int>(y + renderer.tileHeight, targetHeight))};
+        renderer.RenderTile(*context, *job.list, *job.target, tile, tileBuffer, *bin);
+    }
+}
+
+void TiledRenderer::RenderTile(RenderContext2D &context, const DisplayList &list, Texture &target, ClippingArea tile,
+                               uint8_t *tileBuffer, std::vector<uint32_t> &bin)
+{
+    // bin the commands touching this tile
+    bin.clear();
+    bool startsOpaque = false;
+    for (size_t i = 0; i < list.GetCommandCount(); ++i)
+    {
+        const DrawCommand &command = list.GetCommand(i);
+        const DirtyRect &bounds = command.bounds;
+        if (bounds.startX >= tile.endX || bounds.endX <= tile.startX || bounds.startY >= tile.endY || bounds.endY <= tile.startY)
+            continue;
+
+        // everything before an opaque command covering the whole tile is overwritten anyway
+        bool covers = list.IsOpaque(command, target.GetFormat()) && bounds.startX <= tile.startX && bounds.startY <= tile.startY &&
+                      bounds.endX >= tile.endX && bounds.endY >= tile.endY;
+        if (covers)
+            bin.clear();
+        if (bin.empty())
+            startsOpaque = covers;
+        bin.push_back(static_cast<uint32_t>(i));
+    }
+    if (bin.empty())
+        return;
+
+    PixelFormat format = target.GetFormat();
+    uint8_t bytesPerPixel = PixelFormatRegistry::GetInfo(format).bytesPerPixel;
+    uint16_t width = tile.endX - tile.startX;
+    uint16_t height = tile.endY - tile.startY;
+    uint16_t tilePitch = width * bytesPerPixel;
+    size_t rowBytes = tilePitch;
+    uint32_t targetPitch = target.GetPitch();
+    uint8_t *targetData = target.GetData() + tile.startY * targetPitch + tile.startX * bytesPerPixel;
+
+    // full width tiles with a packed target are one linear block in both buffers
+    bool linear = targetPitch == tilePitch;
+
+    if (!startsOpaque)
+    {
+        if (linear)
+        {
+            MemHandler::MemCopy(tileBuffer, targetData, rowBytes * height);
+        }
+        else
+        {
+            for (uint16_t row = 0; row < height; ++row)
+                MemHandler::MemCopy(tileBuffer + row * tilePitch, targetData + row * targetPitch, rowBytes);
+        }
+    }
+
+    // The view keeps the target coordinates, it only stores the tile from its origin on and every command
+    // is clipped to it
+    Texture view(tile.endX, tile.endY, tileBuffer, format, tilePitch, tile.startX, tile.startY);
+    context.SetTargetTexture(&view);
+    list.Replay(context, bin.data(), bin.size(), &tile);
+
+    if (linear)
+    {
+        MemHandler::MemCopy(targetData, tileBuffer, rowBytes * height);
+    }
+    else
+    {
+        for (uint16_t row = 0; row < height; ++row)
+            MemHandler::MemCopy(targetData + row * targetPitch, tileBuffer + row * tilePitch, rowBytes);
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef TILEDRENDERER_H
+#define TILEDRENDERER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <atomic>
+#include "RenderContext2D.h"
+#include "DisplayList.h"
+#include "../util/WorkerPool.h"
+
+namespace Tergos2D
+{
+    // Renders a DisplayList tile by tile into a small buffer and writes every finished tile to the
+    // target with one copy, so blending reads and writes stay in fast memory instead of the framebuffer.
+    // Tiles without commands are not touched, tiles that start with an opaque command covering them
+    // are not read back from the target. With a WorkerPool the tiles are shared out between its
+    // workers, every worker renders into its own tile buffer with its own context.
+    class TiledRenderer
+    {
+    public:
+        /// @brief tileBuffer has to hold tileWidth * tileHeight * MAXBYTESPERPIXEL bytes, on the ESP32-S3 it
+        /// should be internal SRAM. With nullptr the buffer is allocated with new.
+        TiledRenderer(uint16_t tileWidth, uint16_t tileHeight, uint8_t *tileBuffer = nullptr);
+        ~TiledRenderer();
+
+        TiledRenderer(const TiledRenderer &) = delete;
+        TiledRenderer &operator=(const TiledRenderer &) = delete;
+
+        uint16_t GetTileWidth();
+        uint16_t GetTileHeight();
+
+        /// @brief Renders the tiles on the workers of pool, nullptr renders them on the calling thread.
+        /// tileBuffers holds one buffer per additional worker, sized like the constructor's, nullptr
+        /// allocates them with new. pool has to outlive this renderer or be replaced first.
+        void SetWorkerPool(WorkerPool *pool, uint8_t *const *tileBuffers = nullptr);
+
+        /// @brief Draws list onto the current target of context
+        void Render(RenderContext2D &context, const DisplayList &list);
+
+        /// @brief Draws the tiles of list that intersect area, the tiles are laid out over the full target
+        void Render(RenderContext2D &context, const DisplayList &list, ClippingArea area);
+
+    private:
+        // what a worker besides the calling thread renders with
+        struct TileWorker
+        {
+            RenderContext2D context;
+            std::vector<uint32_t> bin;
+            uint8_t *tileBuffer;
+            bool storedLocally;
+        };
+
+        // shared by all workers during one Render call
+        struct TileJob
+        {
+            TiledRenderer *renderer;
+            RenderContext2D *context;
+            const DisplayList *list;
+            Texture *target;
+            int16_t startX, startY, endX, endY;
+            uint16_t columns;
+            uint32_t tileCount;
+            std::atomic<uint32_t> nextTile;
+        };
+
+        static void RenderTiles(void *data, uint8_t workerIndex);
+        void RenderTile(RenderContext2D &context, const DisplayList &list, Texture &target, ClippingArea tile,
+                        uint8_t *tileBuffer, std::vector<uint32_t> &bin);
+        void ReleaseWorkers();
+
+        uint16_t tileWidth, tileHeight;
+        uint8_t *tileBuffer;
+        bool storedLocally;
+        std::vector<uint32_t> bin;
+
+        WorkerPool *workerPool = nullptr;
+        std::vector<TileWorker *> workers;
+    };
+}
+
+#endif // !TILEDRENDERER_H
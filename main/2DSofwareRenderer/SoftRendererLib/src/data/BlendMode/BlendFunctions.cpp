@@ -4,11 +4,343 @@
 #include "../PixelFormat/PixelFormatInfo.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstring>
+#include <utility>
 
 using namespace Tergos2D;
 #include <cstdio>
 
+// a multiple of 8, chunks of A4 and A1 rows start on a byte
+#define BLENDCHUNKSIZE 64
+
+namespace
+{
+    constexpr size_t blendFactorCount = static_cast<size_t>(BlendFactor::InverseDestColor) + 1;
+    constexpr size_t blendOperationCount = static_cast<size_t>(BlendOperation::BitwiseAnd) + 1;
+
+    template <BlendFactor Factor>
+    inline void ComputeFactor(const uint8_t *src, uint8_t srcAlpha, const uint8_t *dst, uint8_t factor[3])
+    {
+        if constexpr (Factor == BlendFactor::Zero)
+        {
+            factor[0] = factor[1] = factor[2] = 0;
+        }
+        else if constexpr (Factor == BlendFactor::One)
+        {
+            factor[0] = factor[1] = factor[2] = 255;
+        }
+        else if constexpr (Factor == BlendFactor::SourceAlpha)
+        {
+            factor[0] = factor[1] = factor[2] = srcAlpha;
+        }
+        else if constexpr (Factor == BlendFactor::InverseSourceAlpha)
+        {
+            factor[0] = factor[1] = factor[2] = 255 - srcAlpha;
+        }
+        else if constexpr (Factor == BlendFactor::DestAlpha)
+        {
+            factor[0] = factor[1] = factor[2] = dst[0];
+        }
+        else if constexpr (Factor == BlendFactor::InverseDestAlpha)
+        {
+            factor[0] = factor[1] = factor[2] = 255 - dst[0];
+        }
+        else if constexpr (Factor == BlendFactor::SourceColor)
+        {
+            factor[0] = src[1];
+            factor[1] = src[2];
+            factor[2] = src[3];
+        }
+        else if constexpr (Factor == BlendFactor::DestColor)
+        {
+            factor[0] = dst[1];
+            factor[1] = dst[2];
+            factor[2] = dst[3];
+        }
+        else if constexpr (Factor == BlendFactor::InverseSourceColor)
+        {
+            factor[0] = 255 - src[1];
+            factor[1] = 255 - src[2];
+            factor[2] = 255 - src[3];
+        }
+        else
+        {
+            factor[0] = 255 - dst[1];
+            factor[1] = 255 - dst[2];
+            factor[2] = 255 - dst[3];
+        }
+    }
+
+    template <BlendOperation Operation>
+    inline uint8_t Combine(int src, int srcFactor, int dst, int dstFactor)
+    {
+        int value;
+        if constexpr (Operation == BlendOperation::Add)
+        {
+            value = (src * srcFactor + dst * dstFactor) >> 8;
+        }
+        else if constexpr (Operation == BlendOperation::Subtract)
+        {
+            value = (src * srcFactor - dst * dstFactor) >> 8;
+        }
+        else if constexpr (Operation == BlendOperation::ReverseSubtract)
+        {
+            value = (dst * dstFactor - src * srcFactor) >> 8;
+        }
+        else
+        {
+            value = ((src * srcFactor) >> 8) & ((dst * dstFactor) >> 8);
+        }
+        return static_cast<uint8_t>(std::clamp(value, 0, 255));
+    }
+
+    template <BlendFactor SrcFactor, BlendFactor DstFactor, BlendOperation Operation>
+    void BlendKernelARGB8888(uint8_t *dst, const uint8_t *src, size_t count, size_t srcStep, const Coloring &coloring)
+    {
+        bool tint = coloring.colorEnabled && coloring.color.data[0] != 0;
+        const uint8_t *tintColor = coloring.color.data;
+
+        for (size_t i = 0; i < count; ++i, src += srcStep, dst += 4)
+        {
+            uint8_t srcAlpha = src[0];
+            if (srcAlpha == 0)
+            {
+                continue;
+            }
+
+            uint8_t srcPixel[4] = {srcAlpha, src[1], src[2], src[3]};
+            if (tint)
+            {
+                srcPixel[1] = (srcPixel[1] * tintColor[1]) >> 8;
+                srcPixel[2] = (srcPixel[2] * tintColor[2]) >> 8;
+                srcPixel[3] = (srcPixel[3] * tintColor[3]) >> 8;
+                srcAlpha = (srcAlpha * tintColor[0]) >> 8;
+            }
+
+            uint8_t srcFactor[3];
+            uint8_t dstFactor[3];
+            ComputeFactor<SrcFactor>(srcPixel, srcAlpha, dst, srcFactor);
+            ComputeFactor<DstFactor>(srcPixel, srcAlpha, dst, dstFactor);
+
+            dst[1] = Combine<Operation>(srcPixel[1], srcFactor[0], dst[1], dstFactor[0]);
+            dst[2] = Combine<Operation>(srcPixel[2], srcFactor[1], dst[2], dstFactor[1]);
+            dst[3] = Combine<Operation>(srcPixel[3], srcFactor[2], dst[3], dstFactor[2]);
+
+            // Use the maximum alpha
+            dst[0] = std::max(srcAlpha, dst[0]);
+        }
+    }
+
+    // source over for premultiplied ARGB8888_PRE sources, dst = src + dst * (1 - alpha). 256 - alpha
+    // keeps alpha 0 and 255 exact and the sum below 256, so no clamping is needed.
+    void BlendKernelPremultipliedARGB8888(uint8_t *dst, const uint8_t *src, size_t count, size_t srcStep, const Coloring &coloring)
+    {
+        bool tint = coloring.colorEnabled && coloring.color.data[0] != 0;
+        const uint8_t *tintColor = coloring.color.data;
+
+        for (size_t i = 0; i < count; ++i, src += srcStep, dst += 4)
+        {
+            uint8_t srcAlpha = src[0];
+            if (srcAlpha == 0)
+            {
+                continue;
+            }
+
+            uint8_t r = src[1], g = src[2], b = src[3];
+            if (tint)
+            {
+                // the tint alpha scales the premultiplied colour as well
+                r = (((r * tintColor[1]) >> 8) * tintColor[0]) >> 8;
+                g = (((g * tintColor[2]) >> 8) * tintColor[0]) >> 8;
+                b = (((b * tintColor[3]) >> 8) * tintColor[0]) >> 8;
+                srcAlpha = (srcAlpha * tintColor[0]) >> 8;
+            }
+
+            uint16_t inverseAlpha = 256 - srcAlpha;
+            dst[1] = r + ((dst[1] * inverseAlpha) >> 8);
+            dst[2] = g + ((dst[2] * inverseAlpha) >> 8);
+            dst[3] = b + ((dst[3] * inverseAlpha) >> 8);
+
+            // Use the maximum alpha like the straight alpha kernels
+            dst[0] = std::max(srcAlpha, dst[0]);
+        }
+    }
+
+    // RGB565 spread to 0b00000GGGGGG00000RRRRR000000BBBBB, see Platform/generic
+    inline uint32_t ExpandRGB565(uint16_t pixel)
+    {
+        return (pixel | (static_cast<uint32_t>(pixel) << 16)) & 0x07E0F81F;
+    }
+
+    inline uint16_t CompactRGB565(uint32_t pixel)
+    {
+        pixel &= 0x07E0F81F;
+        return static_cast<uint16_t>(pixel | (pixel >> 16));
+    }
+
+    template <int A, int R, int G, int B, bool Tint>
+    void BlendPremultipliedRowToRGB565(uint16_t *dst, const uint8_t *src, size_t rowLength, size_t srcStep, const Coloring &coloring, bool coloringOnly)
+    {
+        const uint8_t *tint = coloring.color.data;
+        for (size_t i = 0; i < rowLength; ++i, src += srcStep)
+        {
+            uint8_t alpha = coloringOnly ? 255 : src[A];
+            uint8_t r = src[R], g = src[G], b = src[B];
+            if (Tint)
+            {
+                r = (((r * tint[1]) >> 8) * tint[0]) >> 8;
+                g = (((g * tint[2]) >> 8) * tint[0]) >> 8;
+                b = (((b * tint[3]) >> 8) * tint[0]) >> 8;
+                alpha = (alpha * tint[0]) >> 8;
+            }
+            if (alpha == 0)
+                continue;
+
+            uint16_t srcPixel = static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+            if (alpha == 255)
+            {
+                dst[i] = srcPixel;
+                continue;
+            }
+
+            // the scaled destination keeps its fraction bits in the gaps of the spread layout,
+            // CompactRGB565 masks them, a channel of src is never larger than alpha so nothing carries
+            uint32_t inverseAlpha5 = 32 - ((alpha + 4) >> 3);
+            dst[i] = CompactRGB565(((ExpandRGB565(dst[i]) * inverseAlpha5) >> 5) + ExpandRGB565(srcPixel));
+        }
+    }
+
+    template <int A, int R, int G, int B>
+    void BlendPremultipliedRowToRGB565(uint16_t *dst, const uint8_t *src, size_t rowLength, size_t srcStep, const Coloring &coloring, bool coloringOnly)
+    {
+        if (coloring.colorEnabled && coloring.color.data[0] != 0)
+            BlendPremultipliedRowToRGB565<A, R, G, B, true>(dst, src, rowLength, srcStep, coloring, coloringOnly);
+        else
+            BlendPremultipliedRowToRGB565<A, R, G, B, false>(dst, src, rowLength, srcStep, coloring, coloringOnly);
+    }
+
+    // one kernel per (srcFactor, dstFactor, operation), indexed like GetBlendKernel
+    template <size_t... Index>
+    constexpr std::array<BlendKernel, sizeof...(Index)> MakeBlendKernelTable(std::index_sequence<Index...>)
+    {
+        return {{&BlendKernelARGB8888<static_cast<BlendFactor>(Index / (blendFactorCount * blendOperationCount)),
+                                      static_cast<BlendFactor>((Index / blendOperationCount) % blendFactorCount),
+                                      static_cast<BlendOperation>(Index % blendOperationCount)>...}};
+    }
+
+    constexpr auto blendKernelTable = MakeBlendKernelTable(std::make_index_sequence<blendFactorCount * blendFactorCount * blendOperationCount>());
+}
+
+void BlendFunctions::BlendPremultipliedToRGB565(uint8_t *dstRow,
+                                                const uint8_t *srcRow,
+                                                size_t rowLength,
+                                                const PixelFormatInfo &/*targetInfo*/,
+                                                const PixelFormatInfo &sourceInfo,
+                                                Coloring coloring,
+                                                bool useSolidColor,
+                                                BlendContext& context)
+{
+    uint16_t *dst = reinterpret_cast<uint16_t *>(dstRow);
+    bool coloringOnly = context.mode == BlendMode::COLORINGONLY;
+    size_t srcStep = useSolidColor ? 0 : 4;
+    if (sourceInfo.format == PixelFormat::RGBA8888_PRE)
+        BlendPremultipliedRowToRGB565<3, 0, 1, 2>(dst, srcRow, rowLength, srcStep, coloring, coloringOnly);
+    else
+        BlendPremultipliedRowToRGB565<0, 1, 2, 3>(dst, srcRow, rowLength, srcStep, coloring, coloringOnly);
+}
+
+// colour and alpha a mask is drawn with, the tint when it is enabled, opaque white otherwise
+static inline void GetMaskColor(const Coloring &coloring, uint8_t color[4])
+{
+    if (coloring.colorEnabled && coloring.color.data[0] != 0)
+    {
+        std::memcpy(color, coloring.color.data, 4);
+        return;
+    }
+    color[0] = color[1] = color[2] = color[3] = 255;
+}
+
+void BlendFunctions::BlendMaskToRGB565(uint8_t *dstRow,
+                                       const uint8_t *srcRow,
+                                       size_t rowLength,
+                                       const PixelFormatInfo &/*targetInfo*/,
+                                       const PixelFormatInfo &/*sourceInfo*/,
+                                       Coloring coloring,
+                                       bool useSolidColor,
+                                       BlendContext& context)
+{
+    uint16_t *dst = reinterpret_cast<uint16_t *>(dstRow);
+    bool coloringOnly = context.mode == BlendMode::COLORINGONLY;
+    size_t srcStep = useSolidColor ? 0 : 1;
+
+    uint8_t color[4];
+    GetMaskColor(coloring, color);
+    uint16_t srcPixel = static_cast<uint16_t>(((color[1] >> 3) << 11) | ((color[2] >> 2) << 5) | (color[3] >> 3));
+    uint32_t srcExpanded = ExpandRGB565(srcPixel);
+
+    for (size_t i = 0; i < rowLength; ++i, srcRow += srcStep)
+    {
+        uint8_t mask = coloringOnly ? 255 : *srcRow;
+        if (mask == 0)
+            continue;
+        // 255 * 255 + 255 stays 255, so a full mask in an opaque colour is a plain store
+        uint32_t alpha = (mask * color[0] + 255) >> 8;
+        if (alpha == 255)
+        {
+            dst[i] = srcPixel;
+            continue;
+        }
+        uint32_t dstExpanded = ExpandRGB565(dst[i]);
+        dst[i] = CompactRGB565(dstExpanded + (((srcExpanded - dstExpanded) * ((alpha + 4) >> 3)) >> 5));
+    }
+}
+
+void BlendFunctions::BlendMaskToRGB24(uint8_t *dstRow,
+                                      const uint8_t *srcRow,
+                                      size_t rowLength,
+                                      const PixelFormatInfo &targetInfo,
+                                      const PixelFormatInfo &/*sourceInfo*/,
+                                      Coloring coloring,
+                                      bool useSolidColor,
+                                      BlendContext& context)
+{
+    bool coloringOnly = context.mode == BlendMode::COLORINGONLY;
+    size_t srcStep = useSolidColor ? 0 : 1;
+
+    uint8_t color[4];
+    GetMaskColor(coloring, color);
+    int channels[3] = {color[1], color[2], color[3]};
+    if (targetInfo.format == PixelFormat::BGR24)
+        std::swap(channels[0], channels[2]);
+
+    for (size_t i = 0; i < rowLength; ++i, srcRow += srcStep, dstRow += 3)
+    {
+        uint8_t mask = coloringOnly ? 255 : *srcRow;
+        if (mask == 0)
+            continue;
+        int alpha = (mask * color[0] + 255) >> 8;
+        // 0-256 so an alpha of 255 gives the colour exactly
+        alpha += alpha >> 7;
+        dstRow[0] = static_cast<uint8_t>(dstRow[0] + (((channels[0] - dstRow[0]) * alpha) >> 8));
+        dstRow[1] = static_cast<uint8_t>(dstRow[1] + (((channels[1] - dstRow[1]) * alpha) >> 8));
+        dstRow[2] = static_cast<uint8_t>(dstRow[2] + (((channels[2] - dstRow[2]) * alpha) >> 8));
+    }
+}
+
+BlendKernel BlendFunctions::GetBlendKernel(const BlendContext &context)
+{
+    size_t srcFactor = static_cast<size_t>(context.colorBlendFactorSrc);
+    size_t dstFactor = static_cast<size_t>(context.colorBlendFactorDst);
+    size_t operation = static_cast<size_t>(context.colorBlendOperation);
+    if (srcFactor >= blendFactorCount || dstFactor >= blendFactorCount || operation >= blendOperationCount)
+    {
+        return GetBlendKernel(BlendContext());
+    }
+    return blendKernelTable[(srcFactor * blendFactorCount + dstFactor) * blendOperationCount + operation];
+}
+
 void BlendFunctions::BlendRow(uint8_t *dstRow,
                               const uint8_t *srcRow,
                               size_t rowLength,
@@ -18,7 +350,7 @@ void BlendFunctions::BlendRow(uint8_t *dstRow,
                               bool useSolidColor,
                               BlendContext& context)
 {
-    auto blendFunc = GetBlendFunc(targetInfo.format, useSolidColor);
+    auto blendFunc = GetBlendFunc(targetInfo.format, sourceInfo.format, useSolidColor, context);
 
     if (blendFunc != nullptr)
     {
@@ -26,183 +358,87 @@ void BlendFunctions::BlendRow(uint8_t *dstRow,
         return;
     }
 
-    // Get conversion functions once
-    PixelConverter::ConvertFunc convertToARGB8888 = nullptr;
-    PixelConverter::ConvertFunc convertFromARGB8888 = nullptr;
+    // premultiplied sources stay premultiplied for source over, other blending needs straight alpha
+    bool premultiplied = sourceInfo.isPremultiplied &&
+                         context.colorBlendFactorSrc == BlendFactor::SourceAlpha &&
+                         context.colorBlendFactorDst == BlendFactor::InverseSourceAlpha &&
+                         context.colorBlendOperation == BlendOperation::Add;
+    PixelFormat sourceLayout = premultiplied ? PixelFormat::ARGB8888_PRE : PixelFormat::ARGB8888;
 
-    convertToARGB8888 = PixelConverter::GetConversionFunction(sourceInfo.format, PixelFormat::ARGB8888);
-    convertFromARGB8888 = PixelConverter::GetConversionFunction(PixelFormat::ARGB8888, targetInfo.format);
-    if(!convertToARGB8888) {
-        return;
-    };
-    if(!convertFromARGB8888)  {
+    PixelConverter::ConvertFunc convertSource = PixelConverter::GetConversionFunction(sourceInfo.format, sourceLayout);
+    PixelConverter::ConvertFunc convertTarget = PixelConverter::GetConversionFunction(targetInfo.format, PixelFormat::ARGB8888);
+    PixelConverter::ConvertFunc convertBack = PixelConverter::GetConversionFunction(PixelFormat::ARGB8888, targetInfo.format);
+    if (!convertSource || !convertTarget || !convertBack)
+    {
         return;
-    };
-    // Temporary storage for conversion
-    alignas(16) uint8_t srcARGB8888[4];
-    alignas(16) uint8_t dstARGB8888[4];
+    }
+
+    BlendKernel kernel = premultiplied ? BlendKernelPremultipliedARGB8888 : context.kernel != nullptr ? context.kernel : GetBlendKernel(context);
 
-    for (size_t i = 0; i < rowLength; ++i)
+    // Temporary storage for conversion, rows are converted chunk wise
+    alignas(16) uint8_t srcARGB8888[BLENDCHUNKSIZE * 4];
+    alignas(16) uint8_t dstARGB8888[BLENDCHUNKSIZE * 4];
+
+    bool sourceIsARGB8888 = sourceInfo.format == sourceLayout;
+    bool targetIsARGB8888 = targetInfo.format == PixelFormat::ARGB8888;
+    size_t srcStep = 4;
+    if (useSolidColor)
     {
-        const uint8_t *srcPixel = srcRow + i * sourceInfo.bytesPerPixel;
-        uint8_t *dstPixel = dstRow + i * targetInfo.bytesPerPixel;
+        convertSource(srcRow, srcARGB8888, 1);
+        if (srcARGB8888[0] == 0)
+        {
+            return;
+        }
+        srcStep = 0;
+    }
 
-        // Convert source to ARGB8888
-        uint8_t srcAlpha;
+    for (size_t offset = 0; offset < rowLength; offset += BLENDCHUNKSIZE)
+    {
+        size_t count = std::min<size_t>(BLENDCHUNKSIZE, rowLength - offset);
+        uint8_t *dst = dstRow + offset * targetInfo.bytesPerPixel;
 
-        convertToARGB8888(srcPixel, srcARGB8888, 1);
-        srcAlpha = srcARGB8888[0];
+        const uint8_t *src = srcARGB8888;
+        if (!useSolidColor)
+        {
+            if (sourceIsARGB8888)
+            {
+                src = srcRow + offset * 4;
+            }
+            else
+            {
+                convertSource(srcRow + offset * sourceInfo.bitsPerPixel / 8, srcARGB8888, count);
+            }
+        }
 
-        if (srcAlpha == 0)
+        if (targetIsARGB8888)
         {
+            kernel(dst, src, count, srcStep, coloring);
             continue;
         }
 
-        if (convertToARGB8888)
-        {
-            convertToARGB8888(dstPixel, dstARGB8888, 1);
-        }
-        uint8_t colorFactor = coloring.colorEnabled ? coloring.color.data[0] : 0;
-
-
-        if(colorFactor){
-            srcARGB8888[1] = (srcARGB8888[1] * coloring.color.data[1]) >> 8;
-            srcARGB8888[2] = (srcARGB8888[2] * coloring.color.data[2]) >> 8;
-            srcARGB8888[3] = (srcARGB8888[3] * coloring.color.data[3]) >> 8;
-            srcAlpha = (srcAlpha * coloring.color.data[0]) >> 8;
-        }
-        uint8_t invAlpha = 255 - srcAlpha;
-
-        uint8_t srcFactorR, dstFactorR;
-        uint8_t srcFactorG, dstFactorG;
-        uint8_t srcFactorB, dstFactorB;
-
-        switch (context.colorBlendFactorSrc)
-        {
-        case BlendFactor::Zero:
-            srcFactorR = srcFactorG = srcFactorB = 0;
-            break;
-        case BlendFactor::One:
-            srcFactorR = srcFactorG = srcFactorB = 255;
-            break;
-        case BlendFactor::SourceAlpha:
-            srcFactorR = srcFactorG = srcFactorB = srcAlpha;
-            break;
-        case BlendFactor::InverseSourceAlpha:
-            srcFactorR = srcFactorG = srcFactorB = 255 - srcAlpha;
-            break;
-        case BlendFactor::DestAlpha:
-            srcFactorR = dstARGB8888[0];
-            srcFactorG = dstARGB8888[0];
-            srcFactorB = dstARGB8888[0];
-            break;
-        case BlendFactor::InverseDestAlpha:
-            srcFactorR = 255 - dstARGB8888[0];
-            srcFactorG = 255 - dstARGB8888[0];
-            srcFactorB = 255 - dstARGB8888[0];
-            break;
-        case BlendFactor::SourceColor:
-            srcFactorR = srcARGB8888[1];
-            srcFactorG = srcARGB8888[2];
-            srcFactorB = srcARGB8888[3];
-            break;
-        case BlendFactor::DestColor:
-            srcFactorR = dstARGB8888[1];
-            srcFactorG = dstARGB8888[2];
-            srcFactorB = dstARGB8888[3];
-            break;
-        case BlendFactor::InverseSourceColor:
-            srcFactorR = 255 - srcARGB8888[1];
-            srcFactorG = 255 - srcARGB8888[2];
-            srcFactorB = 255 - srcARGB8888[3];
-            break;
-        case BlendFactor::InverseDestColor:
-            srcFactorR = 255 - dstARGB8888[1];
-            srcFactorG = 255 - dstARGB8888[2];
-            srcFactorB = 255 - dstARGB8888[3];
-            break;
-        default:
-            srcFactorR = srcFactorG = srcFactorB = 255;
-            break;
-        }
-
-        switch (context.colorBlendFactorDst)
-        {
-        case BlendFactor::Zero:
-            dstFactorR = dstFactorG = dstFactorB = 0;
-            break;
-        case BlendFactor::One:
-            dstFactorR = dstFactorG = dstFactorB = 255;
-            break;
-        case BlendFactor::SourceAlpha:
-            dstFactorR = dstFactorG = dstFactorB = srcAlpha;
-            break;
-        case BlendFactor::InverseSourceAlpha:
-            dstFactorR = dstFactorG = dstFactorB = 255 - srcAlpha;
-            break;
-        case BlendFactor::DestAlpha:
-            dstFactorR = dstARGB8888[0];
-            dstFactorG = dstARGB8888[0];
-            dstFactorB = dstARGB8888[0];
-            break;
-        case BlendFactor::InverseDestAlpha:
-            dstFactorR = 255 - dstARGB8888[0];
-            dstFactorG = 255 - dstARGB8888[0];
-            dstFactorB = 255 - dstARGB8888[0];
-            break;
-        case BlendFactor::SourceColor:
-            dstFactorR = srcARGB8888[1];
-            dstFactorG = srcARGB8888[2];
-            dstFactorB = srcARGB8888[3];
-            break;
-        case BlendFactor::DestColor:
-            dstFactorR = dstARGB8888[1];
-            dstFactorG = dstARGB8888[2];
-            dstFactorB = dstARGB8888[3];
-            break;
-        case BlendFactor::InverseSourceColor:
-            dstFactorR = 255 - srcARGB8888[1];
-            dstFactorG = 255 - srcARGB8888[2];
-            dstFactorB = 255 - srcARGB8888[3];
-            break;
-        case BlendFactor::InverseDestColor:
-            dstFactorR = 255 - dstARGB8888[1];
-            dstFactorG = 255 - dstARGB8888[2];
-            dstFactorB = 255 - dstARGB8888[3];
-            break;
-        default:
-            dstFactorR = dstFactorG = dstFactorB = 255;
-            break;
-        }
-
-        switch (context.colorBlendOperation)
-        {
-            case BlendOperation::Add:
-                dstARGB8888[1] = (srcARGB8888[1] * srcFactorR + dstARGB8888[1] * dstFactorR) >> 8;
-                dstARGB8888[2] = (srcARGB8888[2] * srcFactorG + dstARGB8888[2] * dstFactorG) >> 8;
-                dstARGB8888[3] = (srcARGB8888[3] * srcFactorB + dstARGB8888[3] * dstFactorB) >> 8;
-                break;
-            case BlendOperation::Subtract:
-                dstARGB8888[1] = ((srcARGB8888[1] * srcFactorR - dstARGB8888[1] * dstFactorR) >> 8) < 0 ? 0 : (((srcARGB8888[1] * srcFactorR - dstARGB8888[1] * dstFactorR) >> 8) > 255 ? 255 : (srcARGB8888[1] * srcFactorR - dstARGB8888[1] * dstFactorR) >> 8);
-                dstARGB8888[2] = ((srcARGB8888[2] * srcFactorG - dstARGB8888[2] * dstFactorG) >> 8) < 0 ? 0 : (((srcARGB8888[2] * srcFactorG - dstARGB8888[2] * dstFactorG) >> 8) > 255 ? 255 : (srcARGB8888[2] * srcFactorG - dstARGB8888[2] * dstFactorG) >> 8);
-                dstARGB8888[3] = ((srcARGB8888[3] * srcFactorB - dstARGB8888[3] * dstFactorB) >> 8) < 0 ? 0 : (((srcARGB8888[3] * srcFactorB - dstARGB8888[3] * dstFactorB) >> 8) > 255 ? 255 : (srcARGB8888[3] * srcFactorB - dstARGB8888[3] * dstFactorB) >> 8);
-                break;
-            case BlendOperation::ReverseSubtract:
-                dstARGB8888[1] = ((dstARGB8888[1] * dstFactorR - srcARGB8888[1] * srcFactorR) >> 8) < 0 ? 0 : (((dstARGB8888[1] * dstFactorR - srcARGB8888[1] * srcFactorR) >> 8) > 255 ? 255 : (dstARGB8888[1] * dstFactorR - srcARGB8888[1] * srcFactorR) >> 8);
-                dstARGB8888[2] = ((dstARGB8888[2] * dstFactorG - srcARGB8888[2] * srcFactorG) >> 8) < 0 ? 0 : (((dstARGB8888[2] * dstFactorG - srcARGB8888[2] * srcFactorG) >> 8) > 255 ? 255 : (dstARGB8888[2] * dstFactorG - srcARGB8888[2] * srcFactorG) >> 8);
-                dstARGB8888[3] = ((dstARGB8888[3] * dstFactorB - srcARGB8888[3] * srcFactorB) >> 8) < 0 ? 0 : (((dstARGB8888[3] * dstFactorB - srcARGB8888[3] * srcFactorB) >> 8) > 255 ? 255 : (dstARGB8888[3] * dstFactorB - srcARGB8888[3] * srcFactorB) >> 8);
-                break;
-            default:
-                break;
-        }
-
-        // Use the maximum alpha
-        dstARGB8888[0] = std::max(srcAlpha, dstARGB8888[0]);
-
-        // Convert blended pixel back to target format
-        convertFromARGB8888(dstARGB8888, dstPixel, 1);
+        convertTarget(dst, dstARGB8888, count);
+        kernel(dstARGB8888, src, count, srcStep, coloring);
+
+        // only write back what was blended, the conversions are not lossless for every format
+        size_t i = 0;
+        while (i < count)
+        {
+            if (src[i * srcStep] == 0)
+            {
+                ++i;
+                continue;
+            }
+            size_t runEnd = i + 1;
+            while (runEnd < count && src[runEnd * srcStep] != 0)
+            {
+                ++runEnd;
+            }
+            convertBack(dstARGB8888 + i * 4, dst + i * targetInfo.bytesPerPixel, runEnd - i);
+            i = runEnd;
+        }
     }
 }
 
 
 
+
@@ -23,9 +23,37 @@ namespace Tergos2D
     class BlendFunctions
     {
     private:
-        static BlendFunc GetBlendFunc(PixelFormat format, bool useSolidColor)
+        // the RGB565 kernels only implement the default source over blending
+        static bool IsSourceOver(const BlendContext &context)
         {
-            switch (format)
+            return context.colorBlendFactorSrc == BlendFactor::SourceAlpha &&
+                   context.colorBlendFactorDst == BlendFactor::InverseSourceAlpha &&
+                   context.colorBlendOperation == BlendOperation::Add;
+        }
+
+        static BlendFunc GetBlendFunc(PixelFormat targetFormat, PixelFormat sourceFormat, bool useSolidColor, const BlendContext &context)
+        {
+            // A8 masks in the tint colour, A4 and A1 rows are unpacked to A8 by the renderers
+            if (sourceFormat == PixelFormat::A8)
+            {
+                if (!IsSourceOver(context))
+                    return nullptr;
+                if (targetFormat == PixelFormat::RGB565)
+                    return BlendMaskToRGB565;
+                if (targetFormat == PixelFormat::RGB24 || targetFormat == PixelFormat::BGR24)
+                    return BlendMaskToRGB24;
+                return nullptr;
+            }
+
+            // the row kernels below expect straight alpha, BlendRow handles premultiplied sources for other targets
+            if (PixelFormatRegistry::GetInfo(sourceFormat).isPremultiplied)
+            {
+                if (targetFormat == PixelFormat::RGB565 && IsSourceOver(context))
+                    return BlendPremultipliedToRGB565;
+                return nullptr;
+            }
+
+            switch (targetFormat)
             {
             case PixelFormat::RGB24:
                 if (useSolidColor)
@@ -35,6 +63,14 @@ namespace Tergos2D
                 if (useSolidColor)
                     return BlendSolidRowRGB24;
                 return BlendRGB24;
+            case PixelFormat::RGB565:
+                if (!IsSourceOver(context))
+                    return nullptr;
+                if (useSolidColor)
+                    return BlendSolidRowRGB565;
+                if (sourceFormat == PixelFormat::ARGB8888 || sourceFormat == PixelFormat::RGBA8888)
+                    return BlendRGBA32ToRGB565;
+                return BlendRGB565;
             default:
                 return nullptr;
             }
@@ -50,6 +86,9 @@ namespace Tergos2D
                              bool useSolidColor,
                              BlendContext& context);
 
+        // kernel specialised for the factors and operation of the context, used by BlendRow
+        static BlendKernel GetBlendKernel(const BlendContext &context);
+
         static void BlendRGB24(uint8_t *dstRow,
                                const uint8_t *srcRow,
                                size_t rowLength,
@@ -59,6 +98,7 @@ namespace Tergos2D
                                bool useSolidColor,
                                BlendContext& context);
 
+        // any source format onto RGB565, source over only
         static void BlendRGB565(uint8_t *dstRow,
                                 const uint8_t *srcRow,
                                 size_t rowLength,
@@ -67,6 +107,56 @@ namespace Tergos2D
                                 Coloring coloring,
                                 bool useSolidColor,
                                 BlendContext& context);
+
+        // ARGB8888 or RGBA8888 onto RGB565, source over only
+        static void BlendRGBA32ToRGB565(uint8_t *dstRow,
+                                        const uint8_t *srcRow,
+                                        size_t rowLength,
+                                        const PixelFormatInfo &targetInfo,
+                                        const PixelFormatInfo &sourceInfo,
+                                        Coloring coloring,
+                                        bool useSolidColor,
+                                        BlendContext& context);
+
+        // ARGB8888_PRE or RGBA8888_PRE onto RGB565 as dst = src + dst * (1 - alpha), source over only
+        static void BlendPremultipliedToRGB565(uint8_t *dstRow,
+                                               const uint8_t *srcRow,
+                                               size_t rowLength,
+                                               const PixelFormatInfo &targetInfo,
+                                               const PixelFormatInfo &sourceInfo,
+                                               Coloring coloring,
+                                               bool useSolidColor,
+                                               BlendContext& context);
+
+        // A8 mask drawn in the tint colour onto RGB565, white without tint, source over only
+        static void BlendMaskToRGB565(uint8_t *dstRow,
+                                      const uint8_t *srcRow,
+                                      size_t rowLength,
+                                      const PixelFormatInfo &targetInfo,
+                                      const PixelFormatInfo &sourceInfo,
+                                      Coloring coloring,
+                                      bool useSolidColor,
+                                      BlendContext& context);
+
+        // A8 mask drawn in the tint colour onto RGB24 or BGR24, white without tint, source over only
+        static void BlendMaskToRGB24(uint8_t *dstRow,
+                                     const uint8_t *srcRow,
+                                     size_t rowLength,
+                                     const PixelFormatInfo &targetInfo,
+                                     const PixelFormatInfo &sourceInfo,
+                                     Coloring coloring,
+                                     bool useSolidColor,
+                                     BlendContext& context);
+
+        // first pixel of srcRow blended over the whole RGB565 row, source over only
+        static void BlendSolidRowRGB565(uint8_t *dstRow,
+                                        const uint8_t *srcRow,
+                                        size_t rowLength,
+                                        const PixelFormatInfo &targetInfo,
+                                        const PixelFormatInfo &sourceInfo,
+                                        Coloring coloring,
+                                        bool useSolidColor,
+                                        BlendContext& context);
                                 
         // ONLY SOURCEALPHA, INVERSESOURCEALPHA, ADD ONE ZERO ADD
         static void BlendToRGB24Simple(uint8_t *dstRow,
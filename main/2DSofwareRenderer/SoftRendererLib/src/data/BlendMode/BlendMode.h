@@ -32,12 +32,22 @@ namespace Tergos2D
 
     enum class BlendOperation
     {
-        Add, // currently only add supported
+        Add,
         Subtract,
         ReverseSubtract,
-        BitwiseAnd,
+        BitwiseAnd, // (src * srcFactor) & (dst * dstFactor), both terms scaled to 8 bit first
     };
 
+    struct Coloring;
+
+    // blends count ARGB8888 source pixels onto count ARGB8888 destination pixels,
+    // srcStep is 4 for a source row and 0 for a single solid color
+    using BlendKernel = void (*)(uint8_t *dstARGB8888,
+                                 const uint8_t *srcARGB8888,
+                                 size_t count,
+                                 size_t srcStep,
+                                 const Coloring &coloring);
+
     struct BlendContext
     {
         BlendMode mode = BlendMode::BLEND;
@@ -48,6 +58,10 @@ namespace Tergos2D
         BlendFactor alphaBlendFactorSrc = BlendFactor::One;
         BlendFactor alphaBlendFactorDst = BlendFactor::Zero;
         BlendOperation alphaBlendOperation = BlendOperation::Add;
+
+        // resolved from the factors and operation by RenderContext2D::SetBlendContext,
+        // BlendRow resolves it on every call while it is nullptr
+        BlendKernel kernel = nullptr;
     };
 
     struct Coloring
@@ -56,7 +56,7 @@ void BlendFunctions::BlendSolidRowRGB24(uint8_t * dstRow,
         src_neon.val[0] = vshrn_n_u16(vmull_u8(src_neon.val[0], color_r), 8);
         src_neon.val[1] = vshrn_n_u16(vmull_u8(src_neon.val[1], color_g), 8);
         src_neon.val[2] = vshrn_n_u16(vmull_u8(src_neon.val[2], color_b), 8);
-        alpha = (alpha * colorDataAsRGB[2]) >> 8;
+        alpha = (alpha * colorFactor) >> 8;
     }
 
     // Create NEON vectors for blend factors
@@ -231,6 +231,15 @@ void BlendFunctions::BlendSolidRowRGB24(uint8_t * dstRow,
             vst3_u8(&dstRow[i], result_neon);
             break;
         }
+        case BlendOperation::BitwiseAnd: {
+            result_neon.val[0] = vand_u8(vshrn_n_u16(vmull_u8(src_neon.val[0], src_factor.val[0]), 8),
+                vshrn_n_u16(vmull_u8(dst_neon.val[0], dst_factor.val[0]), 8));
+            result_neon.val[1] = vand_u8(vshrn_n_u16(vmull_u8(src_neon.val[1], src_factor.val[1]), 8),
+                vshrn_n_u16(vmull_u8(dst_neon.val[1], dst_factor.val[1]), 8));
+            result_neon.val[2] = vand_u8(vshrn_n_u16(vmull_u8(src_neon.val[2], src_factor.val[2]), 8),
+                vshrn_n_u16(vmull_u8(dst_neon.val[2], dst_factor.val[2]), 8));
+            break;
+        }
         default:
             result_neon = dst_neon;
             break;
@@ -374,6 +383,11 @@ void BlendFunctions::BlendSolidRowRGB24(uint8_t * dstRow,
             dstRow[i + 2] = tempB < 0 ? 0 : (tempB > 255 ? 255 : tempB);
             break;
         }
+        case BlendOperation::BitwiseAnd:
+            dstRow[i] = ((srcRGB24[0] * srcFactorR) >> 8) & ((dstRow[i] * dstFactorR) >> 8);
+            dstRow[i + 1] = ((srcRGB24[1] * srcFactorG) >> 8) & ((dstRow[i + 1] * dstFactorG) >> 8);
+            dstRow[i + 2] = ((srcRGB24[2] * srcFactorB) >> 8) & ((dstRow[i + 2] * dstFactorB) >> 8);
+            break;
         default:
             break;
         }
@@ -742,6 +756,17 @@ void BlendFunctions::BlendRGB24(uint8_t* dstRow,
                 ));
                 break;
             }
+            case BlendOperation::BitwiseAnd: {
+                dst_rgb.val[0] = vand_u8(vshrn_n_u16(vmull_u8(src_rgb.val[0], src_factor_r), 8),
+                    vshrn_n_u16(vmull_u8(dst_rgb.val[0], dst_factor_r), 8));
+                dst_rgb.val[1] = vand_u8(vshrn_n_u16(vmull_u8(src_rgb.val[1], src_factor_g), 8),
+                    vshrn_n_u16(vmull_u8(dst_rgb.val[1], dst_factor_g), 8));
+                dst_rgb.val[2] = vand_u8(vshrn_n_u16(vmull_u8(src_rgb.val[2], src_factor_b), 8),
+                    vshrn_n_u16(vmull_u8(dst_rgb.val[2], dst_factor_b), 8));
+                break;
+            }
+            default:
+                break;
         }
 
         // Store results
@@ -912,6 +937,11 @@ void BlendFunctions::BlendRGB24(uint8_t* dstRow,
                 dstPixel[1] = ((dstPixel[1] * dstFactorG - srcColor[1] * srcFactorG) >> 8) < 0 ? 0 : (((dstPixel[1] * dstFactorG - srcColor[1] * srcFactorG) >> 8) > 255 ? 255 : (dstPixel[1] * dstFactorG - srcColor[1] * srcFactorG) >> 8);
                 dstPixel[2] = ((dstPixel[2] * dstFactorB - srcColor[2] * srcFactorB) >> 8) < 0 ? 0 : (((dstPixel[2] * dstFactorB - srcColor[2] * srcFactorB) >> 8) > 255 ? 255 : (dstPixel[2] * dstFactorB - srcColor[2] * srcFactorB) >> 8);
                 break;
+            case BlendOperation::BitwiseAnd:
+                dstPixel[0] = ((srcColor[0] * srcFactorR) >> 8) & ((dstPixel[0] * dstFactorR) >> 8);
+                dstPixel[1] = ((srcColor[1] * srcFactorG) >> 8) & ((dstPixel[1] * dstFactorG) >> 8);
+                dstPixel[2] = ((srcColor[2] * srcFactorB) >> 8) & ((dstPixel[2] * dstFactorB) >> 8);
+                break;
             default:
                 break;
         }
@@ -1117,6 +1147,15 @@ void BlendFunctions::BlendRGBA32ToRGB24(uint8_t * dstRow,
             ));
             break;
         }
+        case BlendOperation::BitwiseAnd: {
+            result.val[0] = vand_u8(vshrn_n_u16(vmull_u8(src_rgb.val[0], src_factor.val[0]), 8),
+                vshrn_n_u16(vmull_u8(dst_rgb.val[0], dst_factor.val[0]), 8));
+            result.val[1] = vand_u8(vshrn_n_u16(vmull_u8(src_rgb.val[1], src_factor.val[1]), 8),
+                vshrn_n_u16(vmull_u8(dst_rgb.val[1], dst_factor.val[1]), 8));
+            result.val[2] = vand_u8(vshrn_n_u16(vmull_u8(src_rgb.val[2], src_factor.val[2]), 8),
+                vshrn_n_u16(vmull_u8(dst_rgb.val[2], dst_factor.val[2]), 8));
+            break;
+        }
         default:
             result = dst_rgb;
             break;
@@ -1262,8 +1301,190 @@ void BlendFunctions::BlendRGBA32ToRGB24(uint8_t * dstRow,
             dstPixel[2] = tempB < 0 ? 0 : (tempB > 255 ? 255 : tempB);
             break;
         }
+        case BlendOperation::BitwiseAnd:
+            dstPixel[0] = ((srcColor[0] * srcFactorR) >> 8) & ((dstPixel[0] * dstFactorR) >> 8);
+            dstPixel[1] = ((srcColor[1] * srcFactorG) >> 8) & ((dstPixel[1] * dstFactorG) >> 8);
+            dstPixel[2] = ((srcColor[2] * srcFactorB) >> 8) & ((dstPixel[2] * dstFactorB) >> 8);
+            break;
         default:
             break;
         }
     }
-}
\ No newline at end of file
+}
+// RGB565 kernels, source over only. Channels are blended in their native 5/6 bit range with
+// a 5 bit alpha (0-32): dst + ((src - dst) * alpha >> 5), bit exact with the generic backend
+static inline uint16_t BlendPixelRGB565(uint16_t src, uint16_t dst, int alpha5)
+{
+    int sr = src >> 11, sg = (src >> 5) & 0x3F, sb = src & 0x1F;
+    int dr = dst >> 11, dg = (dst >> 5) & 0x3F, db = dst & 0x1F;
+    dr += ((sr - dr) * alpha5) >> 5;
+    dg += ((sg - dg) * alpha5) >> 5;
+    db += ((sb - db) * alpha5) >> 5;
+    return static_cast<uint16_t>((dr << 11) | (dg << 5) | db);
+}
+
+static inline uint16x8_t BlendRGB565x8(uint16x8_t dst, int16x8_t sr, int16x8_t sg, int16x8_t sb, int16x8_t alpha5)
+{
+    int16x8_t dr = vreinterpretq_s16_u16(vshrq_n_u16(dst, 11));
+    int16x8_t dg = vreinterpretq_s16_u16(vandq_u16(vshrq_n_u16(dst, 5), vdupq_n_u16(0x3F)));
+    int16x8_t db = vreinterpretq_s16_u16(vandq_u16(dst, vdupq_n_u16(0x1F)));
+
+    dr = vaddq_s16(dr, vshrq_n_s16(vmulq_s16(vsubq_s16(sr, dr), alpha5), 5));
+    dg = vaddq_s16(dg, vshrq_n_s16(vmulq_s16(vsubq_s16(sg, dg), alpha5), 5));
+    db = vaddq_s16(db, vshrq_n_s16(vmulq_s16(vsubq_s16(sb, db), alpha5), 5));
+
+    return vorrq_u16(vshlq_n_u16(vreinterpretq_u16_s16(dr), 11),
+                     vorrq_u16(vshlq_n_u16(vreinterpretq_u16_s16(dg), 5), vreinterpretq_u16_s16(db)));
+}
+
+// a, r, g, b are the channel offsets inside the 32 bit source pixel
+static void BlendRGBA32RowToRGB565(uint16_t *dst, const uint8_t *src, size_t rowLength,
+                                   int a, int r, int g, int b, const Coloring &coloring, bool coloringOnly)
+{
+    bool tint = coloring.colorEnabled && coloring.color.data[0] != 0;
+    const uint8_t *tintColor = coloring.color.data;
+    const uint8x8_t vec_255 = vdup_n_u8(255);
+
+    size_t vectorized_length = (rowLength / 8) * 8;
+    size_t i = 0;
+    for (; i < vectorized_length; i += 8)
+    {
+        uint8x8x4_t px = vld4_u8(src + i * 4);
+        uint8x8_t alpha = coloringOnly ? vec_255 : px.val[a];
+        uint8x8_t red = px.val[r];
+        uint8x8_t green = px.val[g];
+        uint8x8_t blue = px.val[b];
+
+        if (tint)
+        {
+            red = vshrn_n_u16(vmull_u8(red, vdup_n_u8(tintColor[1])), 8);
+            green = vshrn_n_u16(vmull_u8(green, vdup_n_u8(tintColor[2])), 8);
+            blue = vshrn_n_u16(vmull_u8(blue, vdup_n_u8(tintColor[3])), 8);
+            alpha = vshrn_n_u16(vmull_u8(alpha, vdup_n_u8(tintColor[0])), 8);
+        }
+
+        int16x8_t sr = vreinterpretq_s16_u16(vmovl_u8(vshr_n_u8(red, 3)));
+        int16x8_t sg = vreinterpretq_s16_u16(vmovl_u8(vshr_n_u8(green, 2)));
+        int16x8_t sb = vreinterpretq_s16_u16(vmovl_u8(vshr_n_u8(blue, 3)));
+        int16x8_t alpha5 = vreinterpretq_s16_u16(vshrq_n_u16(vaddq_u16(vmovl_u8(alpha), vdupq_n_u16(4)), 3));
+
+        vst1q_u16(dst + i, BlendRGB565x8(vld1q_u16(dst + i), sr, sg, sb, alpha5));
+    }
+
+    // Handle remaining pixels
+    for (; i < rowLength; ++i)
+    {
+        const uint8_t *pixel = src + i * 4;
+        uint8_t alpha = coloringOnly ? 255 : pixel[a];
+        uint8_t red = pixel[r], green = pixel[g], blue = pixel[b];
+        if (tint)
+        {
+            red = (red * tintColor[1]) >> 8;
+            green = (green * tintColor[2]) >> 8;
+            blue = (blue * tintColor[3]) >> 8;
+            alpha = (alpha * tintColor[0]) >> 8;
+        }
+        uint16_t srcPixel = static_cast<uint16_t>(((red >> 3) << 11) | ((green >> 2) << 5) | (blue >> 3));
+        dst[i] = BlendPixelRGB565(srcPixel, dst[i], (alpha + 4) >> 3);
+    }
+}
+
+void BlendFunctions::BlendRGBA32ToRGB565(uint8_t *dstRow,
+    const uint8_t *srcRow,
+        size_t rowLength,
+        const PixelFormatInfo &/*targetInfo*/,
+            const PixelFormatInfo &sourceInfo,
+                Coloring coloring,
+                bool /*useSolidColor*/,
+                BlendContext &context) {
+    uint16_t *dst = reinterpret_cast<uint16_t *>(dstRow);
+    bool coloringOnly = context.mode == BlendMode::COLORINGONLY;
+    if (sourceInfo.format == PixelFormat::RGBA8888)
+        BlendRGBA32RowToRGB565(dst, srcRow, rowLength, 3, 0, 1, 2, coloring, coloringOnly);
+    else
+        BlendRGBA32RowToRGB565(dst, srcRow, rowLength, 0, 1, 2, 3, coloring, coloringOnly);
+}
+
+void BlendFunctions::BlendRGB565(uint8_t *dstRow,
+    const uint8_t *srcRow,
+        size_t rowLength,
+        const PixelFormatInfo &/*targetInfo*/,
+            const PixelFormatInfo &sourceInfo,
+                Coloring coloring,
+                bool /*useSolidColor*/,
+                BlendContext &context) {
+    PixelConverter::ConvertFunc convertToARGB8888 = PixelConverter::GetConversionFunction(sourceInfo.format, PixelFormat::ARGB8888);
+    if (!convertToARGB8888)
+        return;
+
+    const size_t chunkSize = 256;
+    alignas(16) uint8_t srcARGB8888[chunkSize * 4];
+    uint16_t *dst = reinterpret_cast<uint16_t *>(dstRow);
+    bool coloringOnly = context.mode == BlendMode::COLORINGONLY;
+
+    for (size_t offset = 0; offset < rowLength; offset += chunkSize)
+    {
+        size_t count = std::min(chunkSize, rowLength - offset);
+        const uint8_t *src = srcRow + offset * sourceInfo.bytesPerPixel;
+        convertToARGB8888(src, srcARGB8888, count);
+
+        // grayscale is used as a mask, black is transparent
+        if (sourceInfo.format == PixelFormat::GRAYSCALE8)
+        {
+            for (size_t i = 0; i < count; ++i)
+                srcARGB8888[i * 4] = src[i] == 0 ? 0 : 255;
+        }
+        BlendRGBA32RowToRGB565(dst + offset, srcARGB8888, count, 0, 1, 2, 3, coloring, coloringOnly);
+    }
+}
+
+void BlendFunctions::BlendSolidRowRGB565(uint8_t *dstRow,
+    const uint8_t *srcRow,
+        size_t rowLength,
+        const PixelFormatInfo &/*targetInfo*/,
+            const PixelFormatInfo &sourceInfo,
+                Coloring coloring,
+                bool /*useSolidColor*/,
+                BlendContext &context) {
+    alignas(16) uint8_t color[4];
+    PixelConverter::Convert(sourceInfo.format, PixelFormat::ARGB8888, srcRow, color, 1);
+
+    uint8_t alpha = context.mode == BlendMode::COLORINGONLY ? 255 : color[0];
+    if (coloring.colorEnabled && coloring.color.data[0] != 0)
+    {
+        color[1] = (color[1] * coloring.color.data[1]) >> 8;
+        color[2] = (color[2] * coloring.color.data[2]) >> 8;
+        color[3] = (color[3] * coloring.color.data[3]) >> 8;
+        alpha = (alpha * coloring.color.data[0]) >> 8;
+    }
+    if (alpha == 0)
+        return;
+
+    uint16_t srcPixel = static_cast<uint16_t>(((color[1] >> 3) << 11) | ((color[2] >> 2) << 5) | (color[3] >> 3));
+    uint16_t *dst = reinterpret_cast<uint16_t *>(dstRow);
+    size_t vectorized_length = (rowLength / 8) * 8;
+    size_t i = 0;
+
+    if (alpha == 255)
+    {
+        uint16x8_t fill = vdupq_n_u16(srcPixel);
+        for (; i < vectorized_length; i += 8)
+            vst1q_u16(dst + i, fill);
+        for (; i < rowLength; ++i)
+            dst[i] = srcPixel;
+        return;
+    }
+
+    int alpha5 = (alpha + 4) >> 3;
+    int16x8_t sr = vdupq_n_s16(srcPixel >> 11);
+    int16x8_t sg = vdupq_n_s16((srcPixel >> 5) & 0x3F);
+    int16x8_t sb = vdupq_n_s16(srcPixel & 0x1F);
+    int16x8_t alpha5_vec = vdupq_n_s16(alpha5);
+
+    for (; i < vectorized_length; i += 8)
+        vst1q_u16(dst + i, BlendRGB565x8(vld1q_u16(dst + i), sr, sg, sb, alpha5_vec));
+
+    // Handle remaining pixels
+    for (; i < rowLength; ++i)
+        dst[i] = BlendPixelRGB565(srcPixel, dst[i], alpha5);
+}
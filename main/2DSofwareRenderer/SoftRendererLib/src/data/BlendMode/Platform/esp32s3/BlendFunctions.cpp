@@ -0,0 +1,246 @@
+#include "../../BlendMode.h"
+#include "../../BlendFunctions.h"
+#include "../../../PixelFormat/PixelConverter.h"
+#include "../../../PixelFormat/PixelFormatInfo.h"
+#include <algorithm>
+
+using namespace Tergos2D;
+
+// ESP32-S3 PIE versions of the RGB565 source over kernels for ARGB8888/RGBA8888 rows and solid
+// colors, everything else comes from Platform/generic.
+//
+// The generic kernels blend in the spread 0x07E0F81F layout, per channel that is exactly
+// (src * a5 + dst * (32 - a5)) >> 5 with a5 = (alpha + 4) >> 3. a5 is 0 for alpha 0 and 32 for
+// alpha 255, so skipping and copying need no special case. The source is packed in a scalar pass,
+// the blend runs on 8 RGB565 lanes at a time. Without USE_ESP32S3_PIE the lanes are blended in
+// plain C with the same arithmetic, which keeps host builds bit exact with the device.
+
+#define PIECHUNKSIZE 64
+
+static inline uint16_t PackRGB565(uint8_t r, uint8_t g, uint8_t b)
+{
+    return static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+static inline uint16_t BlendLaneRGB565(uint16_t src, uint16_t dst, uint16_t alpha5, uint16_t inverseAlpha5)
+{
+    uint16_t r = ((src >> 11) * alpha5 + (dst >> 11) * inverseAlpha5) >> 5;
+    uint16_t g = (((src >> 5) & 0x3F) * alpha5 + ((dst >> 5) & 0x3F) * inverseAlpha5) >> 5;
+    uint16_t b = ((src & 0x1F) * alpha5 + (dst & 0x1F) * inverseAlpha5) >> 5;
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+#ifdef USE_ESP32S3_PIE
+// lane constants for ee.vldbc.16
+static const uint16_t laneOne = 1;
+static const uint16_t laneMask5 = 0x1F;
+static const uint16_t laneMask6 = 0x3F;
+static const uint16_t laneShift5 = 1 << 5;
+static const uint16_t laneShift11 = 1 << 11;
+#endif
+
+// blends count pixels, the lane arrays are 16 byte aligned and dst only takes the PIE path when it is too
+static void BlendSpanRGB565(uint16_t *dst, const uint16_t *src, const uint16_t *alpha5, const uint16_t *inverseAlpha5, size_t count)
+{
+    size_t blocks = (reinterpret_cast<uintptr_t>(dst) & 15) ? 0 : count / 8;
+#ifdef USE_ESP32S3_PIE
+    // ee.vmul.u16 stores (x * y) >> SAR, multiplying by 1 is used for the logical right shifts
+    uint16_t *to = dst;
+    const uint16_t *from = src;
+    const uint16_t *alpha = alpha5;
+    const uint16_t *inverse = inverseAlpha5;
+    size_t remaining = blocks;
+    asm volatile(
+        "beqz %[remaining], 2f\n"
+        "1:\n"
+        "ee.vld.128.ip q1, %[from], 16\n"
+        "ee.vld.128.ip q2, %[alpha], 16\n"
+        "ee.vld.128.ip q3, %[inverse], 16\n"
+        "ee.vld.128.ip q0, %[to], 0\n"
+        // blue
+        "ee.vldbc.16 q7, %[mask5]\n"
+        "ee.andq q5, q1, q7\n"
+        "ee.andq q6, q0, q7\n"
+        "ssai 0\n"
+        "ee.vmul.u16 q5, q5, q2\n"
+        "ee.vmul.u16 q6, q6, q3\n"
+        "ee.vadds.s16 q5, q5, q6\n"
+        "ee.vldbc.16 q7, %[one]\n"
+        "ssai 5\n"
+        "ee.vmul.u16 q4, q5, q7\n"
+        // green
+        "ee.vmul.u16 q5, q1, q7\n"
+        "ee.vmul.u16 q6, q0, q7\n"
+        "ee.vldbc.16 q7, %[mask6]\n"
+        "ee.andq q5, q5, q7\n"
+        "ee.andq q6, q6, q7\n"
+        "ssai 0\n"
+        "ee.vmul.u16 q5, q5, q2\n"
+        "ee.vmul.u16 q6, q6, q3\n"
+        "ee.vadds.s16 q5, q5, q6\n"
+        "ee.vldbc.16 q7, %[one]\n"
+        "ssai 5\n"
+        "ee.vmul.u16 q5, q5, q7\n"
+        "ee.vldbc.16 q7, %[shift5]\n"
+        "ssai 0\n"
+        "ee.vmul.u16 q5, q5, q7\n"
+        "ee.orq q4, q4, q5\n"
+        // red
+        "ee.vldbc.16 q7, %[one]\n"
+        "ssai 11\n"
+        "ee.vmul.u16 q5, q1, q7\n"
+        "ee.vmul.u16 q6, q0, q7\n"
+        "ssai 0\n"
+        "ee.vmul.u16 q5, q5, q2\n"
+        "ee.vmul.u16 q6, q6, q3\n"
+        "ee.vadds.s16 q5, q5, q6\n"
+        "ssai 5\n"
+        "ee.vmul.u16 q5, q5, q7\n"
+        "ee.vldbc.16 q7, %[shift11]\n"
+        "ssai 0\n"
+        "ee.vmul.u16 q5, q5, q7\n"
+        "ee.orq q4, q4, q5\n"
+        "ee.vst.128.ip q4, %[to], 16\n"
+        "addi %[remaining], %[remaining], -1\n"
+        "bnez %[remaining], 1b\n"
+        "2:\n"
+        : [to] "+r"(to), [from] "+r"(from), [alpha] "+r"(alpha), [inverse] "+r"(inverse), [remaining] "+r"(remaining)
+        : [one] "r"(&laneOne), [mask5] "r"(&laneMask5), [mask6] "r"(&laneMask6),
+          [shift5] "r"(&laneShift5), [shift11] "r"(&laneShift11)
+        // ssai rewrites the shift amount register the compiler also uses for its own shifts
+        : "sar", "memory");
+#else
+    for (size_t i = 0; i < blocks * 8; ++i)
+    {
+        dst[i] = BlendLaneRGB565(src[i], dst[i], alpha5[i], inverseAlpha5[i]);
+    }
+#endif
+
+    for (size_t i = blocks * 8; i < count; ++i)
+    {
+        dst[i] = BlendLaneRGB565(src[i], dst[i], alpha5[i], inverseAlpha5[i]);
+    }
+}
+
+// pixels until dst sits on a 16 byte boundary, the PIE loads and stores ignore the low address bits
+static inline size_t HeadPixels(const uint16_t *dst, size_t count)
+{
+    size_t misalignment = reinterpret_cast<uintptr_t>(dst) & 15;
+    return std::min(count, ((16 - misalignment) & 15) / 2);
+}
+
+// packs the source pixels and their 5 bit alpha, channel offsets as in the generic kernel
+template <int A, int R, int G, int B, bool Tint>
+static void PrepareRGBA32(const uint8_t *src, size_t count, const Coloring &coloring, bool coloringOnly,
+                          uint16_t *packed, uint16_t *alpha5, uint16_t *inverseAlpha5)
+{
+    const uint8_t *tint = coloring.color.data;
+    for (size_t i = 0; i < count; ++i, src += 4)
+    {
+        uint8_t alpha = coloringOnly ? 255 : src[A];
+        uint8_t r = src[R], g = src[G], b = src[B];
+        if (Tint)
+        {
+            r = (r * tint[1]) >> 8;
+            g = (g * tint[2]) >> 8;
+            b = (b * tint[3]) >> 8;
+            alpha = (alpha * tint[0]) >> 8;
+        }
+        packed[i] = PackRGB565(r, g, b);
+        alpha5[i] = (alpha + 4) >> 3;
+        inverseAlpha5[i] = 32 - alpha5[i];
+    }
+}
+
+template <int A, int R, int G, int B, bool Tint>
+static void BlendRGBA32RowToRGB565(uint16_t *dst, const uint8_t *src, size_t rowLength, const Coloring &coloring, bool coloringOnly)
+{
+    alignas(16) uint16_t packed[PIECHUNKSIZE];
+    alignas(16) uint16_t alpha5[PIECHUNKSIZE];
+    alignas(16) uint16_t inverseAlpha5[PIECHUNKSIZE];
+
+    // the unaligned head is blended on its own so the following chunks start aligned
+    size_t head = HeadPixels(dst, rowLength);
+    size_t offset = 0;
+    while (offset < rowLength)
+    {
+        size_t count = offset == 0 && head != 0 ? head : std::min<size_t>(PIECHUNKSIZE, rowLength - offset);
+        PrepareRGBA32<A, R, G, B, Tint>(src + offset * 4, count, coloring, coloringOnly, packed, alpha5, inverseAlpha5);
+        BlendSpanRGB565(dst + offset, packed, alpha5, inverseAlpha5, count);
+        offset += count;
+    }
+}
+
+template <int A, int R, int G, int B>
+static void BlendRGBA32RowToRGB565(uint16_t *dst, const uint8_t *src, size_t rowLength, const Coloring &coloring, bool coloringOnly)
+{
+    if (coloring.colorEnabled && coloring.color.data[0] != 0)
+        BlendRGBA32RowToRGB565<A, R, G, B, true>(dst, src, rowLength, coloring, coloringOnly);
+    else
+        BlendRGBA32RowToRGB565<A, R, G, B, false>(dst, src, rowLength, coloring, coloringOnly);
+}
+
+void BlendFunctions::BlendRGBA32ToRGB565(uint8_t *dstRow,
+                                         const uint8_t *srcRow,
+                                         size_t rowLength,
+                                         const PixelFormatInfo &/*targetInfo*/,
+                                         const PixelFormatInfo &sourceInfo,
+                                         Coloring coloring,
+                                         bool /*useSolidColor*/,
+                                         BlendContext& context)
+{
+    uint16_t *dst = reinterpret_cast<uint16_t *>(dstRow);
+    bool coloringOnly = context.mode == BlendMode::COLORINGONLY;
+    if (sourceInfo.format == PixelFormat::RGBA8888)
+        BlendRGBA32RowToRGB565<3, 0, 1, 2>(dst, srcRow, rowLength, coloring, coloringOnly);
+    else
+        BlendRGBA32RowToRGB565<0, 1, 2, 3>(dst, srcRow, rowLength, coloring, coloringOnly);
+}
+
+void BlendFunctions::BlendSolidRowRGB565(uint8_t *dstRow,
+                                         const uint8_t *srcRow,
+                                         size_t rowLength,
+                                         const PixelFormatInfo &/*targetInfo*/,
+                                         const PixelFormatInfo &sourceInfo,
+                                         Coloring coloring,
+                                         bool /*useSolidColor*/,
+                                         BlendContext& context)
+{
+    alignas(16) uint8_t color[4];
+    PixelConverter::Convert(sourceInfo.format, PixelFormat::ARGB8888, srcRow, color, 1);
+
+    uint8_t alpha = context.mode == BlendMode::COLORINGONLY ? 255 : color[0];
+    if (coloring.colorEnabled && coloring.color.data[0] != 0)
+    {
+        color[1] = (color[1] * coloring.color.data[1]) >> 8;
+        color[2] = (color[2] * coloring.color.data[2]) >> 8;
+        color[3] = (color[3] * coloring.color.data[3]) >> 8;
+        alpha = (alpha * coloring.color.data[0]) >> 8;
+    }
+    if (alpha == 0)
+        return;
+
+    uint16_t srcPixel = PackRGB565(color[1], color[2], color[3]);
+    if (alpha == 255)
+    {
+        PixelConverter::Fill(dstRow, reinterpret_cast<const uint8_t *>(&srcPixel), rowLength, 2);
+        return;
+    }
+
+    alignas(16) uint16_t packed[PIECHUNKSIZE];
+    alignas(16) uint16_t alpha5[PIECHUNKSIZE];
+    alignas(16) uint16_t inverseAlpha5[PIECHUNKSIZE];
+    std::fill_n(packed, PIECHUNKSIZE, srcPixel);
+    std::fill_n(alpha5, PIECHUNKSIZE, static_cast<uint16_t>((alpha + 4) >> 3));
+    std::fill_n(inverseAlpha5, PIECHUNKSIZE, static_cast<uint16_t>(32 - alpha5[0]));
+
+    uint16_t *dst = reinterpret_cast<uint16_t *>(dstRow);
+    size_t head = HeadPixels(dst, rowLength);
+    size_t offset = 0;
+    while (offset < rowLength)
+    {
+        size_t count = offset == 0 && head != 0 ? head : std::min<size_t>(PIECHUNKSIZE, rowLength - offset);
+        BlendSpanRGB565(dst + offset, packed, alpha5, inverseAlpha5, count);
+        offset += count;
+    }
+}
@@ -62,100 +62,166 @@ void BlendFunctions::BlendToRGB24Simple(uint8_t *dstRow,
 }
 
 
-void BlendFunctions::BlendRGB565(uint8_t *dstRow,
-                                 const uint8_t *srcRow,
-                                 size_t rowLength,
-                                 const PixelFormatInfo &targetInfo,
-                                 const PixelFormatInfo &sourceInfo,
-                                 Coloring coloring,
-                                 bool useSolidColor,
-                                 BlendContext& context)
-        {
-        PixelConverter::ConvertFunc convertToRGB565 = PixelConverter::GetConversionFunction(sourceInfo.format, PixelFormat::RGB565);
-        PixelConverter::ConvertFunc convertColorToRGB565 = PixelConverter::GetConversionFunction(PixelFormat::ARGB8888, PixelFormat::RGB565);
+// RGB565 pixels are spread to 0b00000GGGGGG00000RRRRR000000BBBBB so all three channels
+// can be blended with a single multiply by a 5 bit alpha (0-32)
+static inline uint32_t ExpandRGB565(uint16_t pixel)
+{
+    return (pixel | (static_cast<uint32_t>(pixel) << 16)) & 0x07E0F81F;
+}
 
-        // Temporary storage for source pixel in RGB565
-        alignas(16) uint16_t srcRGB565[1024];
-        alignas(16) uint16_t colorDataAsRGB565;
+static inline uint16_t CompactRGB565(uint32_t pixel)
+{
+    pixel &= 0x07E0F81F;
+    return static_cast<uint16_t>(pixel | (pixel >> 16));
+}
 
-        convertToRGB565(srcRow, reinterpret_cast<uint8_t*>(srcRGB565), rowLength);
+static inline uint16_t BlendPixelRGB565(uint32_t srcExpanded, uint16_t dst, uint32_t alpha5)
+{
+    uint32_t dstExpanded = ExpandRGB565(dst);
+    return CompactRGB565(dstExpanded + (((srcExpanded - dstExpanded) * alpha5) >> 5));
+}
 
-        const uint8_t *srcPixel = srcRow;
-        uint16_t *dstPixel = reinterpret_cast<uint16_t*>(dstRow);
+static inline uint16_t PackRGB565(uint8_t r, uint8_t g, uint8_t b)
+{
+    return static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
 
-        uint8_t colorFactor = coloring.colorEnabled * coloring.color.data[0];
-        uint8_t inverseColorFactor = 255 - colorFactor;
+// channel offsets are template arguments so ARGB8888 and RGBA8888 share one branch free loop
+template <int A, int R, int G, int B, bool Tint>
+static void BlendRGBA32RowToRGB565(uint16_t *dst, const uint8_t *src, size_t rowLength, const Coloring &coloring, bool coloringOnly)
+{
+    const uint8_t *tint = coloring.color.data;
+    for (size_t i = 0; i < rowLength; ++i, src += 4)
+    {
+        uint8_t alpha = coloringOnly ? 255 : src[A];
+        uint8_t r = src[R], g = src[G], b = src[B];
+        if (Tint)
+        {
+            r = (r * tint[1]) >> 8;
+            g = (g * tint[2]) >> 8;
+            b = (b * tint[3]) >> 8;
+            alpha = (alpha * tint[0]) >> 8;
+        }
+        if (alpha == 0)
+            continue;
 
-        for (size_t i = 0; i < rowLength; ++i, srcPixel += sourceInfo.bytesPerPixel, ++dstPixel)
+        uint16_t srcPixel = PackRGB565(r, g, b);
+        if (alpha == 255)
         {
-            uint8_t grayValue = srcPixel[0];
-            uint8_t alpha = (grayValue == 0) ? 0 : 255;
+            dst[i] = srcPixel;
+            continue;
+        }
+        dst[i] = BlendPixelRGB565(ExpandRGB565(srcPixel), dst[i], (alpha + 4) >> 3);
+    }
+}
 
-            if (alpha == 0)
-            {
-                continue;
-            }
+template <int A, int R, int G, int B>
+static void BlendRGBA32RowToRGB565(uint16_t *dst, const uint8_t *src, size_t rowLength, const Coloring &coloring, bool coloringOnly)
+{
+    if (coloring.colorEnabled && coloring.color.data[0] != 0)
+        BlendRGBA32RowToRGB565<A, R, G, B, true>(dst, src, rowLength, coloring, coloringOnly);
+    else
+        BlendRGBA32RowToRGB565<A, R, G, B, false>(dst, src, rowLength, coloring, coloringOnly);
+}
 
-            uint16_t srcColor = srcRGB565[i];
+// ARGB8888/RGBA8888 rows and solid colors onto RGB565 are replaced by Platform/esp32s3 when it is enabled
+#ifndef USE_ESP32S3_SIMD
+void BlendFunctions::BlendRGBA32ToRGB565(uint8_t *dstRow,
+                                         const uint8_t *srcRow,
+                                         size_t rowLength,
+                                         const PixelFormatInfo &/*targetInfo*/,
+                                         const PixelFormatInfo &sourceInfo,
+                                         Coloring coloring,
+                                         bool /*useSolidColor*/,
+                                         BlendContext& context)
+{
+    uint16_t *dst = reinterpret_cast<uint16_t *>(dstRow);
+    bool coloringOnly = context.mode == BlendMode::COLORINGONLY;
+    if (sourceInfo.format == PixelFormat::RGBA8888)
+        BlendRGBA32RowToRGB565<3, 0, 1, 2>(dst, srcRow, rowLength, coloring, coloringOnly);
+    else
+        BlendRGBA32RowToRGB565<0, 1, 2, 3>(dst, srcRow, rowLength, coloring, coloringOnly);
+}
+#endif
 
-            // Apply coloring if needed
-            if (coloring.colorEnabled)
-            {
-                // Extract RGB components with proper scaling
-                uint32_t r = (srcColor >> 11) & 0x1F;
-                uint32_t g = (srcColor >> 5) & 0x3F;
-                uint32_t b = srcColor & 0x1F;
-
-                // Scale up for better precision
-                r = (r << 3) | (r >> 2);  // Scale to 0-255
-                g = (g << 2) | (g >> 4);  // Scale to 0-255
-                b = (b << 3) | (b >> 2);  // Scale to 0-255
-
-                // Apply color multiplication
-                r = (r * colorFactor) >> 8;
-                g = (g * colorFactor) >> 8;
-                b = (b * colorFactor) >> 8;
-
-                // Scale back to RGB565
-                r = r >> 3;
-                g = g >> 2;
-                b = b >> 3;
-
-                srcColor = (r << 11) | (g << 5) | b;
-                alpha = (alpha * coloring.color.data[0]) >> 8;
-            }
+void BlendFunctions::BlendRGB565(uint8_t *dstRow,
+                                 const uint8_t *srcRow,
+                                 size_t rowLength,
+                                 const PixelFormatInfo &targetInfo,
+                                 const PixelFormatInfo &sourceInfo,
+                                 Coloring coloring,
+                                 bool useSolidColor,
+                                 BlendContext& context)
+{
+    PixelConverter::ConvertFunc convertToARGB8888 = PixelConverter::GetConversionFunction(sourceInfo.format, PixelFormat::ARGB8888);
+    if (!convertToARGB8888)
+        return;
 
-            uint8_t invAlpha = 255 - alpha;
+    // Convert the source in chunks to ARGB8888 and blend those with the ARGB8888 kernel
+    const size_t chunkSize = 256;
+    alignas(16) uint8_t srcARGB8888[chunkSize * 4];
+    uint16_t *dst = reinterpret_cast<uint16_t *>(dstRow);
+    bool coloringOnly = context.mode == BlendMode::COLORINGONLY;
 
-            // Extract source and destination components with proper scaling
-            uint32_t src_r = ((srcColor >> 11) & 0x1F) << 3;  // Scale to 0-255
-            uint32_t src_g = ((srcColor >> 5) & 0x3F) << 2;   // Scale to 0-255
-            uint32_t src_b = (srcColor & 0x1F) << 3;          // Scale to 0-255
+    for (size_t offset = 0; offset < rowLength; offset += chunkSize)
+    {
+        size_t count = std::min(chunkSize, rowLength - offset);
+        const uint8_t *src = srcRow + offset * sourceInfo.bytesPerPixel;
+        convertToARGB8888(src, srcARGB8888, count);
 
-            uint32_t dst_r = ((*dstPixel >> 11) & 0x1F) << 3;
-            uint32_t dst_g = ((*dstPixel >> 5) & 0x3F) << 2;
-            uint32_t dst_b = (*dstPixel & 0x1F) << 3;
+        // grayscale is used as a mask, black is transparent
+        if (sourceInfo.format == PixelFormat::GRAYSCALE8)
+        {
+            for (size_t i = 0; i < count; ++i)
+                srcARGB8888[i * 4] = src[i] == 0 ? 0 : 255;
+        }
+        BlendRGBA32RowToRGB565<0, 1, 2, 3>(dst + offset, srcARGB8888, count, coloring, coloringOnly);
+    }
+}
 
-            // Blend with proper scaling
-            uint32_t final_r = (src_r * alpha + dst_r * invAlpha) >> 8;
-            uint32_t final_g = (src_g * alpha + dst_g * invAlpha) >> 8;
-            uint32_t final_b = (src_b * alpha + dst_b * invAlpha) >> 8;
+#ifndef USE_ESP32S3_SIMD
+void BlendFunctions::BlendSolidRowRGB565(uint8_t *dstRow,
+                                         const uint8_t *srcRow,
+                                         size_t rowLength,
+                                         const PixelFormatInfo &/*targetInfo*/,
+                                         const PixelFormatInfo &sourceInfo,
+                                         Coloring coloring,
+                                         bool /*useSolidColor*/,
+                                         BlendContext& context)
+{
+    alignas(16) uint8_t color[4];
+    PixelConverter::Convert(sourceInfo.format, PixelFormat::ARGB8888, srcRow, color, 1);
 
-            // Convert back to RGB565 with proper rounding
-            final_r = (final_r + 4) >> 3;  // Add rounding factor
-            final_g = (final_g + 2) >> 2;
-            final_b = (final_b + 4) >> 3;
+    uint8_t alpha = context.mode == BlendMode::COLORINGONLY ? 255 : color[0];
+    if (coloring.colorEnabled && coloring.color.data[0] != 0)
+    {
+        color[1] = (color[1] * coloring.color.data[1]) >> 8;
+        color[2] = (color[2] * coloring.color.data[2]) >> 8;
+        color[3] = (color[3] * coloring.color.data[3]) >> 8;
+        alpha = (alpha * coloring.color.data[0]) >> 8;
+    }
+    if (alpha == 0)
+        return;
 
-            // Clamp values
-            final_r = (final_r > 0x1F) ? 0x1F : final_r;
-            final_g = (final_g > 0x3F) ? 0x3F : final_g;
-            final_b = (final_b > 0x1F) ? 0x1F : final_b;
+    uint16_t srcPixel = PackRGB565(color[1], color[2], color[3]);
+    uint16_t *dst = reinterpret_cast<uint16_t *>(dstRow);
+    if (alpha == 255)
+    {
+        std::fill_n(dst, rowLength, srcPixel);
+        return;
+    }
 
-            // Pack back into RGB565
-            *dstPixel = (final_r << 11) | (final_g << 5) | final_b;
-        }
+    uint32_t srcExpanded = ExpandRGB565(srcPixel);
+    uint32_t alpha5 = (alpha + 4) >> 3;
+    for (size_t i = 0; i < rowLength; ++i)
+    {
+        dst[i] = BlendPixelRGB565(srcExpanded, dst[i], alpha5);
     }
+}
+#endif
 
+// RGB24 targets are replaced by Platform/x86_simd when it is enabled
+#ifndef USE_X86_SIMD
 void BlendFunctions::BlendSolidRowRGB24(uint8_t *dstRow,
                                         const uint8_t *srcRow,
                                         size_t rowLength,
@@ -194,7 +260,7 @@ void BlendFunctions::BlendSolidRowRGB24(uint8_t *dstRow,
         srcRGB24[0] = (srcRGB24[0] * colorDataAsRGB[0]) >> 8;
         srcRGB24[1] = (srcRGB24[1] * colorDataAsRGB[1]) >> 8;
         srcRGB24[2] = (srcRGB24[2] * colorDataAsRGB[2]) >> 8;
-        alpha = (alpha * colorDataAsRGB[2]) >> 8;
+        alpha = (alpha * colorFactor) >> 8;
     }
 
     uint8_t invAlpha = 255 - alpha;
@@ -332,7 +398,11 @@ void BlendFunctions::BlendSolidRowRGB24(uint8_t *dstRow,
                 dstRow[i + 2] = tempB < 0 ? 0 : (tempB > 255 ? 255 : tempB);
                 break;
             }
-
+            case BlendOperation::BitwiseAnd:
+                dstRow[i] = ((srcRGB24[0] * srcFactorR) >> 8) & ((dstRow[i] * dstFactorR) >> 8);
+                dstRow[i + 1] = ((srcRGB24[1] * srcFactorG) >> 8) & ((dstRow[i + 1] * dstFactorG) >> 8);
+                dstRow[i + 2] = ((srcRGB24[2] * srcFactorB) >> 8) & ((dstRow[i + 2] * dstFactorB) >> 8);
+                break;
             default:
                 break;
         }
@@ -525,6 +595,11 @@ void BlendFunctions::BlendRGB24(uint8_t *dstRow,
                 dstPixel[1] = ((dstPixel[1] * dstFactorG - srcColor[1] * srcFactorG) >> 8) < 0 ? 0 : (((dstPixel[1] * dstFactorG - srcColor[1] * srcFactorG) >> 8) > 255 ? 255 : (dstPixel[1] * dstFactorG - srcColor[1] * srcFactorG) >> 8);
                 dstPixel[2] = ((dstPixel[2] * dstFactorB - srcColor[2] * srcFactorB) >> 8) < 0 ? 0 : (((dstPixel[2] * dstFactorB - srcColor[2] * srcFactorB) >> 8) > 255 ? 255 : (dstPixel[2] * dstFactorB - srcColor[2] * srcFactorB) >> 8);
                 break;
+            case BlendOperation::BitwiseAnd:
+                dstPixel[0] = ((srcColor[0] * srcFactorR) >> 8) & ((dstPixel[0] * dstFactorR) >> 8);
+                dstPixel[1] = ((srcColor[1] * srcFactorG) >> 8) & ((dstPixel[1] * dstFactorG) >> 8);
+                dstPixel[2] = ((srcColor[2] * srcFactorB) >> 8) & ((dstPixel[2] * dstFactorB) >> 8);
+                break;
             default:
                 break;
         }
@@ -697,12 +772,13 @@ void BlendFunctions::BlendRGBA32ToRGB24(uint8_t *dstRow,
                 dstPixel[2] = ((dstPixel[2] * dstFactorB - srcColor[2] * srcFactorB) >> 8) < 0 ? 0 : (((dstPixel[2] * dstFactorB - srcColor[2] * srcFactorB) >> 8) > 255 ? 255 : (dstPixel[2] * dstFactorB - srcColor[2] * srcFactorB) >> 8);
                 break;
             case BlendOperation::BitwiseAnd:
-                dstPixel[0] = (srcColor[0] * srcFactorR & dstPixel[0] * dstFactorR) >> 8;
-                dstPixel[1] = (srcColor[1] * srcFactorG & dstPixel[1] * dstFactorG) >> 8;
-                dstPixel[2] = (srcColor[2] * srcFactorB & dstPixel[2] * dstFactorB) >> 8;
+                dstPixel[0] = ((srcColor[0] * srcFactorR) >> 8) & ((dstPixel[0] * dstFactorR) >> 8);
+                dstPixel[1] = ((srcColor[1] * srcFactorG) >> 8) & ((dstPixel[1] * dstFactorG) >> 8);
+                dstPixel[2] = ((srcColor[2] * srcFactorB) >> 8) & ((dstPixel[2] * dstFactorB) >> 8);
                 break;
             default:
                 break;
         }
     }
-}
\ No newline at end of file
+}
+#endif // !USE_X86_SIMD
@@ -0,0 +1,490 @@
+#include "../../BlendMode.h"
+#include "../../BlendFunctions.h"
+#include "../../../PixelFormat/PixelConverter.h"
+#include "../../../PixelFormat/PixelFormatInfo.h"
+
+#include <immintrin.h>
+#include <cstring>
+
+using namespace Tergos2D;
+
+// SSE4.1 versions of the RGB24 kernels, everything else comes from Platform/generic.
+// Results are bit exact with the generic kernels for every factor and operation.
+
+#define SIMDCHUNKSIZE 64
+
+struct Channels
+{
+    __m128i r, g, b;
+};
+
+// 8 packed 3 byte pixels to one 16 bit register per channel
+static inline Channels Load3x8(const uint8_t *src)
+{
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    __m128i hi = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + 16));
+    Channels c;
+    c.r = _mm_or_si128(_mm_shuffle_epi8(lo, _mm_setr_epi8(0, -1, 3, -1, 6, -1, 9, -1, 12, -1, 15, -1, -1, -1, -1, -1)),
+                       _mm_shuffle_epi8(hi, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, -1, 5, -1)));
+    c.g = _mm_or_si128(_mm_shuffle_epi8(lo, _mm_setr_epi8(1, -1, 4, -1, 7, -1, 10, -1, 13, -1, -1, -1, -1, -1, -1, -1)),
+                       _mm_shuffle_epi8(hi, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, -1, 3, -1, 6, -1)));
+    c.b = _mm_or_si128(_mm_shuffle_epi8(lo, _mm_setr_epi8(2, -1, 5, -1, 8, -1, 11, -1, 14, -1, -1, -1, -1, -1, -1, -1)),
+                       _mm_shuffle_epi8(hi, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, -1, 4, -1, 7, -1)));
+    return c;
+}
+
+static inline void Store3x8(const Channels &c, uint8_t *dst)
+{
+    __m128i rg = _mm_packus_epi16(c.r, c.g);
+    __m128i bb = _mm_packus_epi16(c.b, c.b);
+    const __m128i loRG = _mm_setr_epi8(0, 8, -1, 1, 9, -1, 2, 10, -1, 3, 11, -1, 4, 12, -1, 5);
+    const __m128i loB = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+    const __m128i hiRG = _mm_setr_epi8(13, -1, 6, 14, -1, 7, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i hiB = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_or_si128(_mm_shuffle_epi8(rg, loRG), _mm_shuffle_epi8(bb, loB)));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + 16), _mm_or_si128(_mm_shuffle_epi8(rg, hiRG), _mm_shuffle_epi8(bb, hiB)));
+}
+
+// RGB24 targets have no alpha, DestAlpha is treated as 255 like in the generic kernels
+static inline Channels BlendFactorChannels(BlendFactor factor, const Channels &src, const Channels &dst, __m128i alpha)
+{
+    const __m128i full = _mm_set1_epi16(255);
+    switch (factor)
+    {
+    case BlendFactor::Zero:
+    case BlendFactor::InverseDestAlpha:
+        return {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+    case BlendFactor::SourceAlpha:
+        return {alpha, alpha, alpha};
+    case BlendFactor::InverseSourceAlpha:
+    {
+        __m128i inverse = _mm_sub_epi16(full, alpha);
+        return {inverse, inverse, inverse};
+    }
+    case BlendFactor::SourceColor:
+        return src;
+    case BlendFactor::DestColor:
+        return dst;
+    case BlendFactor::InverseSourceColor:
+        return {_mm_sub_epi16(full, src.r), _mm_sub_epi16(full, src.g), _mm_sub_epi16(full, src.b)};
+    case BlendFactor::InverseDestColor:
+        return {_mm_sub_epi16(full, dst.r), _mm_sub_epi16(full, dst.g), _mm_sub_epi16(full, dst.b)};
+    default:
+        return {full, full, full};
+    }
+}
+
+// src * srcFactor + dst * dstFactor per 16 bit lane, computed in 32 bit and shifted down by 8
+static inline __m128i MultiplyAdd(__m128i src, __m128i srcFactor, __m128i dst, __m128i dstFactor)
+{
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(src, dst), _mm_unpacklo_epi16(srcFactor, dstFactor));
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(src, dst), _mm_unpackhi_epi16(srcFactor, dstFactor));
+    return _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8));
+}
+
+static inline __m128i Combine(BlendOperation operation, __m128i src, __m128i srcFactor, __m128i dst, __m128i dstFactor)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+    switch (operation)
+    {
+    case BlendOperation::Add:
+        // the generic kernels store the sum into a byte, keep the wrap around
+        return _mm_and_si128(MultiplyAdd(src, srcFactor, dst, dstFactor), full);
+    case BlendOperation::Subtract:
+        return _mm_min_epi16(_mm_max_epi16(MultiplyAdd(src, srcFactor, dst, _mm_sub_epi16(zero, dstFactor)), zero), full);
+    case BlendOperation::ReverseSubtract:
+        return _mm_min_epi16(_mm_max_epi16(MultiplyAdd(src, _mm_sub_epi16(zero, srcFactor), dst, dstFactor), zero), full);
+    case BlendOperation::BitwiseAnd:
+        return _mm_and_si128(_mm_srli_epi16(_mm_mullo_epi16(src, srcFactor), 8),
+                             _mm_srli_epi16(_mm_mullo_epi16(dst, dstFactor), 8));
+    default:
+        return dst;
+    }
+}
+
+// blends 8 pixels, per pixel skip keeps the destination and copy writes the source unblended,
+// alpha and both masks are 16 bit lanes
+static inline void Blend8(uint8_t *dst,
+                          const uint8_t *src,
+                          __m128i alpha,
+                          __m128i skipMask,
+                          __m128i copyMask,
+                          const Channels *tint,
+                          const BlendContext &context)
+{
+    Channels d = Load3x8(dst);
+    Channels s = Load3x8(src);
+    if (tint != nullptr)
+    {
+        s.r = _mm_srli_epi16(_mm_mullo_epi16(s.r, tint->r), 8);
+        s.g = _mm_srli_epi16(_mm_mullo_epi16(s.g, tint->g), 8);
+        s.b = _mm_srli_epi16(_mm_mullo_epi16(s.b, tint->b), 8);
+    }
+
+    Channels srcFactor = BlendFactorChannels(context.colorBlendFactorSrc, s, d, alpha);
+    Channels dstFactor = BlendFactorChannels(context.colorBlendFactorDst, s, d, alpha);
+
+    Channels result;
+    result.r = Combine(context.colorBlendOperation, s.r, srcFactor.r, d.r, dstFactor.r);
+    result.g = Combine(context.colorBlendOperation, s.g, srcFactor.g, d.g, dstFactor.g);
+    result.b = Combine(context.colorBlendOperation, s.b, srcFactor.b, d.b, dstFactor.b);
+
+    result.r = _mm_blendv_epi8(_mm_blendv_epi8(result.r, s.r, copyMask), d.r, skipMask);
+    result.g = _mm_blendv_epi8(_mm_blendv_epi8(result.g, s.g, copyMask), d.g, skipMask);
+    result.b = _mm_blendv_epi8(_mm_blendv_epi8(result.b, s.b, copyMask), d.b, skipMask);
+
+    Store3x8(result, dst);
+}
+
+static inline __m128i LoadBytes8(const uint8_t *bytes, bool sign)
+{
+    __m128i value = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(bytes));
+    return sign ? _mm_cvtepi8_epi16(value) : _mm_cvtepu8_epi16(value);
+}
+
+// runs Blend8 over a span, the tail goes through padded buffers so it is blended the same way
+static void BlendSpanRGB24(uint8_t *dst,
+                           const uint8_t *src,
+                           const uint8_t *alpha,
+                           const uint8_t *skip,
+                           const uint8_t *copy,
+                           size_t count,
+                           const Channels *tint,
+                           const BlendContext &context)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        Blend8(dst + i * 3, src + i * 3, LoadBytes8(alpha + i, false), LoadBytes8(skip + i, true), LoadBytes8(copy + i, true), tint, context);
+    }
+
+    if (i < count)
+    {
+        size_t rest = count - i;
+        alignas(16) uint8_t dstTail[24] = {};
+        alignas(16) uint8_t srcTail[24] = {};
+        alignas(16) uint8_t alphaTail[8] = {};
+        alignas(16) uint8_t skipTail[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+        alignas(16) uint8_t copyTail[8] = {};
+        memcpy(dstTail, dst + i * 3, rest * 3);
+        memcpy(srcTail, src + i * 3, rest * 3);
+        memcpy(alphaTail, alpha + i, rest);
+        memcpy(skipTail, skip + i, rest);
+        memcpy(copyTail, copy + i, rest);
+        Blend8(dstTail, srcTail, LoadBytes8(alphaTail, false), LoadBytes8(skipTail, true), LoadBytes8(copyTail, true), tint, context);
+        memcpy(dst + i * 3, dstTail, rest * 3);
+    }
+}
+
+static inline Channels MakeTint(const uint8_t *colorDataAsRGB)
+{
+    return {_mm_set1_epi16(colorDataAsRGB[0]), _mm_set1_epi16(colorDataAsRGB[1]), _mm_set1_epi16(colorDataAsRGB[2])};
+}
+
+// same alpha lookup as the generic kernels, without reading past the pixel
+static inline uint8_t ReadAlpha(const uint8_t *srcPixel, uint8_t bytesPerPixel, uint8_t alphaShift, uint16_t alphaMask)
+{
+    // loads are done at their natural width, partial copies into a wider value stall store forwarding
+    uint32_t pixel;
+    switch (bytesPerPixel)
+    {
+    case 4:
+        memcpy(&pixel, srcPixel, 4);
+        break;
+    case 3:
+        pixel = srcPixel[0] | (srcPixel[1] << 8) | (srcPixel[2] << 16);
+        break;
+    case 2:
+    {
+        uint16_t value;
+        memcpy(&value, srcPixel, 2);
+        pixel = value;
+        break;
+    }
+    default:
+        pixel = srcPixel[0];
+        break;
+    }
+    return (pixel >> alphaShift) & alphaMask;
+}
+
+// alpha of 8 four byte pixels as 16 bit lanes, (pixel >> shift) & mask like the generic kernels
+static inline __m128i LoadAlpha8(const uint8_t *src, __m128i shift, __m128i mask)
+{
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+    lo = _mm_and_si128(_mm_srl_epi32(lo, shift), mask);
+    hi = _mm_and_si128(_mm_srl_epi32(hi, shift), mask);
+    return _mm_packus_epi32(lo, hi);
+}
+
+// four byte sources keep the alpha in registers instead of going through the per pixel arrays,
+// skipAndCopy selects the BlendRGB24 behaviour of leaving alpha 0 alone and copying alpha 255
+static void BlendAlpha32RowRGB24(uint8_t *dstRow,
+                                 const uint8_t *srcRow,
+                                 size_t rowLength,
+                                 PixelConverter::ConvertFunc convertToRGB24,
+                                 uint8_t alphaShift,
+                                 uint8_t alphaMask,
+                                 uint8_t colorFactor,
+                                 const Channels *tint,
+                                 bool skipAndCopy,
+                                 const BlendContext &context)
+{
+    alignas(16) uint8_t srcRGB24[SIMDCHUNKSIZE * 3];
+    const __m128i shift = _mm_cvtsi32_si128(alphaShift);
+    const __m128i mask = _mm_set1_epi32(alphaMask);
+    const __m128i factor = _mm_set1_epi16(colorFactor);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(255);
+
+    size_t vectorLength = rowLength & ~size_t(7);
+    for (size_t offset = 0; offset < vectorLength; offset += SIMDCHUNKSIZE)
+    {
+        size_t count = std::min<size_t>(SIMDCHUNKSIZE, vectorLength - offset);
+        const uint8_t *src = srcRow + offset * 4;
+        uint8_t *dst = dstRow + offset * 3;
+        convertToRGB24(src, srcRGB24, count);
+
+        for (size_t i = 0; i < count; i += 8)
+        {
+            __m128i alpha = LoadAlpha8(src + i * 4, shift, mask);
+            __m128i skipMask = zero;
+            __m128i copyMask = zero;
+            if (skipAndCopy)
+            {
+                skipMask = _mm_cmpeq_epi16(alpha, zero);
+                if (_mm_movemask_epi8(skipMask) == 0xFFFF)
+                    continue;
+            }
+            if (colorFactor != 0)
+            {
+                alpha = _mm_srli_epi16(_mm_mullo_epi16(alpha, factor), 8);
+            }
+            if (skipAndCopy)
+            {
+                copyMask = _mm_cmpeq_epi16(alpha, full);
+            }
+            Blend8(dst + i * 3, srcRGB24 + i * 3, alpha, skipMask, copyMask, tint, context);
+        }
+    }
+
+    size_t rest = rowLength - vectorLength;
+    if (rest == 0)
+    {
+        return;
+    }
+
+    alignas(16) uint8_t alpha[8];
+    alignas(16) uint8_t skip[8];
+    alignas(16) uint8_t copy[8];
+    const uint8_t *srcPixel = srcRow + vectorLength * 4;
+    convertToRGB24(srcPixel, srcRGB24, rest);
+    for (size_t i = 0; i < rest; ++i, srcPixel += 4)
+    {
+        uint8_t a = ReadAlpha(srcPixel, 4, alphaShift, alphaMask);
+        skip[i] = skipAndCopy && a == 0 ? 0xFF : 0;
+        if (colorFactor != 0)
+        {
+            a = (a * colorFactor) >> 8;
+        }
+        alpha[i] = a;
+        copy[i] = skipAndCopy && a == 255 ? 0xFF : 0;
+    }
+    BlendSpanRGB24(dstRow + vectorLength * 3, srcRGB24, alpha, skip, copy, rest, tint, context);
+}
+
+void BlendFunctions::BlendSolidRowRGB24(uint8_t *dstRow,
+                                        const uint8_t *srcRow,
+                                        size_t rowLength,
+                                        const PixelFormatInfo &targetInfo,
+                                        const PixelFormatInfo &sourceInfo,
+                                        Coloring coloring,
+                                        bool /*useSolidColor*/,
+                                        BlendContext& context)
+{
+    PixelConverter::ConvertFunc convertToRGB24 = PixelConverter::GetConversionFunction(sourceInfo.format, targetInfo.format);
+    PixelConverter::ConvertFunc convertColorToRGB24 = PixelConverter::GetConversionFunction(PixelFormat::ARGB8888, targetInfo.format);
+
+    alignas(16) uint8_t srcRGB24[3];
+    alignas(16) uint8_t colorDataAsRGB[3];
+
+    convertToRGB24(srcRow, srcRGB24, 1);
+    convertColorToRGB24(coloring.color.data, colorDataAsRGB, 1);
+
+    uint8_t colorFactor = coloring.colorEnabled ? coloring.color.data[0] : 0;
+
+    uint8_t alpha = 255;
+    if (context.mode != BlendMode::COLORINGONLY)
+    {
+        alpha = ReadAlpha(srcRow, sourceInfo.bytesPerPixel, sourceInfo.alphaShift, sourceInfo.alphaMask);
+    }
+
+    if (alpha == 0)
+    {
+        return;
+    }
+
+    if (colorFactor != 0)
+    {
+        srcRGB24[0] = (srcRGB24[0] * colorDataAsRGB[0]) >> 8;
+        srcRGB24[1] = (srcRGB24[1] * colorDataAsRGB[1]) >> 8;
+        srcRGB24[2] = (srcRGB24[2] * colorDataAsRGB[2]) >> 8;
+        alpha = (alpha * colorFactor) >> 8;
+    }
+
+    alignas(16) uint8_t srcChunk[SIMDCHUNKSIZE * 3];
+    alignas(16) uint8_t alphaChunk[SIMDCHUNKSIZE];
+    alignas(16) uint8_t flags[SIMDCHUNKSIZE] = {};
+    for (size_t i = 0; i < SIMDCHUNKSIZE; ++i)
+    {
+        memcpy(srcChunk + i * 3, srcRGB24, 3);
+    }
+    memset(alphaChunk, alpha, sizeof(alphaChunk));
+
+    for (size_t offset = 0; offset < rowLength; offset += SIMDCHUNKSIZE)
+    {
+        size_t count = std::min<size_t>(SIMDCHUNKSIZE, rowLength - offset);
+        BlendSpanRGB24(dstRow + offset * 3, srcChunk, alphaChunk, flags, flags, count, nullptr, context);
+    }
+}
+
+void BlendFunctions::BlendRGB24(uint8_t *dstRow,
+                                const uint8_t *srcRow,
+                                size_t rowLength,
+                                const PixelFormatInfo &targetInfo,
+                                const PixelFormatInfo &sourceInfo,
+                                Coloring coloring,
+                                bool /*useSolidColor*/,
+                                BlendContext& context)
+{
+    // Conversion function for the source format could be either rgb24 or bgr24
+    PixelConverter::ConvertFunc convertToRGB24 = PixelConverter::GetConversionFunction(sourceInfo.format, targetInfo.format);
+    PixelConverter::ConvertFunc convertColorToRGB24 = PixelConverter::GetConversionFunction(PixelFormat::ARGB8888, targetInfo.format);
+
+    alignas(16) uint8_t srcRGB24[SIMDCHUNKSIZE * 3];
+    alignas(16) uint8_t alpha[SIMDCHUNKSIZE];
+    alignas(16) uint8_t skip[SIMDCHUNKSIZE];
+    alignas(16) uint8_t copy[SIMDCHUNKSIZE];
+    alignas(16) uint8_t colorDataAsRGB[3];
+
+    convertColorToRGB24(coloring.color.data, colorDataAsRGB, 1);
+    uint8_t colorFactor = coloring.colorEnabled ? coloring.color.data[0] : 0;
+    Channels tint = MakeTint(colorDataAsRGB);
+
+    // the byte stores below may alias the infos, keep what the loop needs in locals
+    const uint8_t bytesPerPixel = sourceInfo.bytesPerPixel;
+    const uint8_t alphaShift = sourceInfo.alphaShift;
+    const uint16_t alphaMask = sourceInfo.alphaMask;
+    const bool grayscale = sourceInfo.format == PixelFormat::GRAYSCALE8;
+    const bool coloringOnly = context.mode == BlendMode::COLORINGONLY;
+
+    // formats whose alpha always reads as 0 have nothing to draw
+    const uint32_t pixelMask = bytesPerPixel >= 4 ? 0xFFFFFFFFu : (1u << (bytesPerPixel * 8)) - 1;
+    if (!grayscale && !coloringOnly && ((pixelMask >> alphaShift) & alphaMask) == 0)
+    {
+        return;
+    }
+
+    if (bytesPerPixel == 4 && !grayscale && !coloringOnly)
+    {
+        BlendAlpha32RowRGB24(dstRow, srcRow, rowLength, convertToRGB24, alphaShift, static_cast<uint8_t>(alphaMask), colorFactor,
+                             colorFactor != 0 ? &tint : nullptr, true, context);
+        return;
+    }
+
+    for (size_t offset = 0; offset < rowLength; offset += SIMDCHUNKSIZE)
+    {
+        size_t count = std::min<size_t>(SIMDCHUNKSIZE, rowLength - offset);
+        const uint8_t *srcPixel = srcRow + offset * bytesPerPixel;
+        uint8_t anyVisible = 0;
+        uint8_t allCopy = 0xFF;
+
+        for (size_t i = 0; i < count; ++i, srcPixel += bytesPerPixel)
+        {
+            uint8_t a;
+            if (grayscale)
+            {
+                a = (srcPixel[0] == 0) ? 0 : 255;
+            }
+            else if (coloringOnly)
+            {
+                a = 255;
+            }
+            else
+            {
+                a = ReadAlpha(srcPixel, bytesPerPixel, alphaShift, alphaMask);
+            }
+            skip[i] = a == 0 ? 0xFF : 0;
+
+            if (colorFactor != 0)
+            {
+                a = (a * colorFactor) >> 8;
+            }
+            alpha[i] = a;
+            copy[i] = a == 255 ? 0xFF : 0;
+            anyVisible |= ~skip[i];
+            allCopy &= copy[i];
+        }
+
+        if (!anyVisible)
+        {
+            continue;
+        }
+
+        uint8_t *dstChunk = dstRow + offset * 3;
+        convertToRGB24(srcRow + offset * bytesPerPixel, srcRGB24, count);
+        if (allCopy && colorFactor == 0)
+        {
+            memcpy(dstChunk, srcRGB24, count * 3);
+            continue;
+        }
+
+        BlendSpanRGB24(dstChunk, srcRGB24, alpha, skip, copy, count, colorFactor != 0 ? &tint : nullptr, context);
+    }
+}
+
+void BlendFunctions::BlendRGBA32ToRGB24(uint8_t *dstRow,
+                                        const uint8_t *srcRow,
+                                        size_t rowLength,
+                                        const PixelFormatInfo &targetInfo,
+                                        const PixelFormatInfo &sourceInfo,
+                                        Coloring coloring,
+                                        bool /*useSolidColor*/,
+                                        BlendContext& context)
+{
+    PixelConverter::ConvertFunc convertToRGB24 = PixelConverter::GetConversionFunction(sourceInfo.format, targetInfo.format);
+    PixelConverter::ConvertFunc convertColorToRGB24 = PixelConverter::GetConversionFunction(PixelFormat::ARGB8888, targetInfo.format);
+
+    alignas(16) uint8_t srcRGB24[SIMDCHUNKSIZE * 3];
+    alignas(16) uint8_t alpha[SIMDCHUNKSIZE];
+    alignas(16) uint8_t flags[SIMDCHUNKSIZE] = {};
+    alignas(16) uint8_t colorDataAsRGB[3];
+
+    convertColorToRGB24(coloring.color.data, colorDataAsRGB, 1);
+    uint8_t colorFactor = coloring.colorEnabled * coloring.color.data[0];
+    Channels tint = MakeTint(colorDataAsRGB);
+
+    if (sourceInfo.bytesPerPixel == 4 && context.mode != BlendMode::COLORINGONLY)
+    {
+        BlendAlpha32RowRGB24(dstRow, srcRow, rowLength, convertToRGB24, 24, 0xFF, colorFactor,
+                             colorFactor ? &tint : nullptr, false, context);
+        return;
+    }
+
+    for (size_t offset = 0; offset < rowLength; offset += SIMDCHUNKSIZE)
+    {
+        size_t count = std::min<size_t>(SIMDCHUNKSIZE, rowLength - offset);
+        const uint8_t *srcPixel = srcRow + offset * sourceInfo.bytesPerPixel;
+        convertToRGB24(srcPixel, srcRGB24, count);
+
+        for (size_t i = 0; i < count; ++i, srcPixel += sourceInfo.bytesPerPixel)
+        {
+            uint8_t a = context.mode == BlendMode::COLORINGONLY ? 255 : srcPixel[3];
+            alpha[i] = colorFactor ? (a * colorFactor) >> 8 : a;
+        }
+
+        BlendSpanRGB24(dstRow + offset * 3, srcRGB24, alpha, flags, flags, count, colorFactor ? &tint : nullptr, context);
+    }
+}
@@ -101,7 +101,7 @@ Color Color::Lerp(const Color &a, const Color &b, float t)
 {
     t = std::clamp(t, 0.0f, 1.0f);
     return Color(
-        static_cast<uint8_t>(a.data[0] + t * (b.data[0] - b.data[0])),
+        static_cast<uint8_t>(a.data[0] + t * (b.data[0] - a.data[0])),
         static_cast<uint8_t>(a.data[1] + t * (b.data[1] - a.data[1])),
         static_cast<uint8_t>(a.data[2] + t * (b.data[2] - a.data[2])),
         static_cast<uint8_t>(a.data[3] + t * (b.data[3] - a.data[3])));
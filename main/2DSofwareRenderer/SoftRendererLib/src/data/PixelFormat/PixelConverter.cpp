@@ -1,5 +1,7 @@
 #include "PixelConverter.h"
 #include "PixelFormatInfo.h"
+#include "PixelTraits.h"
+#include <algorithm>
 namespace Tergos2D
 {
 
@@ -7,10 +9,19 @@ namespace Tergos2D
     {
         std::memcpy(dst, src, count * 1);
     }
+    // RGB565 copies and fills are replaced by Platform/esp32s3 when it is enabled
+#ifndef USE_ESP32S3_SIMD
     void PixelConverter::Move2(const uint8_t *src, uint8_t *dst, size_t count)
     {
         std::memcpy(dst, src, count * 2);
     }
+    void PixelConverter::Fill2(uint8_t *dst, const uint8_t *pixel, size_t count)
+    {
+        uint16_t value;
+        std::memcpy(&value, pixel, 2);
+        std::fill_n(reinterpret_cast<uint16_t *>(dst), count, value);
+    }
+#endif
     void PixelConverter::Move3(const uint8_t *src, uint8_t *dst, size_t count)
     {
         std::memcpy(dst, src, count * 3);
@@ -19,43 +30,424 @@ namespace Tergos2D
     {
         std::memcpy(dst, src, count * 4);
     }
+    template <uint8_t Bits>
+    void PixelConverter::MoveBits(const uint8_t *src, uint8_t *dst, size_t count)
+    {
+        std::memcpy(dst, src, (count * Bits + 7) / 8);
+    }
 
 
 
-    PixelConverter::ConvertFunc PixelConverter::GetConversionFunction(PixelFormat from, PixelFormat to)
+    template <PixelConverter::ConvertFunc ToARGB8888, PixelConverter::ConvertFunc FromARGB8888, uint8_t SourceBits, uint8_t TargetBits>
+    void PixelConverter::ConvertThroughARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
     {
+        static_assert(CONVERSIONCHUNKSIZE % 8 == 0, "chunks of bit formats have to start on a byte");
+        alignas(16) uint8_t buffer[CONVERSIONCHUNKSIZE * 4];
+        while (count > 0)
+        {
+            size_t chunk = std::min<size_t>(count, CONVERSIONCHUNKSIZE);
+            ToARGB8888(src, buffer, chunk);
+            FromARGB8888(buffer, dst, chunk);
+            src += chunk * SourceBits / 8;
+            dst += chunk * TargetBits / 8;
+            count -= chunk;
+        }
+    }
 
-        if (from == to)
+    // same as PixelFormatRegistry, which can't be used at compile time
+    constexpr uint8_t PixelConverter::BitsPerPixel(PixelFormat format)
+    {
+        switch (format)
         {
-            uint8_t pixelPerByte = PixelFormatRegistry::GetInfo(from).bytesPerPixel;
+        case PixelFormat::ARGB8888:
+        case PixelFormat::RGBA8888:
+        case PixelFormat::ARGB8888_PRE:
+        case PixelFormat::RGBA8888_PRE:
+            return 32;
+        case PixelFormat::RGB24:
+        case PixelFormat::BGR24:
+            return 24;
+        case PixelFormat::ARGB1555:
+        case PixelFormat::RGB565:
+        case PixelFormat::RGBA4444:
+            return 16;
+        case PixelFormat::A4:
+        case PixelFormat::I4:
+            return 4;
+        case PixelFormat::A1:
+            return 1;
+        default:
+            return 8;
+        }
+    }
 
-            switch (pixelPerByte)
+    constexpr bool PixelConverter::IsIndexed(PixelFormat format)
+    {
+        return format == PixelFormat::I8 || format == PixelFormat::I4;
+    }
+
+    constexpr bool PixelConverter::HasDirectConversion(PixelFormat from, PixelFormat to)
+    {
+        for (const auto &conversion : defaultConversions)
+        {
+            if (conversion.from == from && conversion.to == to)
             {
-            case 4:
+                return true;
+            }
+        }
+        return false;
+    }
+
+    constexpr PixelConverter::ConvertFunc PixelConverter::FindConversion(PixelFormat from, PixelFormat to)
+    {
+        for (const auto &conversion : defaultConversions)
+        {
+            if (conversion.from == from && conversion.to == to)
+            {
+                return conversion.func;
+            }
+        }
+        return nullptr;
+    }
+
+    // one half of a conversion through ARGB8888, formats without a hand written kernel for it,
+    // like the premultiplied ones, use their PixelTraits
+    template <PixelFormat From, PixelFormat To>
+    constexpr bool PixelConverter::HasThroughARGB8888Kernel()
+    {
+        return HasDirectConversion(From, To) || (PixelTraits<From>::available && PixelTraits<To>::available);
+    }
+
+    template <PixelFormat From, PixelFormat To>
+    constexpr PixelConverter::ConvertFunc PixelConverter::ThroughARGB8888Kernel()
+    {
+        if constexpr (HasDirectConversion(From, To))
+            return FindConversion(From, To);
+        else if constexpr (PixelTraits<From>::available && PixelTraits<To>::available)
+            return ConvertPixels<From, To>;
+        else
+            return nullptr;
+    }
+
+    template <size_t From, size_t To>
+    constexpr PixelConverter::ConvertFunc PixelConverter::ResolveConversion()
+    {
+        constexpr PixelFormat from = static_cast<PixelFormat>(From);
+        constexpr PixelFormat to = static_cast<PixelFormat>(To);
+
+        if constexpr (From == To)
+        {
+            switch (BitsPerPixel(from))
+            {
+            case 32:
                 return Move4;
-                break;
-            case 3:
+            case 24:
                 return Move3;
-                break;
-            case 2:
+            case 16:
                 return Move2;
-                break;
+            case 4:
+                return MoveBits<4>;
             case 1:
+                return MoveBits<1>;
+            default:
                 return Move;
-                break;
+            }
+        }
+        else if constexpr (IsIndexed(from) || IsIndexed(to))
+        {
+            // the palette is part of the texture, not of the format
+            return nullptr;
+        }
+        else if constexpr (HasDirectConversion(from, to))
+        {
+            return FindConversion(from, to);
+        }
+        else if constexpr (PixelTraits<from>::available && PixelTraits<to>::available)
+        {
+            return ConvertPixels<from, to>;
+        }
+        else if constexpr (HasThroughARGB8888Kernel<from, PixelFormat::ARGB8888>() && HasThroughARGB8888Kernel<PixelFormat::ARGB8888, to>())
+        {
+            constexpr ConvertFunc toARGB8888 = ThroughARGB8888Kernel<from, PixelFormat::ARGB8888>();
+            constexpr ConvertFunc fromARGB8888 = ThroughARGB8888Kernel<PixelFormat::ARGB8888, to>();
+            return ConvertThroughARGB8888<toARGB8888, fromARGB8888, BitsPerPixel(from), BitsPerPixel(to)>;
+        }
+        else
+        {
+            static_assert(From == To, "every pixel format needs a conversion to and from ARGB8888");
+            return nullptr;
+        }
+    }
 
-            default:
-                break;
+    template <size_t... Indices>
+    constexpr std::array<PixelConverter::ConvertFunc, PIXELFORMATCOUNT * PIXELFORMATCOUNT> PixelConverter::BuildConversionTable(std::index_sequence<Indices...>)
+    {
+        return {ResolveConversion<Indices / PIXELFORMATCOUNT, Indices % PIXELFORMATCOUNT>()...};
+    }
+
+    constexpr std::array<PixelConverter::ConvertFunc, PIXELFORMATCOUNT * PIXELFORMATCOUNT> PixelConverter::conversionTable =
+        BuildConversionTable(std::make_index_sequence<PIXELFORMATCOUNT * PIXELFORMATCOUNT>());
+
+    void PixelConverter::Fill(uint8_t *dst, const uint8_t *pixel, size_t count, uint8_t bytesPerPixel)
+    {
+        if (bytesPerPixel == 2)
+        {
+            Fill2(dst, pixel, count);
+            return;
+        }
+        for (size_t i = 0; i < count; ++i, dst += bytesPerPixel)
+        {
+            std::memcpy(dst, pixel, bytesPerPixel);
+        }
+    }
+
+    template <uint8_t Bytes>
+    static void ReversePixels(const uint8_t *src, uint8_t *dst, size_t count)
+    {
+        src += count * Bytes;
+        for (size_t i = 0; i < count; ++i, dst += Bytes)
+        {
+            src -= Bytes;
+            std::memcpy(dst, src, Bytes);
+        }
+    }
+
+    void PixelConverter::Reverse(const uint8_t *src, uint8_t *dst, size_t count, uint8_t bytesPerPixel)
+    {
+        switch (bytesPerPixel)
+        {
+        case 1:
+            ReversePixels<1>(src, dst, count);
+            break;
+        case 2:
+            ReversePixels<2>(src, dst, count);
+            break;
+        case 3:
+            ReversePixels<3>(src, dst, count);
+            break;
+        default:
+            ReversePixels<4>(src, dst, count);
+            break;
+        }
+    }
+
+    PixelFormat PixelConverter::GetPremultipliedFormat(PixelFormat format)
+    {
+        switch (format)
+        {
+        case PixelFormat::ARGB8888:
+            return PixelFormat::ARGB8888_PRE;
+        case PixelFormat::RGBA8888:
+            return PixelFormat::RGBA8888_PRE;
+        default:
+            return format;
+        }
+    }
+
+    void PixelConverter::UnpackAlpha(PixelFormat format, const uint8_t *row, size_t x, uint8_t *dst, size_t count)
+    {
+        switch (format)
+        {
+        case PixelFormat::A4:
+            row += x / 2;
+            if ((x & 1) && count > 0)
+            {
+                *dst++ = (*row++ & 0x0F) * 17;
+                --count;
             }
+            A4ToA8(row, dst, count);
+            break;
+        case PixelFormat::A1:
+            row += x / 8;
+            // the rest of a partly used first byte
+            for (uint8_t bit = x % 8; bit != 0 && count > 0; bit = (bit + 1) % 8, --count)
+            {
+                *dst++ = (*row & (0x80 >> bit)) ? 255 : 0;
+                if (bit == 7)
+                    ++row;
+            }
+            A1ToA8(row, dst, count);
+            break;
+        default:
+            std::memcpy(dst, row + x, count);
+            break;
         }
-        for (const auto &conversion : defaultConversions)
+    }
+
+    template <uint8_t EntryBytes>
+    void PixelConverter::ExpandI8(const uint8_t *row, const uint8_t *palette, uint8_t *dst, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i, dst += EntryBytes)
         {
-            if (conversion.from == from && conversion.to == to)
+            std::memcpy(dst, palette + row[i] * EntryBytes, EntryBytes);
+        }
+    }
+
+    template <uint8_t EntryBytes>
+    void PixelConverter::ExpandI4(const uint8_t *row, const uint8_t *palette, uint8_t *dst, size_t count)
+    {
+        for (size_t i = 0; i + 1 < count; i += 2, ++row, dst += 2 * EntryBytes)
+        {
+            std::memcpy(dst, palette + (*row >> 4) * EntryBytes, EntryBytes);
+            std::memcpy(dst + EntryBytes, palette + (*row & 0x0F) * EntryBytes, EntryBytes);
+        }
+        if (count & 1)
+        {
+            std::memcpy(dst, palette + (*row >> 4) * EntryBytes, EntryBytes);
+        }
+    }
+
+    void PixelConverter::ExpandIndexed(PixelFormat format, const uint8_t *row, size_t x, const uint8_t *palette,
+                                       uint8_t entryBytes, uint8_t *dst, size_t count)
+    {
+        if (format == PixelFormat::I4)
+        {
+            row += x / 2;
+            if ((x & 1) && count > 0)
             {
-                return conversion.func;
+                std::memcpy(dst, palette + (*row++ & 0x0F) * entryBytes, entryBytes);
+                dst += entryBytes;
+                --count;
             }
         }
-        return nullptr;
+        else
+        {
+            row += x;
+        }
+
+        // the entry size is a template argument so every entry is copied with a single load and store
+        bool i4 = format == PixelFormat::I4;
+        switch (entryBytes)
+        {
+        case 1:
+            i4 ? ExpandI4<1>(row, palette, dst, count) : ExpandI8<1>(row, palette, dst, count);
+            break;
+        case 2:
+            i4 ? ExpandI4<2>(row, palette, dst, count) : ExpandI8<2>(row, palette, dst, count);
+            break;
+        case 3:
+            i4 ? ExpandI4<3>(row, palette, dst, count) : ExpandI8<3>(row, palette, dst, count);
+            break;
+        default:
+            i4 ? ExpandI4<4>(row, palette, dst, count) : ExpandI8<4>(row, palette, dst, count);
+            break;
+        }
+    }
+
+    void PixelConverter::A4ToA8(const uint8_t *src, uint8_t *dst, size_t count)
+    {
+        for (size_t i = 0; i + 1 < count; i += 2, ++src)
+        {
+            dst[i] = (*src >> 4) * 17;
+            dst[i + 1] = (*src & 0x0F) * 17;
+        }
+        if (count & 1)
+        {
+            dst[count - 1] = (*src >> 4) * 17;
+        }
+    }
+
+    void PixelConverter::A1ToA8(const uint8_t *src, uint8_t *dst, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            // 0 - (bit) is 0x00 or 0xFF
+            dst[i] = static_cast<uint8_t>(0 - ((src[i / 8] >> (7 - i % 8)) & 1));
+        }
+    }
+
+    void PixelConverter::A8ToA4(const uint8_t *src, uint8_t *dst, size_t count)
+    {
+        for (size_t i = 0; i + 1 < count; i += 2, ++dst)
+        {
+            *dst = (src[i] & 0xF0) | (src[i + 1] >> 4);
+        }
+        if (count & 1)
+        {
+            // the unused low nibble keeps its value, the row next to it may share the byte
+            *dst = (src[count - 1] & 0xF0) | (*dst & 0x0F);
+        }
+    }
+
+    void PixelConverter::A8ToA1(const uint8_t *src, uint8_t *dst, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8, ++dst)
+        {
+            uint8_t bits = 0;
+            for (int b = 0; b < 8; ++b)
+            {
+                bits |= (src[i + b] >> 7) << (7 - b);
+            }
+            *dst = bits;
+        }
+        if (i < count)
+        {
+            // unused low bits keep their value
+            uint8_t mask = static_cast<uint8_t>(0xFF00 >> (count - i));
+            uint8_t bits = 0;
+            for (int b = 0; i + b < count; ++b)
+            {
+                bits |= (src[i + b] >> 7) << (7 - b);
+            }
+            *dst = bits | (*dst & ~mask);
+        }
+    }
+
+    void PixelConverter::A4ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
+    {
+        uint8_t alpha[CONVERSIONCHUNKSIZE];
+        while (count > 0)
+        {
+            size_t chunk = std::min<size_t>(count, CONVERSIONCHUNKSIZE);
+            A4ToA8(src, alpha, chunk);
+            ConvertPixels<PixelFormat::A8, PixelFormat::ARGB8888>(alpha, dst, chunk);
+            src += chunk / 2;
+            dst += chunk * 4;
+            count -= chunk;
+        }
+    }
+
+    void PixelConverter::A1ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
+    {
+        uint8_t alpha[CONVERSIONCHUNKSIZE];
+        while (count > 0)
+        {
+            size_t chunk = std::min<size_t>(count, CONVERSIONCHUNKSIZE);
+            A1ToA8(src, alpha, chunk);
+            ConvertPixels<PixelFormat::A8, PixelFormat::ARGB8888>(alpha, dst, chunk);
+            src += chunk / 8;
+            dst += chunk * 4;
+            count -= chunk;
+        }
+    }
+
+    void PixelConverter::ARGB8888ToA4(const uint8_t *src, uint8_t *dst, size_t count)
+    {
+        uint8_t alpha[CONVERSIONCHUNKSIZE];
+        while (count > 0)
+        {
+            size_t chunk = std::min<size_t>(count, CONVERSIONCHUNKSIZE);
+            ConvertPixels<PixelFormat::ARGB8888, PixelFormat::A8>(src, alpha, chunk);
+            A8ToA4(alpha, dst, chunk);
+            src += chunk * 4;
+            dst += chunk / 2;
+            count -= chunk;
+        }
+    }
+
+    void PixelConverter::ARGB8888ToA1(const uint8_t *src, uint8_t *dst, size_t count)
+    {
+        uint8_t alpha[CONVERSIONCHUNKSIZE];
+        while (count > 0)
+        {
+            size_t chunk = std::min<size_t>(count, CONVERSIONCHUNKSIZE);
+            ConvertPixels<PixelFormat::ARGB8888, PixelFormat::A8>(src, alpha, chunk);
+            A8ToA1(alpha, dst, chunk);
+            src += chunk * 4;
+            dst += chunk / 8;
+            count -= chunk;
+        }
     }
 
     void PixelConverter::Convert(PixelFormat from, PixelFormat to, const uint8_t *src, uint8_t *dst, size_t count)
@@ -3,8 +3,14 @@
 
 #include "PixelFormat.h"
 #include <cstring>
+#include <cstddef>
 #include <stdexcept>
 #include <cstdint>
+#include <array>
+#include <utility>
+
+// pixels a composed conversion converts at once through its intermediate buffer
+#define CONVERSIONCHUNKSIZE 64
 
 namespace Tergos2D
 {
@@ -13,12 +19,49 @@ namespace Tergos2D
     public:
         using ConvertFunc = void (*)(const uint8_t *src, uint8_t *dst, size_t count);
 
-        // Get the conversion function from one format to another
-        static ConvertFunc GetConversionFunction(PixelFormat from, PixelFormat to);
+        // Get the conversion function from one format to another, every pair has one except the
+        // indexed formats, which only copy to themselves and are expanded with ExpandIndexed
+        static ConvertFunc GetConversionFunction(PixelFormat from, PixelFormat to)
+        {
+            return conversionTable[static_cast<size_t>(from) * PIXELFORMATCOUNT + static_cast<size_t>(to)];
+        }
 
         // Convert pixels using cached function pointer and batch processing
         static void Convert(PixelFormat from, PixelFormat to, const uint8_t *src, uint8_t *dst, size_t count = 1);
 
+        // Write count copies of one pixel
+        static void Fill(uint8_t *dst, const uint8_t *pixel, size_t count, uint8_t bytesPerPixel);
+
+        // writes height rows of width pixels where pixel x of target row y is pixel y of source row x, in
+        // tiles so the source rows of a tile stay in cache. A negative pitch walks the rows upwards, which
+        // turns the transpose into a rotation by 90 or 270 degrees
+        static void Transpose(const uint8_t *src, ptrdiff_t srcPitch, uint8_t *dst, ptrdiff_t dstPitch,
+                              size_t width, size_t height, uint8_t bytesPerPixel);
+
+        // copies count pixels in reverse order, the last source pixel becomes the first target pixel
+        static void Reverse(const uint8_t *src, uint8_t *dst, size_t count, uint8_t bytesPerPixel);
+
+        // premultiplied counterpart of ARGB8888 and RGBA8888, every other format is returned as is
+        static PixelFormat GetPremultipliedFormat(PixelFormat format);
+
+        // expands count pixels of an A8, A4 or A1 row to A8 starting at pixel x, bit formats can start
+        // inside a byte
+        static void UnpackAlpha(PixelFormat format, const uint8_t *row, size_t x, uint8_t *dst, size_t count);
+
+        // looks up count pixels of an I8 or I4 row starting at pixel x in palette and writes the
+        // entries, entryBytes is 1 to 4 so a palette converted to the target format can be expanded
+        // straight into a target row
+        static void ExpandIndexed(PixelFormat format, const uint8_t *row, size_t x, const uint8_t *palette,
+                                  uint8_t entryBytes, uint8_t *dst, size_t count);
+
+        // palette index of pixel x of an I8 or I4 row
+        static inline uint8_t ReadIndex(PixelFormat format, const uint8_t *row, size_t x)
+        {
+            if (format == PixelFormat::I4)
+                return (x & 1) ? (row[x / 2] & 0x0F) : (row[x / 2] >> 4);
+            return row[x];
+        }
+
     private:
         struct Conversion
         {
@@ -31,6 +74,34 @@ namespace Tergos2D
         static void Move2(const uint8_t *src, uint8_t *dst, size_t count);
         static void Move3(const uint8_t *src, uint8_t *dst, size_t count);
         static void Move4(const uint8_t *src, uint8_t *dst, size_t count);
+        static void Fill2(uint8_t *dst, const uint8_t *pixel, size_t count);
+        template <uint8_t Bits>
+        static void MoveBits(const uint8_t *src, uint8_t *dst, size_t count);
+        template <uint8_t EntryBytes>
+        static void ExpandI8(const uint8_t *row, const uint8_t *palette, uint8_t *dst, size_t count);
+        template <uint8_t EntryBytes>
+        static void ExpandI4(const uint8_t *row, const uint8_t *palette, uint8_t *dst, size_t count);
+
+        // runs ToARGB8888 and FromARGB8888 chunk by chunk, the intermediate pixels stay on the stack,
+        // CONVERSIONCHUNKSIZE is a multiple of 8 so chunks of bit formats start on a byte
+        template <ConvertFunc ToARGB8888, ConvertFunc FromARGB8888, uint8_t SourceBits, uint8_t TargetBits>
+        static void ConvertThroughARGB8888(const uint8_t *src, uint8_t *dst, size_t count);
+
+        // conversionTable is built from these at compile time
+        static constexpr uint8_t BitsPerPixel(PixelFormat format);
+        static constexpr bool IsIndexed(PixelFormat format);
+        // the lookups branch on bools, comparing function pointers is no constant expression once
+        // -fsanitize=undefined instruments them
+        static constexpr bool HasDirectConversion(PixelFormat from, PixelFormat to);
+        static constexpr ConvertFunc FindConversion(PixelFormat from, PixelFormat to);
+        template <PixelFormat From, PixelFormat To>
+        static constexpr bool HasThroughARGB8888Kernel();
+        template <PixelFormat From, PixelFormat To>
+        static constexpr ConvertFunc ThroughARGB8888Kernel();
+        template <size_t From, size_t To>
+        static constexpr ConvertFunc ResolveConversion();
+        template <size_t... Indices>
+        static constexpr std::array<ConvertFunc, PIXELFORMATCOUNT * PIXELFORMATCOUNT> BuildConversionTable(std::index_sequence<Indices...>);
 
         // BGR24 Conversions
         static void BGR24ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count);
@@ -84,6 +155,16 @@ namespace Tergos2D
         static void Grayscale8ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count);
         static void Grayscale8ToRGB565(const uint8_t *src, uint8_t *dst, size_t count);
 
+        // alpha mask conversions, masks expand to white so the tint colour multiplies through
+        static void A4ToA8(const uint8_t *src, uint8_t *dst, size_t count);
+        static void A1ToA8(const uint8_t *src, uint8_t *dst, size_t count);
+        static void A8ToA4(const uint8_t *src, uint8_t *dst, size_t count);
+        static void A8ToA1(const uint8_t *src, uint8_t *dst, size_t count);
+        static void A4ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count);
+        static void A1ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count);
+        static void ARGB8888ToA4(const uint8_t *src, uint8_t *dst, size_t count);
+        static void ARGB8888ToA1(const uint8_t *src, uint8_t *dst, size_t count);
+
 
         // Conversion mappings
         static constexpr Conversion defaultConversions[] = {
@@ -139,7 +220,26 @@ namespace Tergos2D
             {PixelFormat::GRAYSCALE8, PixelFormat::ARGB8888,Grayscale8ToARGB8888},
             {PixelFormat::GRAYSCALE8, PixelFormat::RGB565,Grayscale8ToRGB565},
 
+            // premultiplied formats only differ in the channel order, everything else goes through PixelTraits
+            {PixelFormat::ARGB8888_PRE, PixelFormat::RGBA8888_PRE, ARGB8888ToRGBA8888},
+            {PixelFormat::RGBA8888_PRE, PixelFormat::ARGB8888_PRE, RGBA8888ToARGB8888},
+
+            // alpha masks, A8 has PixelTraits, the bit formats are packed and composed through ARGB8888
+            {PixelFormat::A4, PixelFormat::A8, A4ToA8},
+            {PixelFormat::A1, PixelFormat::A8, A1ToA8},
+            {PixelFormat::A8, PixelFormat::A4, A8ToA4},
+            {PixelFormat::A8, PixelFormat::A1, A8ToA1},
+            {PixelFormat::A4, PixelFormat::ARGB8888, A4ToARGB8888},
+            {PixelFormat::A1, PixelFormat::ARGB8888, A1ToARGB8888},
+            {PixelFormat::ARGB8888, PixelFormat::A4, ARGB8888ToA4},
+            {PixelFormat::ARGB8888, PixelFormat::A1, ARGB8888ToA1},
+
         };
+
+        // [from * PIXELFORMATCOUNT + to], same format pairs copy, pairs without an entry in
+        // defaultConversions use the ConvertPixels kernel generated from PixelTraits, formats
+        // without traits are composed through ARGB8888
+        static const std::array<ConvertFunc, PIXELFORMATCOUNT * PIXELFORMATCOUNT> conversionTable;
     };
 }
 
@@ -1,6 +1,8 @@
 #ifndef PIXELFORMAT_H
 #define PIXELFORMAT_H
 
+#include <stddef.h>
+
 namespace Tergos2D
 {
 
@@ -14,9 +16,19 @@ namespace Tergos2D
         RGB565, // 16 bits: 5 bits R, 6 bits G, 5 bits B
         RGBA4444,
         GRAYSCALE8, // 8 bits grayscale
+        ARGB8888_PRE, // ARGB8888 with the colour channels multiplied by alpha
+        RGBA8888_PRE, // RGBA8888 with the colour channels multiplied by alpha
+        A8, // 8 bit alpha mask, drawn in the tint colour
+        A4, // 4 bit alpha mask, two pixels per byte, first pixel in the high nibble
+        A1, // 1 bit alpha mask, eight pixels per byte, first pixel in the highest bit
+        I8, // 8 bit index into the ARGB8888 palette of the texture
+        I4, // 4 bit palette index, two pixels per byte, first pixel in the high nibble
 
     };
 
+    // number of formats, tables indexed by format use it, new formats have to be added before this
+    constexpr size_t PIXELFORMATCOUNT = static_cast<size_t>(PixelFormat::I4) + 1;
+
 }
 
 #endif //  PIXELFORMAT_H
@@ -11,7 +11,17 @@ namespace Tergos2D
         {PixelFormat::ARGB1555, 2, 0, false, 4, true, "RGBA1555", 0x7C00, 10, 0x03E0, 5, 0x001F, 0, 0x8000, 15},
       {PixelFormat::RGB565, 2, 0, false, 3, false, "RGB565", 0xF800, 11, 0x07E0, 5, 0x001F, 0},
         {PixelFormat::RGBA4444, 2, 0, false, 4, true, "RGBA4444", 0xF000, 12, 0x0F00, 8, 0x00F0, 4, 0x000F, 0},
+        // no alpha channel, but blending uses grayscale as a mask with black transparent, so blended
+        // draws have to go through the blend kernels and don't cover what is below
         {PixelFormat::GRAYSCALE8, 1, 0, false, 1, true, "Grayscale8", 0xFF, 0, 0x00, 0, 0x00, 0},
+        {PixelFormat::ARGB8888_PRE, 4, 0, false, 4, true, "ARGB8888_PRE", 0xFF, 16, 0xFF, 8, 0xFF, 0, 0xFF, 0, true},
+        {PixelFormat::RGBA8888_PRE, 4, 0, false, 4, true, "RGBA8888_PRE", 0xFF, 24, 0xFF, 16, 0xFF, 8, 0xFF, 24, true},
+        {PixelFormat::A8, 1, 0, false, 1, true, "A8", 0x00, 0, 0x00, 0, 0x00, 0, 0xFF, 0},
+        {PixelFormat::A4, 0, 4, true, 1, true, "A4", 0x00, 0, 0x00, 0, 0x00, 0, 0x0F, 0},
+        {PixelFormat::A1, 0, 1, true, 1, true, "A1", 0x00, 0, 0x00, 0, 0x00, 0, 0x01, 0},
+        // alpha depends on the palette, the renderers take it from the texture
+        {PixelFormat::I8, 1, 0, false, 4, true, "I8", 0x00, 0, 0x00, 0, 0x00, 0, 0x00, 0, false, true},
+        {PixelFormat::I4, 0, 4, true, 4, true, "I4", 0x00, 0, 0x00, 0, 0x00, 0, 0x00, 0, false, true},
     };
 
     const PixelFormatInfo &PixelFormatRegistry::GetInfo(PixelFormat format)
@@ -11,11 +11,13 @@ namespace Tergos2D
     struct PixelFormatInfo
     {
         PixelFormat format;    // The pixel format
-        uint8_t bytesPerPixel; // Number of bytes per pixel
+        uint8_t bytesPerPixel; // Number of bytes per pixel, 1 for bit formats
         uint8_t bitsPerPixel;  // how many bits per pixel
-        bool isBitFormat;      // uses less then one byte per pixel (grayscale 4 or grayscale 1)
+        bool isBitFormat;      // uses less then one byte per pixel (A4, A1 or I4), rows are packed
         uint8_t numChannels;   // Number of color channels
         bool hasAlpha;         // Whether the format includes an alpha channel
+        bool isPremultiplied;  // colour channels are stored multiplied by alpha
+        bool isIndexed;        // pixels are indices into the palette of the texture (I8 or I4)
         const char *name;      // A human-readable name for the format
 
         // Bit masks and shifts for each channel
@@ -28,13 +30,15 @@ namespace Tergos2D
                         uint16_t redMask, uint8_t redShift,
                         uint16_t greenMask, uint8_t greenShift,
                         uint16_t blueMask, uint8_t blueShift,
-                        uint16_t alphaMask = 0, uint8_t alphaShift = 0)
+                        uint16_t alphaMask = 0, uint8_t alphaShift = 0, bool premultiplied = false, bool indexed = false)
             : format(format),
             bytesPerPixel(bpp),
             bitsPerPixel(bitspp),
             isBitFormat(isBitFormat),
             numChannels(channels),
             hasAlpha(alpha),
+            isPremultiplied(premultiplied),
+            isIndexed(indexed),
             name(name),
             redMask(redMask),
             greenMask(greenMask),
@@ -47,7 +51,8 @@ namespace Tergos2D
         {
             if (isBitFormat)
             {
-                bytesPerPixel = bitsPerPixel % 8;
+                // the byte holding the pixel, code stepping through bit formats has to use bitsPerPixel
+                bytesPerPixel = 1;
             }
             else
             {
@@ -0,0 +1,220 @@
+#ifndef PIXELTRAITS_H
+#define PIXELTRAITS_H
+
+#include "PixelFormat.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+
+namespace Tergos2D
+{
+    // one pixel expanded to 8 bits per channel
+    struct PixelARGB
+    {
+        uint8_t a, r, g, b;
+    };
+
+    // Load and Store of a single pixel, compile time counterparts of the PixelConverter kernels.
+    // Load expands like <Format>ToARGB8888 and Store packs like ARGB8888To<Format>, so a kernel
+    // built from them gives the same result as converting through ARGB8888. Premultiplied formats
+    // are loaded straight and stored premultiplied.
+    template <PixelFormat Format>
+    struct PixelTraits
+    {
+        static constexpr bool available = false;
+    };
+
+    template <>
+    struct PixelTraits<PixelFormat::RGB24>
+    {
+        static constexpr bool available = true;
+        static constexpr uint8_t bytesPerPixel = 3;
+        static inline PixelARGB Load(const uint8_t *src) { return {255, src[0], src[1], src[2]}; }
+        static inline void Store(uint8_t *dst, PixelARGB pixel)
+        {
+            dst[0] = pixel.r;
+            dst[1] = pixel.g;
+            dst[2] = pixel.b;
+        }
+    };
+
+    template <>
+    struct PixelTraits<PixelFormat::BGR24>
+    {
+        static constexpr bool available = true;
+        static constexpr uint8_t bytesPerPixel = 3;
+        static inline PixelARGB Load(const uint8_t *src) { return {255, src[2], src[1], src[0]}; }
+        static inline void Store(uint8_t *dst, PixelARGB pixel)
+        {
+            dst[0] = pixel.b;
+            dst[1] = pixel.g;
+            dst[2] = pixel.r;
+        }
+    };
+
+    template <>
+    struct PixelTraits<PixelFormat::ARGB8888>
+    {
+        static constexpr bool available = true;
+        static constexpr uint8_t bytesPerPixel = 4;
+        static inline PixelARGB Load(const uint8_t *src) { return {src[0], src[1], src[2], src[3]}; }
+        static inline void Store(uint8_t *dst, PixelARGB pixel)
+        {
+            dst[0] = pixel.a;
+            dst[1] = pixel.r;
+            dst[2] = pixel.g;
+            dst[3] = pixel.b;
+        }
+    };
+
+    template <>
+    struct PixelTraits<PixelFormat::RGBA8888>
+    {
+        static constexpr bool available = true;
+        static constexpr uint8_t bytesPerPixel = 4;
+        static inline PixelARGB Load(const uint8_t *src) { return {src[3], src[0], src[1], src[2]}; }
+        static inline void Store(uint8_t *dst, PixelARGB pixel)
+        {
+            dst[0] = pixel.r;
+            dst[1] = pixel.g;
+            dst[2] = pixel.b;
+            dst[3] = pixel.a;
+        }
+    };
+
+    template <>
+    struct PixelTraits<PixelFormat::ARGB1555>
+    {
+        static constexpr bool available = true;
+        static constexpr uint8_t bytesPerPixel = 2;
+        static inline PixelARGB Load(const uint8_t *src)
+        {
+            uint16_t pixel = *reinterpret_cast<const uint16_t *>(src);
+            return {static_cast<uint8_t>((pixel & 0x8000) ? 255 : 0), static_cast<uint8_t>((pixel & 0x7C00) >> 7),
+                    static_cast<uint8_t>((pixel & 0x03E0) >> 2), static_cast<uint8_t>((pixel & 0x001F) << 3)};
+        }
+        static inline void Store(uint8_t *dst, PixelARGB pixel)
+        {
+            uint16_t a = pixel.a >= 128 ? 0x8000 : 0;
+            *reinterpret_cast<uint16_t *>(dst) = a | ((pixel.r >> 3) << 10) | ((pixel.g >> 3) << 5) | (pixel.b >> 3);
+        }
+    };
+
+    template <>
+    struct PixelTraits<PixelFormat::RGB565>
+    {
+        static constexpr bool available = true;
+        static constexpr uint8_t bytesPerPixel = 2;
+        static inline PixelARGB Load(const uint8_t *src)
+        {
+            uint16_t pixel = *reinterpret_cast<const uint16_t *>(src);
+            uint8_t r = (pixel >> 11) & 0x1F;
+            uint8_t g = (pixel >> 5) & 0x3F;
+            uint8_t b = pixel & 0x1F;
+            return {255, static_cast<uint8_t>((r << 3) | (r >> 2)), static_cast<uint8_t>((g << 2) | (g >> 4)),
+                    static_cast<uint8_t>((b << 3) | (b >> 2))};
+        }
+        static inline void Store(uint8_t *dst, PixelARGB pixel)
+        {
+            *reinterpret_cast<uint16_t *>(dst) = ((pixel.r >> 3) << 11) | ((pixel.g >> 2) << 5) | (pixel.b >> 3);
+        }
+    };
+
+    template <>
+    struct PixelTraits<PixelFormat::RGBA4444>
+    {
+        static constexpr bool available = true;
+        static constexpr uint8_t bytesPerPixel = 2;
+        static inline PixelARGB Load(const uint8_t *src)
+        {
+            uint16_t pixel = *reinterpret_cast<const uint16_t *>(src);
+            return {static_cast<uint8_t>((pixel & 0x000F) << 4), static_cast<uint8_t>((pixel & 0xF000) >> 8),
+                    static_cast<uint8_t>((pixel & 0x0F00) >> 4), static_cast<uint8_t>(pixel & 0x00F0)};
+        }
+        static inline void Store(uint8_t *dst, PixelARGB pixel)
+        {
+            *reinterpret_cast<uint16_t *>(dst) = ((pixel.r >> 4) << 12) | ((pixel.g >> 4) << 8) | ((pixel.b >> 4) << 4) | (pixel.a >> 4);
+        }
+    };
+
+    template <>
+    struct PixelTraits<PixelFormat::GRAYSCALE8>
+    {
+        static constexpr bool available = true;
+        static constexpr uint8_t bytesPerPixel = 1;
+        // converted grayscale is opaque, only the blend kernels use it as a mask with black transparent
+        static inline PixelARGB Load(const uint8_t *src) { return {255, src[0], src[0], src[0]}; }
+        static inline void Store(uint8_t *dst, PixelARGB pixel)
+        {
+            dst[0] = static_cast<uint8_t>(0.299f * pixel.r + 0.587f * pixel.g + 0.114f * pixel.b);
+        }
+    };
+
+    template <>
+    struct PixelTraits<PixelFormat::A8>
+    {
+        static constexpr bool available = true;
+        static constexpr uint8_t bytesPerPixel = 1;
+        static inline PixelARGB Load(const uint8_t *src) { return {src[0], 255, 255, 255}; }
+        static inline void Store(uint8_t *dst, PixelARGB pixel) { dst[0] = pixel.a; }
+    };
+
+    // colour channels times alpha, rounded
+    static inline uint8_t PremultiplyChannel(uint8_t channel, uint8_t alpha)
+    {
+        return static_cast<uint8_t>((channel * alpha + 127) / 255);
+    }
+
+    static inline uint8_t UnpremultiplyChannel(uint8_t channel, uint8_t alpha)
+    {
+        return alpha == 0 ? 0 : static_cast<uint8_t>(std::min((channel * 255 + alpha / 2) / alpha, 255));
+    }
+
+    template <>
+    struct PixelTraits<PixelFormat::ARGB8888_PRE>
+    {
+        static constexpr bool available = true;
+        static constexpr uint8_t bytesPerPixel = 4;
+        static inline PixelARGB Load(const uint8_t *src)
+        {
+            return {src[0], UnpremultiplyChannel(src[1], src[0]), UnpremultiplyChannel(src[2], src[0]), UnpremultiplyChannel(src[3], src[0])};
+        }
+        static inline void Store(uint8_t *dst, PixelARGB pixel)
+        {
+            dst[0] = pixel.a;
+            dst[1] = PremultiplyChannel(pixel.r, pixel.a);
+            dst[2] = PremultiplyChannel(pixel.g, pixel.a);
+            dst[3] = PremultiplyChannel(pixel.b, pixel.a);
+        }
+    };
+
+    template <>
+    struct PixelTraits<PixelFormat::RGBA8888_PRE>
+    {
+        static constexpr bool available = true;
+        static constexpr uint8_t bytesPerPixel = 4;
+        static inline PixelARGB Load(const uint8_t *src)
+        {
+            return {src[3], UnpremultiplyChannel(src[0], src[3]), UnpremultiplyChannel(src[1], src[3]), UnpremultiplyChannel(src[2], src[3])};
+        }
+        static inline void Store(uint8_t *dst, PixelARGB pixel)
+        {
+            dst[0] = PremultiplyChannel(pixel.r, pixel.a);
+            dst[1] = PremultiplyChannel(pixel.g, pixel.a);
+            dst[2] = PremultiplyChannel(pixel.b, pixel.a);
+            dst[3] = pixel.a;
+        }
+    };
+
+    // converts count pixels in one pass, for the pairs PixelConverter has no hand written kernel for
+    template <PixelFormat From, PixelFormat To>
+    void ConvertPixels(const uint8_t *src, uint8_t *dst, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i, src += PixelTraits<From>::bytesPerPixel, dst += PixelTraits<To>::bytesPerPixel)
+        {
+            PixelTraits<To>::Store(dst, PixelTraits<From>::Load(src));
+        }
+    }
+}
+
+#endif // !PIXELTRAITS_H
@@ -2,6 +2,7 @@
 #include <arm_neon.h>
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <cstdint>
 #include <cstddef>
 
@@ -440,10 +441,10 @@ void PixelConverter::Grayscale8ToARGB8888(const uint8_t *src, uint8_t *dst, size
     {
         uint8x8_t gray = vld1_u8(src + i);
         uint8x8x4_t argb;
-        argb.val[0] = gray;
+        argb.val[0] = vdup_n_u8(255);
         argb.val[1] = gray;
         argb.val[2] = gray;
-        argb.val[3] = vdup_n_u8(255);
+        argb.val[3] = gray;
         vst4_u8(dst + i * 4, argb);
     }
 
@@ -512,10 +513,8 @@ void Tergos2D::PixelConverter::RGBA8888ToRGB565(const uint8_t * src, uint8_t * d
         uint8_t g = src[i * 4 + 1];
         uint8_t b = src[i * 4 + 2];
 
-        uint16_t rgb565 = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-
-        dst[i * 2] = (rgb565 >> 8) & 0xFF;
-        dst[i * 2 + 1] = rgb565 & 0xFF;
+        // native byte order like ARGB8888ToRGB565 and the RGB565 blend kernels
+        reinterpret_cast<uint16_t *>(dst)[i] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
     }
 }
 
@@ -560,4 +559,135 @@ void Tergos2D::PixelConverter::Grayscale8ToRGB565(const uint8_t * src, uint8_t *
         dst[i * 2] = (rgb565 >> 8) & 0xFF;
         dst[i * 2 + 1] = rgb565 & 0xFF;
     }
-}
\ No newline at end of file
+}
+
+// 8 x 8 blocks of one byte pixels, three rounds of trn swap 1, 2 and then 4 byte pairs between rows
+static inline void Transpose8x8x1(const uint8_t *src, ptrdiff_t srcPitch, uint8_t *dst, ptrdiff_t dstPitch)
+{
+    uint8x8x2_t a01 = vtrn_u8(vld1_u8(src), vld1_u8(src + srcPitch));
+    uint8x8x2_t a23 = vtrn_u8(vld1_u8(src + 2 * srcPitch), vld1_u8(src + 3 * srcPitch));
+    uint8x8x2_t a45 = vtrn_u8(vld1_u8(src + 4 * srcPitch), vld1_u8(src + 5 * srcPitch));
+    uint8x8x2_t a67 = vtrn_u8(vld1_u8(src + 6 * srcPitch), vld1_u8(src + 7 * srcPitch));
+
+    uint16x4x2_t b02 = vtrn_u16(vreinterpret_u16_u8(a01.val[0]), vreinterpret_u16_u8(a23.val[0]));
+    uint16x4x2_t b13 = vtrn_u16(vreinterpret_u16_u8(a01.val[1]), vreinterpret_u16_u8(a23.val[1]));
+    uint16x4x2_t b46 = vtrn_u16(vreinterpret_u16_u8(a45.val[0]), vreinterpret_u16_u8(a67.val[0]));
+    uint16x4x2_t b57 = vtrn_u16(vreinterpret_u16_u8(a45.val[1]), vreinterpret_u16_u8(a67.val[1]));
+
+    uint32x2x2_t c04 = vtrn_u32(vreinterpret_u32_u16(b02.val[0]), vreinterpret_u32_u16(b46.val[0]));
+    uint32x2x2_t c26 = vtrn_u32(vreinterpret_u32_u16(b02.val[1]), vreinterpret_u32_u16(b46.val[1]));
+    uint32x2x2_t c15 = vtrn_u32(vreinterpret_u32_u16(b13.val[0]), vreinterpret_u32_u16(b57.val[0]));
+    uint32x2x2_t c37 = vtrn_u32(vreinterpret_u32_u16(b13.val[1]), vreinterpret_u32_u16(b57.val[1]));
+
+    vst1_u8(dst, vreinterpret_u8_u32(c04.val[0]));
+    vst1_u8(dst + dstPitch, vreinterpret_u8_u32(c15.val[0]));
+    vst1_u8(dst + 2 * dstPitch, vreinterpret_u8_u32(c26.val[0]));
+    vst1_u8(dst + 3 * dstPitch, vreinterpret_u8_u32(c37.val[0]));
+    vst1_u8(dst + 4 * dstPitch, vreinterpret_u8_u32(c04.val[1]));
+    vst1_u8(dst + 5 * dstPitch, vreinterpret_u8_u32(c15.val[1]));
+    vst1_u8(dst + 6 * dstPitch, vreinterpret_u8_u32(c26.val[1]));
+    vst1_u8(dst + 7 * dstPitch, vreinterpret_u8_u32(c37.val[1]));
+}
+
+// 8 x 8 blocks of two byte pixels, trn swaps 2 and 4 byte pairs, the 8 byte halves are combined last
+static inline void Transpose8x8x2(const uint8_t *src, ptrdiff_t srcPitch, uint8_t *dst, ptrdiff_t dstPitch)
+{
+    auto row = [&](int i) { return vld1q_u16(reinterpret_cast<const uint16_t *>(src + i * srcPitch)); };
+    uint16x8x2_t a01 = vtrnq_u16(row(0), row(1));
+    uint16x8x2_t a23 = vtrnq_u16(row(2), row(3));
+    uint16x8x2_t a45 = vtrnq_u16(row(4), row(5));
+    uint16x8x2_t a67 = vtrnq_u16(row(6), row(7));
+
+    uint32x4x2_t b02 = vtrnq_u32(vreinterpretq_u32_u16(a01.val[0]), vreinterpretq_u32_u16(a23.val[0]));
+    uint32x4x2_t b13 = vtrnq_u32(vreinterpretq_u32_u16(a01.val[1]), vreinterpretq_u32_u16(a23.val[1]));
+    uint32x4x2_t b46 = vtrnq_u32(vreinterpretq_u32_u16(a45.val[0]), vreinterpretq_u32_u16(a67.val[0]));
+    uint32x4x2_t b57 = vtrnq_u32(vreinterpretq_u32_u16(a45.val[1]), vreinterpretq_u32_u16(a67.val[1]));
+
+    auto store = [&](int i, uint32x2_t low, uint32x2_t high)
+    {
+        vst1q_u16(reinterpret_cast<uint16_t *>(dst + i * dstPitch), vreinterpretq_u16_u32(vcombine_u32(low, high)));
+    };
+    store(0, vget_low_u32(b02.val[0]), vget_low_u32(b46.val[0]));
+    store(1, vget_low_u32(b13.val[0]), vget_low_u32(b57.val[0]));
+    store(2, vget_low_u32(b02.val[1]), vget_low_u32(b46.val[1]));
+    store(3, vget_low_u32(b13.val[1]), vget_low_u32(b57.val[1]));
+    store(4, vget_high_u32(b02.val[0]), vget_high_u32(b46.val[0]));
+    store(5, vget_high_u32(b13.val[0]), vget_high_u32(b57.val[0]));
+    store(6, vget_high_u32(b02.val[1]), vget_high_u32(b46.val[1]));
+    store(7, vget_high_u32(b13.val[1]), vget_high_u32(b57.val[1]));
+}
+
+// 4 x 4 blocks of four byte pixels, four of them make an 8 x 8 tile
+static inline void Transpose4x4x4(const uint8_t *src, ptrdiff_t srcPitch, uint8_t *dst, ptrdiff_t dstPitch)
+{
+    auto row = [&](int i) { return vld1q_u32(reinterpret_cast<const uint32_t *>(src + i * srcPitch)); };
+    uint32x4x2_t a01 = vtrnq_u32(row(0), row(1));
+    uint32x4x2_t a23 = vtrnq_u32(row(2), row(3));
+
+    auto store = [&](int i, uint32x2_t low, uint32x2_t high)
+    {
+        vst1q_u32(reinterpret_cast<uint32_t *>(dst + i * dstPitch), vcombine_u32(low, high));
+    };
+    store(0, vget_low_u32(a01.val[0]), vget_low_u32(a23.val[0]));
+    store(1, vget_low_u32(a01.val[1]), vget_low_u32(a23.val[1]));
+    store(2, vget_high_u32(a01.val[0]), vget_high_u32(a23.val[0]));
+    store(3, vget_high_u32(a01.val[1]), vget_high_u32(a23.val[1]));
+}
+
+static inline void Transpose8x8x4(const uint8_t *src, ptrdiff_t srcPitch, uint8_t *dst, ptrdiff_t dstPitch)
+{
+    Transpose4x4x4(src, srcPitch, dst, dstPitch);
+    Transpose4x4x4(src + 16, srcPitch, dst + 4 * dstPitch, dstPitch);
+    Transpose4x4x4(src + 4 * srcPitch, srcPitch, dst + 16, dstPitch);
+    Transpose4x4x4(src + 4 * srcPitch + 16, srcPitch, dst + 4 * dstPitch + 16, dstPitch);
+}
+
+// 8 x 8 tiles, the eight source rows a tile reads stay in cache while its eight target rows are written.
+// Full tiles go through FullTile, the tiles at the right and bottom edge and 3 byte pixels are copied
+// one pixel at a time
+template <uint8_t Bytes, void (*FullTile)(const uint8_t *, ptrdiff_t, uint8_t *, ptrdiff_t)>
+static void TransposeTiles(const uint8_t *src, ptrdiff_t srcPitch, uint8_t *dst, ptrdiff_t dstPitch, ptrdiff_t width, ptrdiff_t height)
+{
+    for (ptrdiff_t tileY = 0; tileY < height; tileY += 8)
+    {
+        ptrdiff_t rows = height - tileY < 8 ? height - tileY : 8;
+        for (ptrdiff_t tileX = 0; tileX < width; tileX += 8)
+        {
+            ptrdiff_t columns = width - tileX < 8 ? width - tileX : 8;
+            const uint8_t *from = src + tileX * srcPitch + tileY * Bytes;
+            uint8_t *to = dst + tileY * dstPitch + tileX * Bytes;
+            if (FullTile && rows == 8 && columns == 8)
+            {
+                FullTile(from, srcPitch, to, dstPitch);
+                continue;
+            }
+            for (ptrdiff_t y = 0; y < rows; ++y, from += Bytes, to += dstPitch)
+            {
+                for (ptrdiff_t x = 0; x < columns; ++x)
+                {
+                    std::memcpy(to + x * Bytes, from + x * srcPitch, Bytes);
+                }
+            }
+        }
+    }
+}
+
+void Tergos2D::PixelConverter::Transpose(const uint8_t *src, ptrdiff_t srcPitch, uint8_t *dst, ptrdiff_t dstPitch,
+                                         size_t width, size_t height, uint8_t bytesPerPixel)
+{
+    switch (bytesPerPixel)
+    {
+    case 1:
+        TransposeTiles<1, Transpose8x8x1>(src, srcPitch, dst, dstPitch, width, height);
+        break;
+    case 2:
+        TransposeTiles<2, Transpose8x8x2>(src, srcPitch, dst, dstPitch, width, height);
+        break;
+    case 3:
+        TransposeTiles<3, nullptr>(src, srcPitch, dst, dstPitch, width, height);
+        break;
+    default:
+        TransposeTiles<4, Transpose8x8x4>(src, srcPitch, dst, dstPitch, width, height);
+        break;
+    }
+}
@@ -0,0 +1,89 @@
+#include "../../PixelConverter.h"
+#include <algorithm>
+
+using namespace Tergos2D;
+
+// RGB565 copies and fills with the ESP32-S3 PIE 128 bit loads and stores, everything else
+// comes from Platform/generic. Without USE_ESP32S3_PIE the same head/body/tail split runs in plain C,
+// so host builds produce identical results.
+
+// pixels until dst sits on a 16 byte boundary, the PIE loads and stores ignore the low address bits
+static inline size_t HeadPixels(const uint8_t *dst, size_t count)
+{
+    size_t misalignment = reinterpret_cast<uintptr_t>(dst) & 15;
+    return std::min(count, ((16 - misalignment) & 15) / 2);
+}
+
+void PixelConverter::Move2(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    // the vector copy needs both sides to share the same alignment
+    if (((reinterpret_cast<uintptr_t>(src) ^ reinterpret_cast<uintptr_t>(dst)) & 15) != 0 || count < 16)
+    {
+        std::memcpy(dst, src, count * 2);
+        return;
+    }
+
+    size_t head = HeadPixels(dst, count);
+    std::memcpy(dst, src, head * 2);
+    src += head * 2;
+    dst += head * 2;
+    count -= head;
+
+    size_t blocks = count / 8;
+#ifdef USE_ESP32S3_PIE
+    const uint8_t *from = src;
+    uint8_t *to = dst;
+    size_t remaining = blocks;
+    asm volatile(
+        "beqz %[remaining], 2f\n"
+        "1:\n"
+        "ee.vld.128.ip q0, %[from], 16\n"
+        "ee.vst.128.ip q0, %[to], 16\n"
+        "addi %[remaining], %[remaining], -1\n"
+        "bnez %[remaining], 1b\n"
+        "2:\n"
+        : [from] "+r"(from), [to] "+r"(to), [remaining] "+r"(remaining)
+        :
+        : "memory");
+#else
+    std::memcpy(dst, src, blocks * 16);
+#endif
+    src += blocks * 16;
+    dst += blocks * 16;
+
+    std::memcpy(dst, src, (count % 8) * 2);
+}
+
+void PixelConverter::Fill2(uint8_t *dst, const uint8_t *pixel, size_t count)
+{
+    uint16_t value;
+    std::memcpy(&value, pixel, 2);
+    uint16_t *out = reinterpret_cast<uint16_t *>(dst);
+
+    size_t head = (reinterpret_cast<uintptr_t>(dst) & 1) ? count : HeadPixels(dst, count);
+    std::fill_n(out, head, value);
+    out += head;
+    count -= head;
+
+    size_t blocks = count / 8;
+#ifdef USE_ESP32S3_PIE
+    uint16_t *to = out;
+    size_t remaining = blocks;
+    asm volatile(
+        "ee.vldbc.16 q0, %[value]\n"
+        "beqz %[remaining], 2f\n"
+        "1:\n"
+        "ee.vst.128.ip q0, %[to], 16\n"
+        "addi %[remaining], %[remaining], -1\n"
+        "bnez %[remaining], 1b\n"
+        "2:\n"
+        : [to] "+r"(to), [remaining] "+r"(remaining)
+        : [value] "r"(&value)
+        : "memory");
+#else
+    std::fill_n(out, blocks * 8, value);
+#endif
+    out += blocks * 8;
+
+    std::fill_n(out, count % 8, value);
+}
@@ -1,8 +1,10 @@
 #include "../../PixelConverter.h"
+#include <algorithm>
 
 using namespace Tergos2D;
 
 
+#ifndef USE_X86_SIMD
 void PixelConverter::BGR24ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -13,7 +15,9 @@ void PixelConverter::BGR24ToARGB8888(const uint8_t *src, uint8_t *dst, size_t co
         dst[i * 4 + 0] = 255;            // A
     }
 }
+#endif
 
+#ifndef USE_X86_SIMD
 void PixelConverter::RGB24ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -24,11 +28,13 @@ void PixelConverter::RGB24ToARGB8888(const uint8_t *src, uint8_t *dst, size_t co
         dst[i * 4 + 0] = 255;            // A
     }
 }
+#endif
 
+#ifndef USE_X86_SIMD
 void PixelConverter::ARGB8888ToRGB24(const uint8_t *src, uint8_t *dst, size_t count)
 {
     size_t i = 0;
-    for (; i + 3 <= count; i += 4)
+    for (; i + 4 <= count; i += 4)
     {
         // Process 4 pixels at once
         const uint8_t *src_0 = src + 4 * i;
@@ -62,11 +68,13 @@ void PixelConverter::ARGB8888ToRGB24(const uint8_t *src, uint8_t *dst, size_t co
         dst[3 * i + 2] = src[4 * i + 3]; // B
     }
 }
+#endif
 
+#ifndef USE_X86_SIMD
 void PixelConverter::ARGB8888ToBGR24(const uint8_t *src, uint8_t *dst, size_t count)
 {
     size_t i = 0;
-    for (; i + 3 <= count; i += 4)
+    for (; i + 4 <= count; i += 4)
     {
         // Process 4 pixels at once
         const uint8_t *src_0 = src + 4 * i;
@@ -100,34 +108,34 @@ void PixelConverter::ARGB8888ToBGR24(const uint8_t *src, uint8_t *dst, size_t co
         dst[3 * i + 0] = src[4 * i + 3]; // B
     }
 }
+#endif
 
+#ifndef USE_X86_SIMD
 void PixelConverter::RGB565ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
     {
         uint16_t pixel = reinterpret_cast<const uint16_t *>(src)[i];
+        uint8_t r = (pixel >> 11) & 0x1F;
+        uint8_t g = (pixel >> 5) & 0x3F;
+        uint8_t b = pixel & 0x001F;
 
-        // Extract and scale the red channel (5 bits to 8 bits)
-        dst[i * 4 + 1] = (pixel & 0xF800) >> 8;       // R (5 bits -> 8 bits)
-        dst[i * 4 + 1] = (dst[i * 4 + 1] * 255) / 31; // Scale to 0-255
-
-        // Extract and scale the green channel (6 bits to 8 bits)
-        dst[i * 4 + 2] = (pixel & 0x07E0) >> 3;       // G (6 bits -> 8 bits)
-        dst[i * 4 + 2] = (dst[i * 4 + 2] * 255) / 63; // Scale to 0-255
-
-        // Extract and scale the blue channel (5 bits to 8 bits)
-        dst[i * 4 + 3] = (pixel & 0x001F) << 3;       // B (5 bits -> 8 bits)
-        dst[i * 4 + 3] = (dst[i * 4 + 3] * 255) / 31; // Scale to 0-255
+        // Scale to 0-255 by replicating the high bits
+        dst[i * 4 + 1] = (r << 3) | (r >> 2); // R
+        dst[i * 4 + 2] = (g << 2) | (g >> 4); // G
+        dst[i * 4 + 3] = (b << 3) | (b >> 2); // B
 
         // Set the alpha channel to 255 (fully opaque)
         dst[i * 4 + 0] = 255; // A
     }
 }
+#endif
 
+#ifndef USE_X86_SIMD
 void PixelConverter::RGB565ToRGB24(const uint8_t *src, uint8_t *dst, size_t count)
 {
     size_t i = 0;
-    for (; i + 3 <= count; i += 4)
+    for (; i + 4 <= count; i += 4)
     {
         // Process 4 pixels at once
         uint16_t rgb565_0 = (src[2 * i] << 8) | src[2 * i + 1];
@@ -173,11 +181,13 @@ void PixelConverter::RGB565ToRGB24(const uint8_t *src, uint8_t *dst, size_t coun
         dst[3 * i + 2] = static_cast<uint8_t>((b << 3) | (b >> 2));
     }
 }
+#endif
 
+#ifndef USE_X86_SIMD
 void PixelConverter::RGB565ToBGR24(const uint8_t *src, uint8_t *dst, size_t count)
 {
     size_t i = 0;
-    for (; i + 3 <= count; i += 4)
+    for (; i + 4 <= count; i += 4)
     {
         // Process 4 pixels at once
         uint16_t rgb565_0 = (src[2 * i] << 8) | src[2 * i + 1];
@@ -223,7 +233,9 @@ void PixelConverter::RGB565ToBGR24(const uint8_t *src, uint8_t *dst, size_t coun
         dst[3 * i + 0] = static_cast<uint8_t>((b << 3) | (b >> 2));
     }
 }
+#endif
 
+#ifndef USE_X86_SIMD
 void PixelConverter::ARGB8888ToRGB565(const uint8_t *src, uint8_t *dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -234,6 +246,7 @@ void PixelConverter::ARGB8888ToRGB565(const uint8_t *src, uint8_t *dst, size_t c
         reinterpret_cast<uint16_t *>(dst)[i] = (r << 11) | (g << 5) | b;
     }
 }
+#endif
 
 void PixelConverter::ARGB1555ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
 {
@@ -270,6 +283,7 @@ void PixelConverter::ARGB1555ToBGR24(const uint8_t *src, uint8_t *dst, size_t co
 }
 
 
+#ifndef USE_X86_SIMD
 void PixelConverter::BGR24ToRGBA8888(const uint8_t *src, uint8_t *dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -280,7 +294,9 @@ void PixelConverter::BGR24ToRGBA8888(const uint8_t *src, uint8_t *dst, size_t co
         dst[i * 4 + 3] = 255;            // A
     }
 }
+#endif
 
+#ifndef USE_X86_SIMD
 void PixelConverter::RGB24ToRGBA8888(const uint8_t *src, uint8_t *dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -291,6 +307,7 @@ void PixelConverter::RGB24ToRGBA8888(const uint8_t *src, uint8_t *dst, size_t co
         dst[i * 4 + 3] = 255;            // A
     }
 }
+#endif
 
 void PixelConverter::RGB565ToRGBA8888(const uint8_t *src, uint8_t *dst, size_t count)
 {
@@ -381,9 +398,9 @@ void PixelConverter::RGB24ToGrayscale8(const uint8_t *src, uint8_t *dst, size_t
 {
     for (size_t i = 0; i < count; ++i)
     {
-        dst[i] = static_cast<uint8_t>(0.299f * src[i * 3 + 1] +
-                                      0.587f * src[i * 3 + 2] +
-                                      0.114f * src[i * 3 + 3]);
+        dst[i] = static_cast<uint8_t>(0.299f * src[i * 3 + 0] +
+                                      0.587f * src[i * 3 + 1] +
+                                      0.114f * src[i * 3 + 2]);
     }
 }
 
@@ -399,6 +416,7 @@ void PixelConverter::RGB565ToGrayscale8(const uint8_t *src, uint8_t *dst, size_t
     }
 }
 
+#ifndef USE_X86_SIMD
 void Tergos2D::PixelConverter::RGBA8888ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -409,6 +427,8 @@ void Tergos2D::PixelConverter::RGBA8888ToARGB8888(const uint8_t *src, uint8_t *d
         dst[i * 4 + 3] = src[i * 4 + 2]; // B
     }
 }
+#endif
+#ifndef USE_X86_SIMD
 void Tergos2D::PixelConverter::ARGB8888ToRGBA8888(const uint8_t *src, uint8_t *dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -419,6 +439,8 @@ void Tergos2D::PixelConverter::ARGB8888ToRGBA8888(const uint8_t *src, uint8_t *d
         dst[i * 4 + 2] = src[i * 4 + 3]; // B
     }
 }
+#endif
+#ifndef USE_X86_SIMD
 void PixelConverter::RGBA8888ToRGB24(const uint8_t *src, uint8_t *dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -428,7 +450,9 @@ void PixelConverter::RGBA8888ToRGB24(const uint8_t *src, uint8_t *dst, size_t co
         dst[i * 3 + 2] = src[i * 4 + 2]; // B
     }
 }
+#endif
 
+#ifndef USE_X86_SIMD
 void PixelConverter::RGBA8888ToBGR24(const uint8_t *src, uint8_t *dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -438,6 +462,7 @@ void PixelConverter::RGBA8888ToBGR24(const uint8_t *src, uint8_t *dst, size_t co
         dst[i * 3 + 0] = src[i * 4 + 2]; // B
     }
 }
+#endif
 
 void PixelConverter::RGB24ToBGR24(const uint8_t *src, uint8_t *dst, size_t count)
 {
@@ -467,7 +492,7 @@ void PixelConverter::Grayscale8ToARGB8888(const uint8_t *src, uint8_t *dst, size
     {
         uint8_t gray = src[i];
 
-        dst[i*4]       = gray == 0;
+        dst[i*4]       = 255;
         dst[i * 4 +1]  = gray;
         dst[i * 4 + 2] = gray;
         dst[i * 4 + 3] = gray;
@@ -503,13 +528,12 @@ void Tergos2D::PixelConverter::RGBA8888ToRGB565(const uint8_t * src, uint8_t * d
         uint8_t g = src[i * 4 + 1];
         uint8_t b = src[i * 4 + 2];
 
-        uint16_t rgb565 = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-
-        dst[i * 2] = (rgb565 >> 8) & 0xFF;
-        dst[i * 2 + 1] = rgb565 & 0xFF;
+        // native byte order like ARGB8888ToRGB565 and the RGB565 blend kernels
+        reinterpret_cast<uint16_t *>(dst)[i] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
     }
 }
 
+#ifndef USE_X86_SIMD
 void Tergos2D::PixelConverter::RGB24ToRGB565(const uint8_t * src, uint8_t * dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -524,7 +548,9 @@ void Tergos2D::PixelConverter::RGB24ToRGB565(const uint8_t * src, uint8_t * dst,
         dst[i * 2 + 1] = rgb565 & 0xFF;
     }
 }
+#endif
 
+#ifndef USE_X86_SIMD
 void PixelConverter::BGR24ToRGB565(const uint8_t * src, uint8_t * dst, size_t count)
 {
     for (size_t i = 0; i < count; ++i)
@@ -539,6 +565,7 @@ void PixelConverter::BGR24ToRGB565(const uint8_t * src, uint8_t * dst, size_t co
         dst[i * 2 + 1] = rgb565 & 0xFF;
     }
 }
+#endif
 
 void Tergos2D::PixelConverter::Grayscale8ToRGB565(const uint8_t * src, uint8_t * dst, size_t count)
 {
@@ -551,4 +578,46 @@ void Tergos2D::PixelConverter::Grayscale8ToRGB565(const uint8_t * src, uint8_t *
         dst[i * 2] = (rgb565 >> 8) & 0xFF;
         dst[i * 2 + 1] = rgb565 & 0xFF;
     }
-}
\ No newline at end of file
+}
+// 8 x 8 tiles, the eight source rows a tile reads stay in cache while its eight target rows are written
+template <uint8_t Bytes>
+static void TransposeTiles(const uint8_t *src, ptrdiff_t srcPitch, uint8_t *dst, ptrdiff_t dstPitch, ptrdiff_t width, ptrdiff_t height)
+{
+    for (ptrdiff_t tileY = 0; tileY < height; tileY += 8)
+    {
+        ptrdiff_t rows = std::min<ptrdiff_t>(8, height - tileY);
+        for (ptrdiff_t tileX = 0; tileX < width; tileX += 8)
+        {
+            ptrdiff_t columns = std::min<ptrdiff_t>(8, width - tileX);
+            const uint8_t *from = src + tileX * srcPitch + tileY * Bytes;
+            uint8_t *to = dst + tileY * dstPitch + tileX * Bytes;
+            for (ptrdiff_t y = 0; y < rows; ++y, from += Bytes, to += dstPitch)
+            {
+                for (ptrdiff_t x = 0; x < columns; ++x)
+                {
+                    std::memcpy(to + x * Bytes, from + x * srcPitch, Bytes);
+                }
+            }
+        }
+    }
+}
+
+void Tergos2D::PixelConverter::Transpose(const uint8_t *src, ptrdiff_t srcPitch, uint8_t *dst, ptrdiff_t dstPitch,
+                                         size_t width, size_t height, uint8_t bytesPerPixel)
+{
+    switch (bytesPerPixel)
+    {
+    case 1:
+        TransposeTiles<1>(src, srcPitch, dst, dstPitch, width, height);
+        break;
+    case 2:
+        TransposeTiles<2>(src, srcPitch, dst, dstPitch, width, height);
+        break;
+    case 3:
+        TransposeTiles<3>(src, srcPitch, dst, dstPitch, width, height);
+        break;
+    default:
+        TransposeTiles<4>(src, srcPitch, dst, dstPitch, width, height);
+        break;
+    }
+}
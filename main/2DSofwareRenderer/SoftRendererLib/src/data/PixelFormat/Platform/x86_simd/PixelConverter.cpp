@@ -0,0 +1,386 @@
+#include "../../PixelConverter.h"
+
+#include <immintrin.h>
+
+using namespace Tergos2D;
+
+// SSE4.1 versions of the hot conversions, everything else comes from Platform/generic.
+// AVX2 is used where the data layout does not cross 128 bit lanes.
+
+// shuffle picking 4 byte pixels out of packed 3 byte pixels, order holds the source byte
+// (0-2) for each of the 4 destination bytes or -1 to leave it zero
+static inline __m128i MakeShuffle3To4(const int (&order)[4])
+{
+    alignas(16) int8_t mask[16];
+    for (int p = 0; p < 4; ++p)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            mask[p * 4 + k] = order[k] < 0 ? static_cast<int8_t>(0x80) : static_cast<int8_t>(p * 3 + order[k]);
+        }
+    }
+    return _mm_load_si128(reinterpret_cast<const __m128i *>(mask));
+}
+
+// shuffle packing 4 byte pixels into 3 byte pixels, order holds the source byte (0-3)
+// for each of the 3 destination bytes, the upper 4 bytes are cleared
+static inline __m128i MakeShuffle4To3(const int (&order)[3])
+{
+    alignas(16) int8_t mask[16];
+    for (int p = 0; p < 4; ++p)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            mask[p * 3 + k] = static_cast<int8_t>(p * 4 + order[k]);
+        }
+    }
+    for (int i = 12; i < 16; ++i)
+    {
+        mask[i] = static_cast<int8_t>(0x80);
+    }
+    return _mm_load_si128(reinterpret_cast<const __m128i *>(mask));
+}
+
+// 16 packed 3 byte pixels (48 bytes) to 4 registers of 4 byte pixels
+static inline void Expand3To4(const uint8_t *src, __m128i shuffle, __m128i fill, __m128i out[4])
+{
+    __m128i in0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    __m128i in1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+    __m128i in2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32));
+    out[0] = _mm_or_si128(_mm_shuffle_epi8(in0, shuffle), fill);
+    out[1] = _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(in1, in0, 12), shuffle), fill);
+    out[2] = _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(in2, in1, 8), shuffle), fill);
+    out[3] = _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(in2, 4), shuffle), fill);
+}
+
+// 4 registers of 4 byte pixels to 16 packed 3 byte pixels (48 bytes)
+static inline void Compact4To3(const uint8_t *src, __m128i shuffle, uint8_t *dst)
+{
+    __m128i s0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src)), shuffle);
+    __m128i s1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16)), shuffle);
+    __m128i s2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32)), shuffle);
+    __m128i s3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 48)), shuffle);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_or_si128(s0, _mm_slli_si128(s1, 12)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), _mm_or_si128(_mm_srli_si128(s1, 4), _mm_slli_si128(s2, 8)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 32), _mm_or_si128(_mm_srli_si128(s2, 8), _mm_slli_si128(s3, 4)));
+}
+
+// bytes without a source (-1 in order) are the alpha channel and set to 255
+static void Convert3To4(const uint8_t *src, uint8_t *dst, size_t count, const int (&order)[4])
+{
+    __m128i shuffle = MakeShuffle3To4(order);
+    uint32_t fillValue = 0;
+    for (int k = 0; k < 4; ++k)
+    {
+        if (order[k] < 0)
+            fillValue |= 0xFFu << (k * 8);
+    }
+    __m128i fill = _mm_set1_epi32(static_cast<int>(fillValue));
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i out[4];
+        Expand3To4(src + i * 3, shuffle, fill, out);
+        for (int k = 0; k < 4; ++k)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + (i + k * 4) * 4), out[k]);
+        }
+    }
+
+    for (; i < count; ++i)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            dst[i * 4 + k] = order[k] < 0 ? 255 : src[i * 3 + order[k]];
+        }
+    }
+}
+
+static void Convert4To3(const uint8_t *src, uint8_t *dst, size_t count, const int (&order)[3])
+{
+    __m128i shuffle = MakeShuffle4To3(order);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        Compact4To3(src + i * 4, shuffle, dst + i * 3);
+    }
+
+    for (; i < count; ++i)
+    {
+        dst[i * 3 + 0] = src[i * 4 + order[0]];
+        dst[i * 3 + 1] = src[i * 4 + order[1]];
+        dst[i * 3 + 2] = src[i * 4 + order[2]];
+    }
+}
+
+static void Swizzle4(const uint8_t *src, uint8_t *dst, size_t count, const int (&order)[4])
+{
+    alignas(16) int8_t mask[16];
+    for (int p = 0; p < 4; ++p)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            mask[p * 4 + k] = static_cast<int8_t>(p * 4 + order[k]);
+        }
+    }
+    __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i *>(mask));
+
+    size_t i = 0;
+#ifdef __AVX2__
+    __m256i shuffle256 = _mm256_broadcastsi128_si256(shuffle);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4), _mm256_shuffle_epi8(pixels, shuffle256));
+    }
+#endif
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_shuffle_epi8(pixels, shuffle));
+    }
+
+    for (; i < count; ++i)
+    {
+        uint8_t pixel[4] = {src[i * 4], src[i * 4 + 1], src[i * 4 + 2], src[i * 4 + 3]};
+        for (int k = 0; k < 4; ++k)
+        {
+            dst[i * 4 + k] = pixel[order[k]];
+        }
+    }
+}
+
+// 8 RGB565 pixels to 8 bit channels in 16 bit lanes, bits are replicated into the low bits
+static inline void UnpackRGB565(__m128i pixels, __m128i &r, __m128i &g, __m128i &b)
+{
+    __m128i r5 = _mm_srli_epi16(pixels, 11);
+    __m128i g6 = _mm_and_si128(_mm_srli_epi16(pixels, 5), _mm_set1_epi16(0x3F));
+    __m128i b5 = _mm_and_si128(pixels, _mm_set1_epi16(0x1F));
+    r = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+    g = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+    b = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+}
+
+// three 16 bit channel registers of 8 pixels to 24 bytes of packed 3 byte pixels
+static inline void Store3x8(__m128i c0, __m128i c1, __m128i c2, uint8_t *dst)
+{
+    __m128i c01 = _mm_packus_epi16(c0, c1);
+    __m128i c22 = _mm_packus_epi16(c2, c2);
+    const __m128i lo01 = _mm_setr_epi8(0, 8, -1, 1, 9, -1, 2, 10, -1, 3, 11, -1, 4, 12, -1, 5);
+    const __m128i lo2 = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+    const __m128i hi01 = _mm_setr_epi8(13, -1, 6, 14, -1, 7, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i hi2 = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_or_si128(_mm_shuffle_epi8(c01, lo01), _mm_shuffle_epi8(c22, lo2)));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + 16), _mm_or_si128(_mm_shuffle_epi8(c01, hi01), _mm_shuffle_epi8(c22, hi2)));
+}
+
+// RGB565 to packed 3 byte pixels, RGB565 is stored big endian like in the generic backend
+static void RGB565To3(const uint8_t *src, uint8_t *dst, size_t count, bool swapRB)
+{
+    const __m128i byteSwap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i pixels = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2)), byteSwap);
+        __m128i r, g, b;
+        UnpackRGB565(pixels, r, g, b);
+        if (swapRB)
+            Store3x8(b, g, r, dst + i * 3);
+        else
+            Store3x8(r, g, b, dst + i * 3);
+    }
+
+    for (; i < count; ++i)
+    {
+        uint16_t rgb565 = (src[2 * i] << 8) | src[2 * i + 1];
+
+        uint32_t r = (rgb565 >> 11) & 0x1F;
+        uint32_t g = (rgb565 >> 5) & 0x3F;
+        uint32_t b = rgb565 & 0x1F;
+
+        dst[3 * i + (swapRB ? 2 : 0)] = static_cast<uint8_t>((r << 3) | (r >> 2));
+        dst[3 * i + 1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+        dst[3 * i + (swapRB ? 0 : 2)] = static_cast<uint8_t>((b << 3) | (b >> 2));
+    }
+}
+
+// 4 pixels holding R, G and B at the given bit offsets to RGB565 in the low 16 bits of each lane
+static inline __m128i PackRGB565(__m128i pixels, int rShift, int gShift, int bShift)
+{
+    __m128i r = _mm_and_si128(_mm_srl_epi32(pixels, _mm_cvtsi32_si128(rShift + 3)), _mm_set1_epi32(0x1F));
+    __m128i g = _mm_and_si128(_mm_srl_epi32(pixels, _mm_cvtsi32_si128(gShift + 2)), _mm_set1_epi32(0x3F));
+    __m128i b = _mm_and_si128(_mm_srl_epi32(pixels, _mm_cvtsi32_si128(bShift + 3)), _mm_set1_epi32(0x1F));
+    return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 11), _mm_slli_epi32(g, 5)), b);
+}
+
+// packed 3 byte pixels to big endian RGB565
+static void Convert3ToRGB565(const uint8_t *src, uint8_t *dst, size_t count, bool swapRB)
+{
+    const int order[4] = {0, 1, 2, -1};
+    __m128i shuffle = MakeShuffle3To4(order);
+    const __m128i byteSwap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    int rShift = swapRB ? 16 : 0;
+    int bShift = swapRB ? 0 : 16;
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i pixels[4];
+        Expand3To4(src + i * 3, shuffle, _mm_setzero_si128(), pixels);
+        __m128i lo = _mm_packus_epi32(PackRGB565(pixels[0], rShift, 8, bShift), PackRGB565(pixels[1], rShift, 8, bShift));
+        __m128i hi = _mm_packus_epi32(PackRGB565(pixels[2], rShift, 8, bShift), PackRGB565(pixels[3], rShift, 8, bShift));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2), _mm_shuffle_epi8(lo, byteSwap));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2 + 16), _mm_shuffle_epi8(hi, byteSwap));
+    }
+
+    for (; i < count; ++i)
+    {
+        uint8_t r = src[i * 3 + (swapRB ? 2 : 0)];
+        uint8_t g = src[i * 3 + 1];
+        uint8_t b = src[i * 3 + (swapRB ? 0 : 2)];
+
+        uint16_t rgb565 = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+
+        dst[i * 2] = (rgb565 >> 8) & 0xFF;
+        dst[i * 2 + 1] = rgb565 & 0xFF;
+    }
+}
+
+void PixelConverter::RGB24ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Convert3To4(src, dst, count, {-1, 0, 1, 2});
+}
+
+void PixelConverter::BGR24ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Convert3To4(src, dst, count, {-1, 2, 1, 0});
+}
+
+void PixelConverter::RGB24ToRGBA8888(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Convert3To4(src, dst, count, {0, 1, 2, -1});
+}
+
+void PixelConverter::BGR24ToRGBA8888(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Convert3To4(src, dst, count, {2, 1, 0, -1});
+}
+
+void PixelConverter::ARGB8888ToRGB24(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Convert4To3(src, dst, count, {1, 2, 3});
+}
+
+void PixelConverter::ARGB8888ToBGR24(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Convert4To3(src, dst, count, {3, 2, 1});
+}
+
+void PixelConverter::RGBA8888ToRGB24(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Convert4To3(src, dst, count, {0, 1, 2});
+}
+
+void PixelConverter::RGBA8888ToBGR24(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Convert4To3(src, dst, count, {2, 1, 0});
+}
+
+void PixelConverter::ARGB8888ToRGBA8888(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Swizzle4(src, dst, count, {1, 2, 3, 0});
+}
+
+void PixelConverter::RGBA8888ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Swizzle4(src, dst, count, {3, 0, 1, 2});
+}
+
+void PixelConverter::RGB565ToRGB24(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    RGB565To3(src, dst, count, false);
+}
+
+void PixelConverter::RGB565ToBGR24(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    RGB565To3(src, dst, count, true);
+}
+
+void PixelConverter::RGB24ToRGB565(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Convert3ToRGB565(src, dst, count, false);
+}
+
+void PixelConverter::BGR24ToRGB565(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    Convert3ToRGB565(src, dst, count, true);
+}
+
+void PixelConverter::RGB565ToARGB8888(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    const __m128i alpha = _mm_set1_epi16(0x00FF);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+        __m128i r, g, b;
+        UnpackRGB565(pixels, r, g, b);
+        __m128i ar = _mm_or_si128(alpha, _mm_slli_epi16(r, 8));
+        __m128i gb = _mm_or_si128(g, _mm_slli_epi16(b, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_unpacklo_epi16(ar, gb));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4 + 16), _mm_unpackhi_epi16(ar, gb));
+    }
+
+    for (; i < count; ++i)
+    {
+        uint16_t pixel = reinterpret_cast<const uint16_t *>(src)[i];
+        uint8_t r = (pixel >> 11) & 0x1F;
+        uint8_t g = (pixel >> 5) & 0x3F;
+        uint8_t b = pixel & 0x1F;
+
+        dst[i * 4 + 0] = 255;
+        dst[i * 4 + 1] = (r << 3) | (r >> 2);
+        dst[i * 4 + 2] = (g << 2) | (g >> 4);
+        dst[i * 4 + 3] = (b << 3) | (b >> 2);
+    }
+}
+
+void PixelConverter::ARGB8888ToRGB565(const uint8_t *src, uint8_t *dst, size_t count)
+{
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i p0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4));
+        __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4 + 32));
+        __m256i packed[2];
+        __m256i pixels[2] = {p0, p1};
+        for (int k = 0; k < 2; ++k)
+        {
+            __m256i r = _mm256_and_si256(_mm256_srli_epi32(pixels[k], 11), _mm256_set1_epi32(0x1F));
+            __m256i g = _mm256_and_si256(_mm256_srli_epi32(pixels[k], 18), _mm256_set1_epi32(0x3F));
+            __m256i b = _mm256_srli_epi32(pixels[k], 27);
+            packed[k] = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(r, 11), _mm256_slli_epi32(g, 5)), b);
+        }
+        // packus works per 128 bit lane, restore the pixel order afterwards
+        __m256i result = _mm256_permute4x64_epi64(_mm256_packus_epi32(packed[0], packed[1]), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 2), result);
+    }
+#endif
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+        __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4 + 16));
+        __m128i result = _mm_packus_epi32(PackRGB565(p0, 8, 16, 24), PackRGB565(p1, 8, 16, 24));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 2), result);
+    }
+
+    for (; i < count; ++i)
+    {
+        uint16_t r = (src[i * 4 + 1] >> 3) & 0x1F;
+        uint16_t g = (src[i * 4 + 2] >> 2) & 0x3F;
+        uint16_t b = (src[i * 4 + 3] >> 3) & 0x1F;
+        reinterpret_cast<uint16_t *>(dst)[i] = (r << 11) | (g << 5) | b;
+    }
+}
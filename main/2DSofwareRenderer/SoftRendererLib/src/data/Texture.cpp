@@ -1,5 +1,6 @@
 #include "Texture.h"
 #include "PixelFormat/PixelFormatInfo.h"
+#include "PixelFormat/PixelConverter.h"
 using namespace Tergos2D;
 
 Texture::Texture(uint16_t width, uint16_t height, PixelFormat format, uint16_t pitch) : pitch(pitch), width(width), height(height), format(format)
@@ -8,7 +9,7 @@ Texture::Texture(uint16_t width, uint16_t height, PixelFormat format, uint16_t p
     uint8_t bytesPerPixel = PixelFormatRegistry::GetInfo(format).bytesPerPixel;
     if (pitch == 0)
     {
-        this->pitch = width * PixelFormatRegistry::GetInfo(format).bytesPerPixel;
+        this->pitch = (width * PixelFormatRegistry::GetInfo(format).bitsPerPixel + 7) / 8;
     }
     data = new uint8_t[bytesPerPixel * width * height * bytesPerPixel];
 }
@@ -18,11 +19,18 @@ Texture::Texture(uint16_t width, uint16_t height,
 {
     if (pitch == 0)
     {
-        this->pitch = width * PixelFormatRegistry::GetInfo(format).bytesPerPixel;
+        this->pitch = (width * PixelFormatRegistry::GetInfo(format).bitsPerPixel + 7) / 8;
     }
     storedLocally = false;
 }
 
+Texture::Texture(uint16_t width, uint16_t height, uint8_t *data, PixelFormat format, uint16_t pitch,
+    uint16_t originX, uint16_t originY) : Texture(width, height, data, format, pitch)
+{
+    this->originX = originX;
+    this->originY = originY;
+}
+
 Texture::Texture(uint16_t orgWidth, uint16_t orgHeight, uint16_t width, uint16_t height,
     uint16_t startX, uint16_t startY, uint8_t* data, PixelFormat format, uint16_t sourcePitch, bool useOrigSize)
     : format(format), storedLocally(false)
@@ -32,7 +40,7 @@ Texture::Texture(uint16_t orgWidth, uint16_t orgHeight, uint16_t width, uint16_t
     // Calculate the pitch for the new texture if not provided
     if (sourcePitch == 0)
     {
-        this->pitch = (orgWidth * targetInfo.bytesPerPixel);
+        this->pitch = (orgWidth * targetInfo.bitsPerPixel + 7) / 8;
     }else{
         this->pitch = sourcePitch;
     }
@@ -46,8 +54,8 @@ Texture::Texture(uint16_t orgWidth, uint16_t orgHeight, uint16_t width, uint16_t
         this->height = height;
     }
 
-    // Calculate the offset for the subtexture
-    uint32_t offset = (startY * this->pitch) + (startX * targetInfo.bytesPerPixel);
+    // Calculate the offset for the subtexture, bit formats need a startX on a byte
+    uint32_t offset = (startY * this->pitch) + (startX * targetInfo.bitsPerPixel / 8);
     this->data = data + offset;
 }
 
@@ -78,7 +86,96 @@ uint16_t Texture::GetHeight()
     return height;
 }
 
+uint16_t Texture::GetOriginX()
+{
+    return originX;
+}
+
+uint16_t Texture::GetOriginY()
+{
+    return originY;
+}
+
 uint16_t Texture::GetPitch()
 {
     return pitch;
 }
+
+bool Texture::Premultiply()
+{
+    PixelFormat premultiplied = PixelConverter::GetPremultipliedFormat(format);
+    if (premultiplied == format)
+        return false;
+
+    // same pixel size and converted pixel by pixel, so the rows can be converted in place
+    PixelConverter::ConvertFunc convertFunc = PixelConverter::GetConversionFunction(format, premultiplied);
+    for (uint16_t y = 0; y < height; ++y)
+    {
+        convertFunc(data + y * pitch, data + y * pitch, width);
+    }
+    format = premultiplied;
+    // the levels are averaged premultiplied anyway, building them again only changes how they are stored
+    if (!mips.IsEmpty())
+        mips.Build(data, width, height, pitch, format);
+    return true;
+}
+
+bool Texture::BuildSpans()
+{
+    return spans.Build(data, width, height, pitch, format);
+}
+
+void Texture::ClearSpans()
+{
+    spans.Clear();
+}
+
+const TextureSpans *Texture::GetSpans()
+{
+    return spans.IsEmpty() ? nullptr : &spans;
+}
+
+bool Texture::BuildMips()
+{
+    return mips.Build(data, width, height, pitch, format);
+}
+
+void Texture::ClearMips()
+{
+    mips.Clear();
+}
+
+const TextureMips *Texture::GetMips()
+{
+    return mips.IsEmpty() ? nullptr : &mips;
+}
+
+void Texture::SetPalette(const uint8_t *palette, uint16_t count)
+{
+    this->palette = palette;
+    paletteSize = palette ? count : 0;
+    paletteHasAlpha = false;
+    for (uint16_t i = 0; i < paletteSize; ++i)
+    {
+        if (palette[i * 4] != 255)
+        {
+            paletteHasAlpha = true;
+            break;
+        }
+    }
+}
+
+const uint8_t *Texture::GetPalette()
+{
+    return palette;
+}
+
+uint16_t Texture::GetPaletteSize()
+{
+    return paletteSize;
+}
+
+bool Texture::PaletteHasAlpha()
+{
+    return paletteHasAlpha;
+}
@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 #include "PixelFormat/PixelFormat.h"
+#include "TextureSpans.h"
+#include "TextureMips.h"
 
 namespace Tergos2D{
 
@@ -13,6 +15,10 @@ public:
     Texture(uint16_t width, uint16_t height, PixelFormat format, uint16_t pitch = 0);
     Texture(uint16_t width, uint16_t height, uint8_t* data,PixelFormat format, uint16_t pitch = 0);
     Texture(uint16_t orgWidth,uint16_t orgHeight,uint16_t width, uint16_t height, uint16_t startX, uint16_t startY, uint8_t* data, PixelFormat format, uint16_t pitch = 0, bool useOrigSize= false);
+    /// @brief Texture that only stores the pixels from originX, originY to width and height, data holds
+    /// the pixel at the origin. Renderers drawing onto it have to be clipped to that area, the tile views
+    /// of the TiledRenderer are built this way
+    Texture(uint16_t width, uint16_t height, uint8_t* data, PixelFormat format, uint16_t pitch, uint16_t originX, uint16_t originY);
     ~Texture();
 
     /// @brief Get Pointer of Texture
@@ -29,6 +35,48 @@ public:
     uint16_t GetWidth();
     uint16_t GetHeight();
 
+    /// @brief Position of the first stored pixel, 0, 0 unless the texture was built with an origin
+    uint16_t GetOriginX();
+    uint16_t GetOriginY();
+
+    /// @brief Converts ARGB8888 and RGBA8888 data in place to their premultiplied format, meant to be
+    /// called once after loading, blending premultiplied textures saves the per pixel alpha multiply
+    /// @return false if the format has no premultiplied counterpart
+    bool Premultiply();
+
+    /// @brief Builds the transparent, opaque and partial span index used by the texture renderers,
+    /// call it again after changing the pixels
+    /// @return false if the format is not one of the 32 bit alpha formats
+    bool BuildSpans();
+    void ClearSpans();
+
+    /// @brief Get the span index
+    /// @return nullptr if none was built
+    const TextureSpans* GetSpans();
+
+    /// @brief Builds the box filtered mip chain the scale and transformed texture renderers sample when
+    /// shrinking the texture, call it again after changing the pixels
+    /// @return false for the indexed formats
+    bool BuildMips();
+    void ClearMips();
+
+    /// @brief Get the mip chain
+    /// @return nullptr if none was built
+    const TextureMips* GetMips();
+
+    /// @brief Attaches the palette of an I8 or I4 texture, count ARGB8888 entries. The palette is
+    /// referenced, not copied, so swapping it recolours the texture without touching the pixels.
+    /// Call it again after changing entries in place, it checks them for alpha
+    void SetPalette(const uint8_t* palette, uint16_t count);
+
+    /// @brief Get the palette
+    /// @return nullptr if none was set
+    const uint8_t* GetPalette();
+    uint16_t GetPaletteSize();
+
+    /// @brief Whether any palette entry is not fully opaque, opaque palettes are copied instead of blended
+    bool PaletteHasAlpha();
+
 private:
     uint8_t* data;
     PixelFormat format;
@@ -36,6 +84,12 @@ private:
     bool storedLocally = false;
     uint16_t width, height;
     uint16_t pitch = 0;
+    uint16_t originX = 0, originY = 0;
+    TextureSpans spans;
+    TextureMips mips;
+    const uint8_t* palette = nullptr;
+    uint16_t paletteSize = 0;
+    bool paletteHasAlpha = false;
 };
 
 }
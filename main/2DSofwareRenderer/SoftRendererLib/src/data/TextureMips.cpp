@@ -0,0 +1,149 @@
+#include "TextureMips.h"
+#include "PixelFormat/PixelFormatInfo.h"
+#include "PixelFormat/PixelConverter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace Tergos2D;
+
+// averages 2 x 2 pixels of two rows byte by byte into width pixels, an odd last column is averaged
+// with itself
+template <uint8_t Bytes>
+static void BoxFilterRows(const uint8_t *top, const uint8_t *bottom, uint16_t sourceWidth, uint8_t *out, uint16_t width)
+{
+    for (uint16_t x = 0; x < width; ++x, out += Bytes)
+    {
+        size_t left = x * 2 * Bytes;
+        size_t right = 2 * x + 1 < sourceWidth ? left + Bytes : left;
+        for (uint8_t c = 0; c < Bytes; ++c)
+            out[c] = static_cast<uint8_t>((top[left + c] + top[right + c] + bottom[left + c] + bottom[right + c] + 2) >> 2);
+    }
+}
+
+bool TextureMips::Build(const uint8_t *data, uint16_t width, uint16_t height, uint16_t pitch, PixelFormat format)
+{
+    Clear();
+
+    const PixelFormatInfo &info = PixelFormatRegistry::GetInfo(format);
+    if (info.isIndexed || data == nullptr || width == 0 || height == 0)
+        return false;
+    // byte formats whose channels average as they are stored are filtered directly, straight alpha, packed
+    // and bit formats are widened to ARGB8888, premultiplied when they have alpha so transparent pixels
+    // don't darken their neighbours
+    bool direct = !info.isBitFormat && info.bytesPerPixel != 2 &&
+                  (!info.hasAlpha || info.isPremultiplied || info.numChannels == 1);
+    uint8_t bytes = direct ? info.bytesPerPixel : 4;
+    PixelConverter::ConvertFunc toWide = nullptr;
+    PixelConverter::ConvertFunc fromWide = nullptr;
+    if (!direct)
+    {
+        PixelFormat wideFormat = info.hasAlpha ? PixelFormat::ARGB8888_PRE : PixelFormat::ARGB8888;
+        toWide = PixelConverter::GetConversionFunction(format, wideFormat);
+        fromWide = PixelConverter::GetConversionFunction(wideFormat, format);
+        if (!toWide || !fromWide)
+            return false;
+    }
+
+    // sizes first, so the pixels of all levels are allocated once
+    size_t total = 0;
+    for (uint16_t w = width, h = height; w > 1 || h > 1;)
+    {
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+        uint16_t levelPitch = static_cast<uint16_t>((w * info.bitsPerPixel + 7) / 8);
+        levels.push_back({total, w, h, levelPitch});
+        total += static_cast<size_t>(levelPitch) * h;
+    }
+    pixels.resize(total);
+
+    // every level is filtered from the filtered pixels of the level before it, not from its stored ones, so
+    // widened formats don't lose precision again on every level. Level 0 is widened two rows at a time
+    std::vector<uint8_t> previous, current;
+    std::vector<uint8_t> rows(direct ? 0 : width * 8);
+    uint16_t previousWidth = width;
+    uint16_t previousHeight = height;
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        const Level &level = levels[i];
+        current.resize(level.width * level.height * bytes);
+        for (uint16_t y = 0; y < level.height; ++y)
+        {
+            uint16_t y0 = 2 * y;
+            uint16_t y1 = std::min<uint16_t>(y0 + 1, previousHeight - 1);
+            const uint8_t *top, *bottom;
+            if (i > 0)
+            {
+                top = previous.data() + y0 * previousWidth * bytes;
+                bottom = previous.data() + y1 * previousWidth * bytes;
+            }
+            else if (direct)
+            {
+                top = data + y0 * pitch;
+                bottom = data + y1 * pitch;
+            }
+            else
+            {
+                toWide(data + y0 * pitch, rows.data(), width);
+                toWide(data + y1 * pitch, rows.data() + width * 4, width);
+                top = rows.data();
+                bottom = top + width * 4;
+            }
+
+            uint8_t *out = current.data() + y * level.width * bytes;
+            switch (bytes)
+            {
+            case 1:
+                BoxFilterRows<1>(top, bottom, previousWidth, out, level.width);
+                break;
+            case 3:
+                BoxFilterRows<3>(top, bottom, previousWidth, out, level.width);
+                break;
+            default:
+                BoxFilterRows<4>(top, bottom, previousWidth, out, level.width);
+                break;
+            }
+            uint8_t *stored = pixels.data() + level.offset + y * level.pitch;
+            if (fromWide)
+                fromWide(out, stored, level.width);
+            else
+                std::memcpy(stored, out, level.width * bytes);
+        }
+        std::swap(previous, current);
+        previousWidth = level.width;
+        previousHeight = level.height;
+    }
+    return true;
+}
+
+void TextureMips::Clear()
+{
+    pixels.clear();
+    levels.clear();
+}
+
+bool TextureMips::IsEmpty() const
+{
+    return levels.empty();
+}
+
+uint8_t TextureMips::GetLevelCount() const
+{
+    return static_cast<uint8_t>(levels.size() + 1);
+}
+
+const uint8_t *TextureMips::GetLevel(uint8_t level, uint16_t &width, uint16_t &height, uint16_t &pitch) const
+{
+    const Level &stored = levels[level - 1];
+    width = stored.width;
+    height = stored.height;
+    pitch = stored.pitch;
+    return pixels.data() + stored.offset;
+}
+
+float TextureMips::LevelOf(float shrink) const
+{
+    if (!(shrink > 1.0f) || levels.empty())
+        return 0.0f;
+    return std::min(std::log2(shrink), static_cast<float>(levels.size()));
+}
@@ -0,0 +1,55 @@
+#ifndef TEXTUREMIPS_H
+#define TEXTUREMIPS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "PixelFormat/PixelFormat.h"
+
+namespace Tergos2D
+{
+    // Box filtered copies of a texture at half, a quarter and so on of its size, down to a single pixel.
+    // Level 0 is the texture itself and not stored here, every further level averages 2 x 2 pixels of the
+    // one before. Odd sizes round up and repeat the last column or row, so a level always covers exactly
+    // half the positions of the one before and source position u lands at u / 2^level on every level.
+    // Shrinking renderers sample the level closest to the target size, which keeps thumbnails from
+    // aliasing and reads far fewer source rows. Takes about a third of the texture size on top, and like
+    // the span index it describes the pixels at build time.
+    class TextureMips
+    {
+    public:
+        TextureMips() = default;
+        ~TextureMips() = default;
+
+        /// @brief Builds all levels from the pixel data, formats with straight alpha are averaged
+        /// premultiplied so transparent pixels don't darken their neighbours
+        /// @return false for the indexed formats, averaging palette indices has no meaning, the chain
+        /// stays empty then
+        bool Build(const uint8_t *data, uint16_t width, uint16_t height, uint16_t pitch, PixelFormat format);
+        void Clear();
+        bool IsEmpty() const;
+
+        /// @brief Number of levels including the texture itself, 1 when none were built
+        uint8_t GetLevelCount() const;
+
+        /// @brief Pixels of level 1 to GetLevelCount() - 1, in the format of the texture
+        const uint8_t *GetLevel(uint8_t level, uint16_t &width, uint16_t &height, uint16_t &pitch) const;
+
+        /// @brief Level for drawing with shrink source pixels per target pixel, log2 of it between 0 and
+        /// the last level. The fraction is the share of the next level when blending two
+        float LevelOf(float shrink) const;
+
+    private:
+        struct Level
+        {
+            size_t offset;
+            uint16_t width, height, pitch;
+        };
+
+        // all levels after each other, offsets instead of pointers so copies stay valid
+        std::vector<uint8_t> pixels;
+        std::vector<Level> levels;
+    };
+}
+
+#endif // !TEXTUREMIPS_H
@@ -0,0 +1,110 @@
+#include "TextureSpans.h"
+#include <algorithm>
+
+using namespace Tergos2D;
+
+static inline SpanType Classify(uint8_t alpha)
+{
+    if (alpha == 0)
+        return SpanType::TRANSPARENT;
+    return alpha == 255 ? SpanType::OPAQUE : SpanType::PARTIAL;
+}
+
+bool TextureSpans::Build(const uint8_t *data, uint16_t width, uint16_t height, uint16_t pitch, PixelFormat format)
+{
+    Clear();
+
+    // only the 32 bit formats, the blend kernels don't treat the full alpha of ARGB1555 and RGBA4444
+    // as opaque, so converting those spans would not match blending them
+    uint8_t alphaOffset;
+    switch (format)
+    {
+    case PixelFormat::ARGB8888:
+    case PixelFormat::ARGB8888_PRE:
+        alphaOffset = 0;
+        break;
+    case PixelFormat::RGBA8888:
+    case PixelFormat::RGBA8888_PRE:
+        alphaOffset = 3;
+        break;
+    default:
+        return false;
+    }
+    if (data == nullptr || width == 0)
+        return false;
+
+    rowStarts.reserve(height + 1);
+    for (uint16_t y = 0; y < height; ++y)
+    {
+        rowStarts.push_back(static_cast<uint32_t>(spans.size()));
+        const uint8_t *alpha = data + y * pitch + alphaOffset;
+
+        TextureSpan span = {0, 1, Classify(*alpha)};
+        for (uint16_t x = 1; x < width; ++x)
+        {
+            alpha += 4;
+            SpanType type = Classify(*alpha);
+            if (type != span.type)
+            {
+                spans.push_back(span);
+                span = {x, x, type};
+            }
+            span.end = x + 1;
+        }
+        spans.push_back(span);
+    }
+    rowStarts.push_back(static_cast<uint32_t>(spans.size()));
+    return true;
+}
+
+void TextureSpans::Clear()
+{
+    spans.clear();
+    rowStarts.clear();
+}
+
+bool TextureSpans::IsEmpty() const
+{
+    return spans.empty();
+}
+
+const TextureSpan *TextureSpans::GetRow(uint16_t y, size_t &count) const
+{
+    count = rowStarts[y + 1] - rowStarts[y];
+    return spans.data() + rowStarts[y];
+}
+
+const TextureSpan *TextureSpans::FindSpan(uint16_t x, uint16_t y) const
+{
+    const TextureSpan *first = spans.data() + rowStarts[y];
+    const TextureSpan *last = spans.data() + rowStarts[y + 1];
+    const TextureSpan *span = std::upper_bound(first, last, x, [](uint16_t value, const TextureSpan &s) { return value < s.end; });
+    return span != last ? span : last - 1;
+}
+
+SpanType TextureSpans::GetType(uint16_t x, uint16_t y) const
+{
+    return FindSpan(x, y)->type;
+}
+
+SpanType TextureSpans::GetType(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) const
+{
+    SpanType type = GetType(x0, y0);
+    if (GetType(x1, y0) != type || GetType(x0, y1) != type || GetType(x1, y1) != type)
+        return SpanType::PARTIAL;
+    return type;
+}
+
+bool TextureSpans::CanSkipTransparent(const BlendContext &context)
+{
+    // every blend kernel leaves the target as it is for a source alpha of 0
+    return context.mode == BlendMode::BLEND;
+}
+
+bool TextureSpans::CanCopyOpaque(const BlendContext &context, const Coloring &coloring)
+{
+    return context.mode == BlendMode::BLEND && !coloring.colorEnabled &&
+           context.colorBlendFactorSrc == BlendFactor::SourceAlpha &&
+           context.colorBlendFactorDst == BlendFactor::InverseSourceAlpha &&
+           context.colorBlendOperation == BlendOperation::Add;
+}
@@ -0,0 +1,79 @@
+#ifndef TEXTURESPANS_H
+#define TEXTURESPANS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "PixelFormat/PixelFormat.h"
+#include "BlendMode/BlendMode.h"
+
+namespace Tergos2D
+{
+    enum class SpanType : uint8_t
+    {
+        TRANSPARENT,
+        OPAQUE,
+        PARTIAL
+    };
+
+    // end is exclusive
+    struct TextureSpan
+    {
+        uint16_t start, end;
+        SpanType type;
+    };
+
+    // Runs of transparent, opaque and partially transparent pixels for every row of a texture.
+    // Built once after loading, the renderers skip transparent runs, convert opaque runs and only
+    // blend the rest. The index describes the pixel data at build time, it has to be built again
+    // when the pixels change.
+    class TextureSpans
+    {
+    public:
+        TextureSpans() = default;
+        ~TextureSpans() = default;
+
+        /// @brief Builds the index from the pixel data
+        /// @return false for formats other than ARGB8888, RGBA8888 and their premultiplied variants,
+        /// the index stays empty then
+        bool Build(const uint8_t *data, uint16_t width, uint16_t height, uint16_t pitch, PixelFormat format);
+        void Clear();
+        bool IsEmpty() const;
+
+        /// @brief Spans of row y ordered by start, together they cover the whole row
+        const TextureSpan *GetRow(uint16_t y, size_t &count) const;
+
+        /// @brief Span type of a single pixel, binary search over the spans of its row
+        SpanType GetType(uint16_t x, uint16_t y) const;
+
+        /// @brief Like GetType, but first tries the span of the previous lookup, neighbouring samples
+        /// mostly hit the same span. hint starts as nullptr and is updated by every call
+        inline SpanType GetType(uint16_t x, uint16_t y, const TextureSpan *&hint) const
+        {
+            const TextureSpan *first = spans.data() + rowStarts[y];
+            if (hint < first || hint >= spans.data() + rowStarts[y + 1] || x < hint->start || x >= hint->end)
+            {
+                hint = FindSpan(x, y);
+            }
+            return hint->type;
+        }
+
+        /// @brief Type shared by the four pixels a bilinear sample reads, PARTIAL when they differ
+        SpanType GetType(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) const;
+
+        /// @brief Whether the spans can replace the blend, transparent pixels leave the target untouched
+        /// in every blend mode but copying opaque pixels is only the same as source over without tint
+        static bool CanSkipTransparent(const BlendContext &context);
+        static bool CanCopyOpaque(const BlendContext &context, const Coloring &coloring);
+
+    private:
+        // span containing x, the last span of the row for x past its end
+        const TextureSpan *FindSpan(uint16_t x, uint16_t y) const;
+
+        std::vector<TextureSpan> spans;
+        // index of the first span of each row, one entry more than rows
+        std::vector<uint32_t> rowStarts;
+    };
+}
+
+#endif // !TEXTURESPANS_H
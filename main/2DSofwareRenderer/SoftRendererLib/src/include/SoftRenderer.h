@@ -2,6 +2,11 @@
 #define SOFT_RENDERER_H
 
 #include "../core/RenderContext2D.h"
+#include "../core/DirtyRegion.h"
+#include "../core/DisplayList.h"
+#include "../core/TiledRenderer.h"
+#include "../util/WorkerPool.h"
+#include "../util/ThreadPool.h"
 #include "../data/Texture.h"
 #include "../data/Color.h"
 #include "../data/PixelFormat/PixelFormat.h"
@@ -0,0 +1,74 @@
+#include "ThreadPool.h"
+
+using namespace Tergos2D;
+
+ThreadPool::ThreadPool(uint8_t workerCount)
+{
+    for (uint8_t i = 1; i < workerCount; ++i)
+    {
+        threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+uint8_t ThreadPool::GetWorkerCount()
+{
+    return static_cast<uint8_t>(threads.size() + 1);
+}
+
+void ThreadPool::Run(WorkerJob job, void *data)
+{
+    if (threads.empty())
+    {
+        job(data, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = job;
+        this->data = data;
+        running = static_cast<uint8_t>(threads.size());
+        ++generation;
+    }
+    startCondition.notify_all();
+
+    job(data, 0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this] { return running == 0; });
+}
+
+void ThreadPool::WorkerLoop(uint8_t workerIndex)
+{
+    uint32_t seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        startCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+        if (stopping)
+            return;
+        seenGeneration = generation;
+        WorkerJob currentJob = job;
+        void *currentData = data;
+
+        lock.unlock();
+        currentJob(currentData, workerIndex);
+        lock.lock();
+
+        if (--running == 0)
+            doneCondition.notify_one();
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stdint.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "WorkerPool.h"
+
+namespace Tergos2D
+{
+    // WorkerPool on std::thread, the extra threads are started once and sleep between jobs
+    class ThreadPool : public WorkerPool
+    {
+    public:
+        /// @brief workerCount includes the calling thread, so workerCount - 1 threads are started
+        ThreadPool(uint8_t workerCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        uint8_t GetWorkerCount() override;
+        void Run(WorkerJob job, void *data) override;
+
+    private:
+        void WorkerLoop(uint8_t workerIndex);
+
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable startCondition;
+        std::condition_variable doneCondition;
+
+        WorkerJob job = nullptr;
+        void *data = nullptr;
+        // increases with every Run, a worker starts the job when it sees a new value
+        uint32_t generation = 0;
+        uint8_t running = 0;
+        bool stopping = false;
+    };
+}
+
+#endif // !THREADPOOL_H
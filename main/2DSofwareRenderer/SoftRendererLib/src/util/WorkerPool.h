@@ -0,0 +1,26 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <stdint.h>
+
+namespace Tergos2D
+{
+    // job function run by every worker, workerIndex goes from 0 to GetWorkerCount() - 1
+    typedef void (*WorkerJob)(void *data, uint8_t workerIndex);
+
+    // Runs one job on several workers at once. The library only uses this interface, ThreadPool
+    // implements it with std::thread, platforms like FreeRTOS can provide their own pinned tasks.
+    class WorkerPool
+    {
+    public:
+        virtual ~WorkerPool() = default;
+
+        /// @brief number of workers a job runs on, the thread calling Run counts as worker 0
+        virtual uint8_t GetWorkerCount() = 0;
+
+        /// @brief calls job once per worker in parallel and returns after every call returned, not reentrant
+        virtual void Run(WorkerJob job, void *data) = 0;
+    };
+}
+
+#endif // !WORKERPOOL_H
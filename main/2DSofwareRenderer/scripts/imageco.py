@@ -117,10 +117,48 @@ def argb1555_conversion(input_path, output_path):
     except Exception as e:
         print(f"An error occurred during ARGB1555 conversion: {e}")
 
+def indexed_conversion(input_path, output_path, bits):
+    try:
+        img = Image.open(input_path).convert('RGBA')
+        width, height = img.size
+        # fast octree is the quantizer that keeps alpha
+        quantized = img.quantize(colors=1 << bits, method=Image.Quantize.FASTOCTREE)
+        indices = list(quantized.getdata())
+        palette = quantized.getpalette(rawmode='RGBA')
+        used = max(indices) + 1
+
+        index_data = []
+        for y in range(height):
+            row = indices[y * width:(y + 1) * width]
+            if bits == 8:
+                index_data.extend(row)
+            else:
+                # rows start on a byte, first pixel in the high nibble
+                for i in range(0, width, 2):
+                    i2 = row[i + 1] if i + 1 < width else 0
+                    index_data.append((row[i] << 4) | i2)
+
+        with open(output_path, 'wb') as f:
+            f.write(bytes(index_data))
+
+        # the palette goes next to the indices as ARGB8888, the same layout as the argb8888 output
+        palette_path = output_path + '.pal'
+        with open(palette_path, 'wb') as f:
+            for i in range(used):
+                r, g, b, a = palette[i * 4:i * 4 + 4]
+                f.write(bytes([a, r, g, b]))
+
+        print(f"Conversion to I{bits} complete. File saved to: {output_path}, {used} palette entries saved to: {palette_path}")
+
+    except FileNotFoundError:
+        print(f"Error: File '{input_path}' not found.")
+    except Exception as e:
+        print(f"An error occurred during I{bits} conversion: {e}")
+
 def main():
     if len(sys.argv) != 4:
         print("Usage: convert_image.py <input_image> <output_file> <format>")
-        print("Format options: rgb565, argb8888, grayscale8, grayscale4, argb1555")
+        print("Format options: rgb565, argb8888, grayscale8, grayscale4, argb1555, i8, i4")
         sys.exit(1)
 
     input_path = sys.argv[1]
@@ -137,8 +175,12 @@ def main():
         grayscale4_conversion(input_path, output_path)
     elif format_option == 'argb1555':
         argb1555_conversion(input_path, output_path)
+    elif format_option == 'i8':
+        indexed_conversion(input_path, output_path, 8)
+    elif format_option == 'i4':
+        indexed_conversion(input_path, output_path, 4)
     else:
-        print("Error: Invalid format. Supported formats are 'rgb565', 'argb8888', 'grayscale8', 'grayscale4', and 'argb1555'.")
+        print("Error: Invalid format. Supported formats are 'rgb565', 'argb8888', 'grayscale8', 'grayscale4', 'argb1555', 'i8' and 'i4'.")
         sys.exit(1)
 
 if __name__ == "__main__":
@@ -54,12 +54,75 @@ static bool initialized = false;
 
 
 
+// 1 records the frame and renders it in full width tiles from internal SRAM, each tile reaches the
+// PSRAM frame buffer with one linear copy. 0 draws straight into the frame buffer.
+#define TILED_RENDERING 1
+#define TILE_HEIGHT 16
+// 1 shares the tiles between the render task on core 0 and a worker task on core 1
+#define DUAL_CORE_RENDERING 1
+
+static DisplayList frameList;
+static TiledRenderer *tiledRenderer = NULL;
+
+// WorkerPool with one extra task pinned to core 1, the task calling Run is worker 0
+class DualCoreWorkerPool : public WorkerPool {
+public:
+    bool Start() {
+        start_sem = xSemaphoreCreateBinary();
+        done_sem = xSemaphoreCreateBinary();
+        if (start_sem == NULL || done_sem == NULL) {
+            return false;
+        }
+        return xTaskCreatePinnedToCore(worker_task, "render_worker", 8096, this, configMAX_PRIORITIES - 2, NULL, 1) == pdPASS;
+    }
+
+    uint8_t GetWorkerCount() override {
+        return 2;
+    }
+
+    void Run(WorkerJob job, void *data) override {
+        this->job = job;
+        this->data = data;
+        xSemaphoreGive(start_sem);
+        job(data, 0);
+        xSemaphoreTake(done_sem, portMAX_DELAY);
+    }
+
+private:
+    static void worker_task(void *parameter) {
+        DualCoreWorkerPool *pool = (DualCoreWorkerPool *)parameter;
+        while (1) {
+            xSemaphoreTake(pool->start_sem, portMAX_DELAY);
+            pool->job(pool->data, 1);
+            xSemaphoreGive(pool->done_sem);
+        }
+    }
+
+    SemaphoreHandle_t start_sem = NULL;
+    SemaphoreHandle_t done_sem = NULL;
+    WorkerJob job = NULL;
+    void *data = NULL;
+};
+
+static DualCoreWorkerPool workerPool;
+
+// squares drawn into each of the two frame buffers, only those areas need clearing next time
+static DirtyRegion drawnRegions[2];
+static int backBufferIndex = 0;
+
 //random test to fill the screen with data
 void fill_screen() {
     static Texture texture;
     texture = Texture(480,480,(uint8_t*)back_buffer,PixelFormat::RGB565);
-    context.ClearTarget(Color(155,155,155));
     context.SetTargetTexture(&texture);
+#if TILED_RENDERING
+    frameList.Clear();
+    context.BeginRecording(frameList);
+    context.ClearTarget(Color(155,155,155));
+#else
+    context.ClearTarget(Color(155,155,155), drawnRegions[backBufferIndex]);
+    context.ResetDirtyRegion();
+#endif
 
     if (!initialized) {
         for (int i = 0; i < amount; i++) {
@@ -119,6 +182,13 @@ void fill_screen() {
             Square::SIZE
         );
     }
+
+#if TILED_RENDERING
+    context.EndRecording();
+    tiledRenderer->Render(context, frameList);
+#else
+    drawnRegions[backBufferIndex] = context.GetDirtyRegion();
+#endif
 }
 
 void update_display(void) {
@@ -128,6 +198,7 @@ void update_display(void) {
    void *temp = front_buffer;
     front_buffer = back_buffer;
     back_buffer = temp;
+    backBufferIndex ^= 1;
 }
 
 
@@ -181,6 +252,29 @@ static bool init_display(void) {
     memset(front_buffer, 0, FRAME_SIZE);
     memset(back_buffer, 0, FRAME_SIZE);
 
+#if TILED_RENDERING
+    uint8_t *tile_buffer = (uint8_t *)heap_caps_malloc(SCREEN_WIDTH * TILE_HEIGHT * MAXBYTESPERPIXEL, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (tile_buffer == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate the tile buffer");
+        return false;
+    }
+    tiledRenderer = new TiledRenderer(SCREEN_WIDTH, TILE_HEIGHT, tile_buffer);
+#if DUAL_CORE_RENDERING
+    // the worker on core 1 gets its own tile buffer, also from internal SRAM
+    uint8_t *worker_tile_buffer = (uint8_t *)heap_caps_malloc(SCREEN_WIDTH * TILE_HEIGHT * MAXBYTESPERPIXEL, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (worker_tile_buffer == NULL || !workerPool.Start()) {
+        ESP_LOGE(TAG, "Failed to start the render worker");
+        return false;
+    }
+    tiledRenderer->SetWorkerPool(&workerPool, &worker_tile_buffer);
+#endif
+#else
+    // the first frame of each buffer clears everything
+    context.EnableDirtyTracking(true);
+    drawnRegions[0].Add(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    drawnRegions[1].Add(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+#endif
+
     // Set backlight to 75%
     Set_Backlight(75);
 